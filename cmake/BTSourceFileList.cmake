@@ -49,6 +49,7 @@ SOURCE_GROUP("src\\backend\\config" FILES ${bibletime_SRC_BACKEND_CONFIG})
 
 SET(bibletime_SRC_BACKEND_DRIVERS
     # Backend drivers:
+    src/backend/drivers/btlexiconkeyindex.cpp
     src/backend/drivers/cswordbiblemoduleinfo.cpp
     src/backend/drivers/cswordbookmoduleinfo.cpp
     src/backend/drivers/cswordcommentarymoduleinfo.cpp
@@ -67,12 +68,14 @@ SET(bibletime_SRC_BACKEND_FILTERS
     src/backend/filters/thmltohtml.cpp
     src/backend/filters/thmltoplain.cpp
     src/backend/filters/btosismorphsegmentation.cpp
+    src/backend/filters/wordspanbuilder.cpp
 )
 
 SOURCE_GROUP("src\\backend\\filters" FILES ${bibletime_SRC_BACKEND_FILTERS})
 
 SET(bibletime_SRC_BACKEND_KEYS
     # Backend keys:
+    src/backend/keys/btversificationmap.cpp
     src/backend/keys/cswordkey.cpp
     src/backend/keys/cswordldkey.cpp
     src/backend/keys/cswordtreekey.cpp
@@ -88,6 +91,7 @@ SET(bibletime_SRC_BACKEND_RENDERING
     src/backend/rendering/cdisplayrendering.cpp
     src/backend/rendering/centrydisplay.cpp
     src/backend/rendering/chtmlexportrendering.cpp
+    src/backend/rendering/cjsonlinesexportrendering.cpp
     src/backend/rendering/cplaintextexportrendering.cpp
     src/backend/rendering/ctextrendering.cpp
 )
@@ -96,6 +100,9 @@ SOURCE_GROUP("src\\backend\\rendering" FILES ${bibletime_SRC_BACKEND_RENDERING})
 
 SET(bibletime_SRC_BACKEND_MANAGERS
     # Backend managers:
+    src/backend/managers/btindexcatalog.cpp
+    src/backend/managers/btlexiconcachewarmer.cpp
+    src/backend/managers/btmoduleconfigcache.cpp
     src/backend/managers/btstringmgr.cpp
     src/backend/managers/cdisplaytemplatemgr.cpp
     src/backend/managers/clanguagemgr.cpp
@@ -106,6 +113,7 @@ SET(bibletime_SRC_BACKEND_MANAGERS
 SOURCE_GROUP("src\\backend\\managers" FILES ${bibletime_SRC_BACKEND_MANAGERS})
 
 SET(bibletime_SRC_BACKEND_MODELS
+    src/backend/models/btlexiconkeymodel.cpp
     src/backend/models/btmoduletextmodel.cpp
 )
 
@@ -116,6 +124,7 @@ SET(bibletime_SRC_UTIL
     src/util/cresmgr.cpp
     src/util/directory.cpp
     src/util/btmodules.cpp
+    src/util/btstartupprofiler.cpp
     src/util/geticon.cpp
     src/util/tool.cpp
 )
@@ -130,6 +139,7 @@ SET(bibletime_SRC_FRONTEND
     src/frontend/btbookshelfgroupingmenu.cpp
     src/frontend/btbookshelfview.cpp
     src/frontend/btbookshelfwidget.cpp
+    src/frontend/btlexiconcacheindicator.cpp
     src/frontend/btmenuview.cpp
     src/frontend/btmodulechooserdialog.cpp
     src/frontend/btmoduleindexdialog.cpp
@@ -313,7 +323,9 @@ SET(bibletime_COMMON_MOCABLE_HEADERS
     src/backend/drivers/cswordcommentarymoduleinfo.h
     src/backend/drivers/cswordlexiconmoduleinfo.h
     src/backend/drivers/cswordmoduleinfo.h
+    src/backend/managers/btlexiconcachewarmer.h
     src/backend/managers/cswordbackend.h
+    src/backend/models/btlexiconkeymodel.h
     src/backend/models/btmoduletextmodel.h
     src/util/btsignal.h
     src/backend/btinstallmgr.h
@@ -351,6 +363,7 @@ SET(bibletime_FRONTEND_DESKTOP_MOCABLE_HEADERS
     src/frontend/btbookshelfgroupingmenu.h
     src/frontend/btbookshelfview.h
     src/frontend/btbookshelfwidget.h
+    src/frontend/btlexiconcacheindicator.h
     src/frontend/btmenuview.h
     src/frontend/btmodulechooserdialog.h
     src/frontend/btmoduleindexdialog.h
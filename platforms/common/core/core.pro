@@ -13,7 +13,10 @@ SOURCES += \
     ../../../src/backend/managers/clanguagemgr.cpp \
     ../../../src/backend/managers/cdisplaytemplatemgr.cpp \
     ../../../src/backend/managers/btstringmgr.cpp \
+    ../../../src/backend/managers/btmoduleconfigcache.cpp \
+    ../../../src/backend/managers/btindexcatalog.cpp \
     ../../../src/util/directory.cpp \
+    ../../../src/util/btstartupprofiler.cpp \
     ../../../src/util/cresmgr.cpp \
     ../../../src/backend/config/btconfig.cpp \
     ../../../src/backend/config/btconfigcore.cpp \
@@ -23,8 +26,10 @@ SOURCES += \
     ../../../src/backend/keys/cswordversekey.cpp \
     ../../../src/backend/keys/cswordldkey.cpp \
     ../../../src/backend/keys/cswordkey.cpp \
+    ../../../src/backend/keys/btversificationmap.cpp \
     ../../../src/backend/drivers/cswordmoduleinfo.cpp \
     ../../../src/backend/drivers/cswordlexiconmoduleinfo.cpp \
+    ../../../src/backend/drivers/btlexiconkeyindex.cpp \
     ../../../src/backend/drivers/cswordcommentarymoduleinfo.cpp \
     ../../../src/backend/drivers/cswordbiblemoduleinfo.cpp \
     ../../../src/backend/rendering/ctextrendering.cpp \
@@ -45,6 +50,7 @@ SOURCES += \
     ../../../src/backend/filters/plaintohtml.cpp \
     ../../../src/backend/filters/osistohtml.cpp \
     ../../../src/backend/filters/gbftohtml.cpp \
+    ../../../src/backend/filters/wordspanbuilder.cpp \
     ../../../src/backend/bookshelfmodel/btbookshelfmodel.cpp \
     ../../../src/backend/filters/thmltoplain.cpp \
     ../../../src/backend/drivers/cswordbookmoduleinfo.cpp \
@@ -65,7 +71,10 @@ HEADERS += \
     ../../../src/backend/managers/clanguagemgr.h \
     ../../../src/backend/managers/cdisplaytemplatemgr.h \
     ../../../src/backend/managers/btstringmgr.h \
+    ../../../src/backend/managers/btmoduleconfigcache.h \
+    ../../../src/backend/managers/btindexcatalog.h \
     ../../../src/util/directory.h \
+    ../../../src/util/btstartupprofiler.h \
     ../../../src/util/cresmgr.h \
     ../../../src/backend/config/btconfig.h \
     ../../../src/backend/config/btconfigcore.h \
@@ -76,9 +85,11 @@ HEADERS += \
     ../../../src/backend/keys/cswordversekey.h \
     ../../../src/backend/keys/cswordldkey.h \
     ../../../src/backend/keys/cswordkey.h \
+    ../../../src/backend/keys/btversificationmap.h \
     ../../../src/backend/keys/cswordtreekey.h \
     ../../../src/backend/drivers/cswordmoduleinfo.h \
     ../../../src/backend/drivers/cswordlexiconmoduleinfo.h \
+    ../../../src/backend/drivers/btlexiconkeyindex.h \
     ../../../src/backend/drivers/cswordcommentarymoduleinfo.h \
     ../../../src/backend/drivers/cswordbiblemoduleinfo.h \
     ../../../src/backend/rendering/ctextrendering.h \
@@ -99,6 +110,7 @@ HEADERS += \
     ../../../src/backend/filters/plaintohtml.h \
     ../../../src/backend/filters/osistohtml.h \
     ../../../src/backend/filters/gbftohtml.h \
+    ../../../src/backend/filters/wordspanbuilder.h \
     ../../../src/backend/bookshelfmodel/btbookshelfmodel.h \
     ../../../src/backend/filters/thmltoplain.h \
     ../../../src/backend/drivers/cswordbookmoduleinfo.h \
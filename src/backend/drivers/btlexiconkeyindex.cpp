@@ -0,0 +1,226 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/drivers/btlexiconkeyindex.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <QBitArray>
+#include <QDebug>
+#include <QVector>
+
+
+namespace {
+
+const quint32 INDEX_MAGIC = 0x424b4449; // "BKDI"
+
+/** Change it once the format changed to make all systems rebuild their caches. */
+const quint32 INDEX_FORMAT = 1;
+
+const int HEADER_WORDS = 4;
+
+inline quint32 paddedSize(quint32 size) {
+    return (size + 3u) & ~3u;
+}
+
+/** Orders module indexes by the UTF-8 bytes of their keys. */
+struct KeyLess {
+    const QList<QByteArray> &keys;
+
+    inline KeyLess(const QList<QByteArray> &k) : keys(k) {}
+
+    inline bool operator()(quint32 a, quint32 b) const {
+        const QByteArray &ka = keys.at(a);
+        const QByteArray &kb = keys.at(b);
+        return BtLexiconKeyIndex::compare(ka.constData(), ka.size(),
+                                          kb.constData(), kb.size()) < 0;
+    }
+};
+
+inline void appendWord(QByteArray &data, quint32 word) {
+    data.append(reinterpret_cast<const char *>(&word), sizeof(word));
+}
+
+} // anonymous namespace
+
+int BtLexiconKeyIndex::compare(const char *a, int aSize, const char *b, int bSize) {
+    const int r = memcmp(a, b, qMin(aSize, bSize));
+    return (r != 0) ? r : (aSize - bSize);
+}
+
+BtLexiconKeyIndex::BtLexiconKeyIndex()
+    : m_count(0)
+    , m_offsets(0)
+    , m_sorted(0)
+    , m_keys(0)
+{
+    // Intentionally empty
+}
+
+bool BtLexiconKeyIndex::load(const QString &fileName, const QString &version) {
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    const uchar * const data = m_file.map(0, m_file.size());
+    if (data != 0 && setData(data, m_file.size(), version))
+        return true;
+
+    m_file.close();
+    return false;
+}
+
+void BtLexiconKeyIndex::create(const QString &fileName,
+                               const QString &version,
+                               const QList<QByteArray> &keys)
+{
+    const QByteArray versionData = version.toUtf8();
+
+    QVector<quint32> sorted(keys.size());
+    for (int i = 0; i < keys.size(); i++)
+        sorted[i] = i;
+    std::stable_sort(sorted.begin(), sorted.end(), KeyLess(keys));
+
+    QByteArray data;
+    appendWord(data, INDEX_MAGIC);
+    appendWord(data, INDEX_FORMAT);
+    appendWord(data, keys.size());
+    appendWord(data, versionData.size());
+    data.append(versionData);
+    data.append(QByteArray(paddedSize(versionData.size()) - versionData.size(), '\0'));
+
+    quint32 offset = 0;
+    appendWord(data, offset);
+    Q_FOREACH (const QByteArray &key, keys) {
+        offset += key.size();
+        appendWord(data, offset);
+    }
+    Q_FOREACH (quint32 index, sorted)
+        appendWord(data, index);
+    Q_FOREACH (const QByteArray &key, keys)
+        data.append(key);
+
+    // Prefer the mapped file, so the keys don't take up memory of our own:
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        && file.write(data) == data.size())
+    {
+        file.close();
+        if (load(fileName, version))
+            return;
+    } else {
+        qWarning() << "Failed to write the lexicon key index" << fileName;
+    }
+
+    m_memory = data;
+    const bool ok = setData(reinterpret_cast<const uchar *>(m_memory.constData()),
+                            m_memory.size(), version);
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+}
+
+bool BtLexiconKeyIndex::setData(const uchar *data,
+                                qint64 size,
+                                const QString &version)
+{
+    const quint32 * const header = reinterpret_cast<const quint32 *>(data);
+    if (size < HEADER_WORDS * 4
+        || header[0] != INDEX_MAGIC
+        || header[1] != INDEX_FORMAT)
+        return false;
+
+    const quint32 count = header[2];
+    const quint32 versionSize = header[3];
+    if (count > quint32(INT_MAX) || versionSize > size)
+        return false;
+
+    const qint64 tableStart = HEADER_WORDS * 4 + ((qint64(versionSize) + 3) & ~qint64(3));
+    const qint64 keysStart = tableStart + (2 * qint64(count) + 1) * 4;
+    if (keysStart > size)
+        return false;
+
+    const char * const versionData = reinterpret_cast<const char *>(data) + HEADER_WORDS * 4;
+    if (QString::fromUtf8(versionData, versionSize) != version)
+        return false;
+
+    /* The file may be damaged or written by something else, so every offset
+       and every entry of the sorted permutation is checked once here instead
+       of on each access: */
+    const quint32 * const offsets = reinterpret_cast<const quint32 *>(data + tableStart);
+    if (offsets[0] != 0u || keysStart + offsets[count] > size)
+        return false;
+    for (quint32 i = 0; i < count; i++)
+        if (offsets[i + 1] < offsets[i])
+            return false;
+
+    const quint32 * const sorted = offsets + count + 1;
+    QBitArray seen(count);
+    for (quint32 i = 0; i < count; i++) {
+        if (sorted[i] >= count || seen.testBit(sorted[i]))
+            return false;
+        seen.setBit(sorted[i]);
+    }
+
+    m_count = count;
+    m_offsets = offsets;
+    m_sorted = sorted;
+    m_keys = reinterpret_cast<const char *>(data) + keysStart;
+    return true;
+}
+
+QString BtLexiconKeyIndex::key(int index) const {
+    Q_ASSERT(index >= 0 && index < m_count);
+    int size;
+    const char * const data = keyData(index, size);
+    return QString::fromUtf8(data, size);
+}
+
+int BtLexiconKeyIndex::lowerBound(const QByteArray &key) const {
+    int first = 0;
+    int length = m_count;
+    while (length > 0) {
+        const int half = length / 2;
+        int size;
+        const char * const data = keyData(m_sorted[first + half], size);
+        if (compare(data, size, key.constData(), key.size()) < 0) {
+            first += half + 1;
+            length -= half + 1;
+        } else {
+            length = half;
+        }
+    }
+    return first;
+}
+
+int BtLexiconKeyIndex::indexOf(const QString &key) const {
+    const QByteArray utf8 = key.toUtf8();
+    const int pos = lowerBound(utf8);
+    if (pos >= m_count)
+        return -1;
+
+    int size;
+    const char * const data = keyData(m_sorted[pos], size);
+    return (compare(data, size, utf8.constData(), utf8.size()) == 0)
+           ? static_cast<int>(m_sorted[pos])
+           : -1;
+}
+
+int BtLexiconKeyIndex::indexOfPrefix(const QString &prefix) const {
+    const QByteArray utf8 = prefix.toUtf8();
+    const int pos = lowerBound(utf8);
+    if (pos >= m_count)
+        return -1;
+
+    int size;
+    const char * const data = keyData(m_sorted[pos], size);
+    return (size >= utf8.size() && memcmp(data, utf8.constData(), utf8.size()) == 0)
+           ? static_cast<int>(m_sorted[pos])
+           : -1;
+}
@@ -0,0 +1,123 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTLEXICONKEYINDEX_H
+#define BTLEXICONKEYINDEX_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+
+/**
+  \brief Read-only index of the keys of a lexicon module.
+
+  The keys are kept as UTF-8 in a single block of memory which is normally a
+  memory-mapped cache file, so the keys don't have to be loaded or converted
+  to QStrings before they are actually used. Besides the keys in module
+  order, the index contains a permutation of the keys sorted by their UTF-8
+  bytes, which allows exact and prefix lookups in O(log n).
+
+  Layout of the data, all numbers are native 32-bit unsigned integers:
+  \verbatim
+    magic, format, count, version size
+    version (UTF-8, padded to a multiple of 4 bytes)
+    offsets[count + 1]   start of each key in the key data
+    sorted[count]        module indexes of the keys in sorted order
+    key data
+  \endverbatim
+*/
+class BtLexiconKeyIndex {
+
+    public: /* Methods: */
+
+        BtLexiconKeyIndex();
+
+        /**
+          Maps the given index file.
+          \param[in] version The version of the module, the index is rejected
+                             if it was created for another version.
+          \returns whether the file contained a valid index.
+        */
+        bool load(const QString &fileName, const QString &version);
+
+        /**
+          Creates the index for the given keys in memory and writes it to the
+          given file. If the file was written, it is mapped and the memory is
+          released again.
+        */
+        void create(const QString &fileName,
+                    const QString &version,
+                    const QList<QByteArray> &keys);
+
+        inline int count() const { return m_count; }
+        inline bool isEmpty() const { return m_count == 0; }
+
+        /** \returns the key with the given index in module order. */
+        QString key(int index) const;
+
+        /** \returns the module index of the given key or -1 if not found. */
+        int indexOf(const QString &key) const;
+
+        /**
+          \returns the module index of the first key in sorted order which
+                   starts with \a prefix or -1 if there is no such key.
+        */
+        int indexOfPrefix(const QString &prefix) const;
+
+        /** \returns the module index of the key at the given sorted position. */
+        inline int sortedIndex(int position) const {
+            Q_ASSERT(position >= 0 && position < m_count);
+            return m_sorted[position];
+        }
+
+        /**
+          \returns the UTF-8 data of the key with the given index in module
+                   order. The data is not null-terminated.
+          \param[out] size The size of the data in bytes.
+        */
+        inline const char *keyData(int index, int &size) const {
+            Q_ASSERT(index >= 0 && index < m_count);
+            size = m_offsets[index + 1] - m_offsets[index];
+            return m_keys + m_offsets[index];
+        }
+
+        /**
+          Compares UTF-8 keys bytewise, which is the order of sortedIndex().
+          \returns a value less than, equal to or greater than zero.
+        */
+        static int compare(const char *a, int aSize, const char *b, int bSize);
+
+    private: /* Methods: */
+
+        /**
+          Uses the index in \a data if it was created for \a version and all
+          of its offsets and sorted positions are in range.
+          \returns whether the index is usable.
+        */
+        bool setData(const uchar *data, qint64 size, const QString &version);
+
+        /** \returns the first position in sorted order not less than key. */
+        int lowerBound(const QByteArray &key) const;
+
+    private: /* Fields: */
+
+        QFile m_file;
+        QByteArray m_memory;
+        int m_count;
+        const quint32 *m_offsets;
+        const quint32 *m_sorted;
+        const char *m_keys;
+
+};
+
+#endif
@@ -10,7 +10,6 @@
 #include "backend/drivers/cswordlexiconmoduleinfo.h"
 
 #include <QFile>
-#include <QDataStream>
 #include <QTextCodec>
 #include <QDebug>
 
@@ -20,95 +19,160 @@
 #include <swmodule.h>
 
 
-//Change it once the format changed to make all systems rebuild their caches
-#define CACHE_FORMAT "3"
+namespace {
 
-const QStringList &CSwordLexiconModuleInfo::entries() const {
-    namespace DU = util::directory;
+/** Strong's numbers are below 10000, this just guards the table size. */
+const int MAX_STRONGS_NUMBER = 100000;
 
-    // If cache is ok, just return it:
-    if (!m_entries.empty()) {
-        return m_entries;
+/**
+  \returns the Strong's number of keys like "00123", "G0123" or "H123" or -1
+           if the key is not of that form.
+*/
+int strongsNumber(const char * key, int size) {
+    if (size > 0 && (*key == 'G' || *key == 'H')) {
+        key++;
+        size--;
+    }
+    if (size <= 0)
+        return -1;
+
+    int number = 0;
+    for (; size > 0; key++, size--) {
+        if (*key < '0' || *key > '9')
+            return -1;
+        number = number * 10 + (*key - '0');
+        if (number >= MAX_STRONGS_NUMBER)
+            return -1;
     }
+    return number;
+}
 
-    QString dir(DU::getUserCacheDir().absolutePath());
-    QFile f1( QString(dir).append("/").append(name()));
-
-    /*
-     * Try the module's cache
-     */
-    if ( f1.open( QIODevice::ReadOnly ) ) {
-        QDataStream s( &f1 );
-        QString ModuleVersion, CacheVersion, QDataStreamVersion;
-        s >> ModuleVersion;
-        s >> CacheVersion;
-        s >> QDataStreamVersion;
-
-        qDebug() << "Lexicon cache metadata"
-        << "Name" << name()
-        << "ModuleVersion" << ModuleVersion
-        << "CacheVersion" << CacheVersion
-        << "QDataStreamVersion" << QDataStreamVersion;
-
-        // Check if cache is valid
-        if (ModuleVersion == config(CSwordModuleInfo::ModuleVersion)
-                && CacheVersion == CACHE_FORMAT
-                && QDataStreamVersion == QString::number(s.version())) {
-            s >> m_entries;
-
-            f1.close();
-            qDebug() << "Read" << m_entries.count() << "entries from lexicon cache for module" << name();
-            return m_entries;
-        }
+} // anonymous namespace
 
-        f1.close();
-    }
+struct CSwordLexiconModuleInfo::KeyIndexBuilder {
+    QList<QByteArray> keys;
 
-    /*
-     * Ok, no cache or invalid.
-     */
-    qDebug() << "Read all entries of lexicon" << name();
+    /** The last key read from the module, to continue after it. */
+    QByteArray lastKey;
+};
 
-    module()->setSkipConsecutiveLinks(true);
-    module()->setPosition(sword::TOP);
-    snap(); //snap to top entry
+QString CSwordLexiconModuleInfo::keyIndexFileName() const {
+    namespace DU = util::directory;
+    return DU::getUserCacheDir().absolutePath().append("/").append(name()).append(".keyindex");
+}
+
+bool CSwordLexiconModuleInfo::hasKeyIndex() const {
+    if (m_keyIndex)
+        return true;
+
+    QSharedPointer<BtLexiconKeyIndex> index(new BtLexiconKeyIndex);
+    if (!index->load(keyIndexFileName(), config(CSwordModuleInfo::ModuleVersion)))
+        return false;
+
+    qDebug() << "Mapped" << index->count() << "entries from lexicon cache for module" << name();
+    m_keyIndex = index;
+    return true;
+}
+
+bool CSwordLexiconModuleInfo::buildKeyIndex(int maxKeys) const {
+    namespace DU = util::directory;
 
-    do {
-        if ( isUnicode() ) {
-            m_entries.append(QString::fromUtf8(module()->getKeyText()));
+    if (m_keyIndex)
+        return true;
+
+    sword::SWModule * const m = module();
+    m->setSkipConsecutiveLinks(true);
+
+    bool done;
+    if (!m_keyIndexBuilder) {
+        qDebug() << "Read all entries of lexicon" << name();
+        m_keyIndexBuilder = QSharedPointer<KeyIndexBuilder>(new KeyIndexBuilder);
+        m->setPosition(sword::TOP);
+        snap(); //snap to top entry
+        done = false;
+    } else {
+        // Someone else may have moved the module in between, so go back:
+        m->getKey()->setText(m_keyIndexBuilder->lastKey.constData());
+        snap();
+        m->popError();
+        m->increment();
+        done = m->popError();
+    }
+
+    QList<QByteArray> &keys = m_keyIndexBuilder->keys;
+    QTextCodec * const codec = isUnicode() ? 0 : QTextCodec::codecForName("Windows-1252");
+
+    for (int i = 0; !done && (maxKeys < 0 || i < maxKeys); i++) {
+        const char * const keyText = m->getKeyText();
+        m_keyIndexBuilder->lastKey = keyText;
+        if (codec == 0) {
+            keys.append(QByteArray(keyText));
         }
         else {
-            //for latin1 modules use fromLatin1 because of speed
-            QTextCodec* codec = QTextCodec::codecForName("Windows-1252");
-            m_entries.append(codec->toUnicode(module()->getKeyText()));
+            keys.append(codec->toUnicode(keyText).toUtf8());
         }
 
-        module()->increment();
-    } while (!module()->popError());
+        m->increment();
+        done = m->popError();
+    }
+
+    m->setSkipConsecutiveLinks(false);
+    if (!done)
+        return false;
 
-    module()->setPosition(sword::TOP); // back to the first entry
-    module()->setSkipConsecutiveLinks(false);
+    m->setPosition(sword::TOP); // back to the first entry
 
     /// \todo Document why the following code is here:
-    if (!m_entries.empty() && m_entries.front().simplified().isEmpty())
-        m_entries.pop_front();
+    if (!keys.empty() && keys.front().simplified().isEmpty())
+        keys.pop_front();
 
     qDebug() << "Writing cache file for lexicon module" << name();
+    QSharedPointer<BtLexiconKeyIndex> index(new BtLexiconKeyIndex);
+    index->create(keyIndexFileName(), config(CSwordModuleInfo::ModuleVersion), keys);
+    m_keyIndex = index;
+    m_keyIndexBuilder.clear();
+
+    // Remove the cache file of older versions:
+    QFile::remove(DU::getUserCacheDir().absolutePath().append("/").append(name()));
 
-    if (m_entries.count()) {
-        //create cache
-        QString dir(DU::getUserCacheDir().absolutePath());
-        QFile f2( QString(dir).append("/").append(name()) );
-
-        if (f2.open( QIODevice::WriteOnly )) {
-            QDataStream s( &f2 );
-            s << config(CSwordModuleInfo::ModuleVersion) //store module version
-            << QString(CACHE_FORMAT) //store BT version -- format may change
-            << QString::number(s.version()) //store QDataStream version -- format may change
-            << m_entries;
-            f2.close();
+    return true;
+}
+
+const BtLexiconKeyIndex &CSwordLexiconModuleInfo::keyIndex() const {
+    if (!hasKeyIndex())
+        buildKeyIndex(-1);
+
+    return *m_keyIndex;
+}
+
+QString CSwordLexiconModuleInfo::strongsKey(int number) const {
+    if (!m_strongsEntries) {
+        const BtLexiconKeyIndex &index = keyIndex();
+        m_strongsEntries = QSharedPointer<QVector<int> >(new QVector<int>);
+        QVector<int> &entries = *m_strongsEntries;
+
+        for (int i = 0; i < index.count(); i++) {
+            int size;
+            const char * const data = index.keyData(i, size);
+            const int n = strongsNumber(data, size);
+            if (n <= 0)
+                continue;
+
+            if (n >= entries.size()) {
+                const int oldSize = entries.size();
+                entries.resize(n + 1);
+                for (int j = oldSize; j < n; j++)
+                    entries[j] = -1;
+                entries[n] = i;
+            } else if (entries[n] < 0) {
+                entries[n] = i;
+            }
         }
     }
 
-    return m_entries;
+    if (number <= 0 || number >= m_strongsEntries->size())
+        return QString::null;
+
+    const int entry = m_strongsEntries->at(number);
+    return (entry >= 0) ? keyIndex().key(entry) : QString::null;
 }
@@ -14,7 +14,9 @@
 
 #include "backend/drivers/cswordmoduleinfo.h"
 
-#include <QStringList>
+#include <QSharedPointer>
+#include <QVector>
+#include "backend/drivers/btlexiconkeyindex.h"
 
 
 /**
@@ -29,17 +31,42 @@ class CSwordLexiconModuleInfo: public CSwordModuleInfo {
                 : CSwordModuleInfo(module, backend, Lexicon) {}
 
         inline CSwordLexiconModuleInfo(const CSwordLexiconModuleInfo &copy)
-            : CSwordModuleInfo(copy), m_entries(copy.m_entries) {}
+            : CSwordModuleInfo(copy)
+            , m_keyIndex(copy.m_keyIndex)
+            , m_strongsEntries(copy.m_strongsEntries) {}
 
         /**
-          This method returns the entries of the modules represented by this
-          object. If this function is called for the first time the list is load
-          from disk and stored in a list which cahes it. If the function is
-          called again, the cached list is returned so we have a major speed
-          improvement.
-          \returns the list of lexicon entries in the module.
+          \returns the index of the keys of this module. On first use the
+                   index is mapped from the cache directory or, if the cache
+                   is missing or outdated, created by reading all the keys of
+                   the module once.
         */
-        const QStringList &entries() const;
+        const BtLexiconKeyIndex &keyIndex() const;
+
+        /**
+          \returns whether the key index is available without reading the
+                   module, i.e. whether it was created already or a valid
+                   index could be mapped from the cache directory.
+        */
+        bool hasKeyIndex() const;
+
+        /**
+          Reads up to the given number of keys from the module for the key
+          index, so the index can be created in small steps from the event
+          loop. The next call continues after the last key read.
+          \param[in] maxKeys The maximum number of keys to read, or -1 to read
+                             all the remaining keys.
+          \returns whether the key index is complete.
+        */
+        bool buildKeyIndex(int maxKeys) const;
+
+        /**
+          \returns the key of the entry for the given Strong's number, e.g.
+                   "00123" or "G0123" for 123, or a null string if the module
+                   has no such entry. The table of the Strong's numbers is
+                   created from keyIndex() on first use.
+        */
+        QString strongsKey(int number) const;
 
         /**
           Jumps to the closest entry in the module.
@@ -48,11 +75,18 @@ class CSwordLexiconModuleInfo: public CSwordModuleInfo {
             return module()->getRawEntry();
         }
 
+    private: /* Types: */
+        struct KeyIndexBuilder;
+
+    private: /* Methods: */
+        QString keyIndexFileName() const;
+
     private: /* Fields: */
-        /**
-          This is the list which caches the entres of the module.
-        */
-        mutable QStringList m_entries;
+        mutable QSharedPointer<BtLexiconKeyIndex> m_keyIndex;
+        mutable QSharedPointer<KeyIndexBuilder> m_keyIndexBuilder;
+
+        /** Key indexes of the entries by Strong's number, -1 if missing. */
+        mutable QSharedPointer<QVector<int> > m_strongsEntries;
 };
 
 #endif
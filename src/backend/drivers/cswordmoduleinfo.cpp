@@ -10,17 +10,21 @@
 #include "backend/drivers/cswordmoduleinfo.h"
 
 #include <CLucene.h>
+#include <cstring>
 #include <QByteArray>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
-#include <QFileInfo>
+#include <QPair>
 #include <QSettings>
 #include <QSharedPointer>
 #include <QTextDocument>
+#include <QVector>
 #include "backend/config/btconfig.h"
 #include "backend/drivers/cswordlexiconmoduleinfo.h"
+#include "backend/keys/btversificationmap.h"
 #include "backend/keys/cswordkey.h"
+#include "backend/managers/btindexcatalog.h"
 #include "backend/managers/clanguagemgr.h"
 #include "backend/managers/cswordbackend.h"
 #include "backend/rendering/centrydisplay.h"
@@ -51,6 +55,42 @@ const unsigned int INDEX_VERSION = 7;
 //Lucene default is too small
 const unsigned long BT_MAX_LUCENE_FIELD_LENGTH = 1024 * 1024;
 
+namespace {
+
+typedef QPair<long, long> IndexRange;
+
+/**
+  Maps the bounds of the verse ranges of a search scope to verse indexes in the
+  given versification.
+  \returns the ranges or an empty vector if a bound has no corresponding verse.
+*/
+QVector<IndexRange> scopeIndexRanges(const sword::ListKey &scope,
+                                     const char *versification)
+{
+    QVector<IndexRange> ranges;
+    for (int i = 0; i < scope.getCount(); i++) {
+        Q_ASSERT(dynamic_cast<const sword::VerseKey *>(scope.getElement(i)));
+        const sword::VerseKey * const vkey = static_cast<const sword::VerseKey *>(scope.getElement(i));
+        long lower = vkey->getLowerBound().getIndex();
+        long upper = vkey->getUpperBound().getIndex();
+
+        const char * const scopeVersification = vkey->getVersificationSystem();
+        if (strcmp(scopeVersification, versification)) {
+            const BtVersificationMap &map = BtVersificationMap::get(scopeVersification,
+                                                                    versification);
+            lower = map.map(lower);
+            upper = map.map(upper);
+        }
+        if (lower < 0 || upper < 0)
+            return QVector<IndexRange>();
+
+        ranges.append(IndexRange(lower, upper));
+    }
+    return ranges;
+}
+
+} // anonymous namespace
+
 CSwordModuleInfo::CSwordModuleInfo(sword::SWModule * module,
                                    CSwordBackend & backend,
                                    ModuleType type)
@@ -59,65 +99,13 @@ CSwordModuleInfo::CSwordModuleInfo(sword::SWModule * module,
       m_type(type),
       m_cancelIndexing(false),
       m_cachedName(QString::fromUtf8(module->getName())),
-      m_cachedHasVersion(!QString((*m_backend.getConfig())[module->getName()]["Version"]).isEmpty())
+      m_cachedCategoryValid(false),
+      m_cachedCategory(UnknownCategory),
+      m_cachedLanguage(0),
+      m_cachedHasVersionValid(false),
+      m_cachedHasVersion(false)
 {
-    // Initialize m_cachedCategory:
-    {
-        /// \todo Maybe we can use raw string comparsion instead of QString?
-        QString const cat(m_module->getConfigEntry("Category"));
-
-        /// \warning cat has to be checked before m_type !!!
-        if (cat == "Cults / Unorthodox / Questionable Material") {
-            m_cachedCategory = Cult;
-        } else if (cat == "Daily Devotional"
-                   || m_module->getConfig().has("Feature","DailyDevotion"))
-        {
-            m_cachedCategory = DailyDevotional;
-        } else if (cat == "Glossaries"
-                   || m_module->getConfig().has("Feature", "Glossary"))
-        {
-            m_cachedCategory = Glossary;
-        } else if (cat == "Images" || cat == "Maps") {
-            m_cachedCategory = Images;
-        } else {
-            switch (m_type) {
-                case Bible:       m_cachedCategory = Bibles; break;
-                case Commentary:  m_cachedCategory = Commentaries; break;
-                case Lexicon:     m_cachedCategory = Lexicons; break;
-                case GenericBook: m_cachedCategory = Books; break;
-                case Unknown: // Fall thru
-                default:          m_cachedCategory = UnknownCategory; break;
-            }
-        }
-    }
-
-    // Initialize m_cachedLanguage:
-    {
-        CLanguageMgr const & lm = *CLanguageMgr::instance();
-        if (m_cachedCategory == Glossary) {
-            /*
-              Special handling for glossaries, we use the "from language" as
-              language for the module.
-            */
-            m_cachedLanguage = lm.languageForAbbrev(config(GlossaryFrom));
-        } else {
-            m_cachedLanguage = lm.languageForAbbrev(m_module->getLanguage());
-        }
-    }
-
-    m_hidden = btConfig().value<QStringList>("state/hiddenModules",
-                                             QStringList()).contains(m_cachedName);
-
-    if (m_cachedHasVersion
-        && (minimumSwordVersion() > sword::SWVersion::currentVersion))
-    {
-        qWarning("The module \"%s\" requires a newer Sword library. Please "
-                 "update to \"Sword %s\".",
-                 m_cachedName.toUtf8().constData(),
-                 minimumSwordVersion().getText());
-
-        /// \todo if this is the case, can we use the module at all?
-    }
+    // Intentionally empty
 }
 
 CSwordModuleInfo::CSwordModuleInfo(const CSwordModuleInfo & copy)
@@ -125,16 +113,81 @@ CSwordModuleInfo::CSwordModuleInfo(const CSwordModuleInfo & copy)
     , m_module(copy.m_module)
     , m_backend(copy.m_backend)
     , m_type(copy.m_type)
-    , m_hidden(copy.m_hidden)
     , m_cancelIndexing(copy.m_cancelIndexing)
     , m_cachedName(copy.m_cachedName)
+    , m_cachedCategoryValid(copy.m_cachedCategoryValid)
     , m_cachedCategory(copy.m_cachedCategory)
     , m_cachedLanguage(copy.m_cachedLanguage)
+    , m_cachedHasVersionValid(copy.m_cachedHasVersionValid)
     , m_cachedHasVersion(copy.m_cachedHasVersion)
 {
     // Intentionally empty
 }
 
+CSwordModuleInfo::Category CSwordModuleInfo::category() const {
+    if (m_cachedCategoryValid)
+        return m_cachedCategory;
+
+    /// \todo Maybe we can use raw string comparsion instead of QString?
+    QString const cat(m_module->getConfigEntry("Category"));
+
+    /// \warning cat has to be checked before m_type !!!
+    if (cat == "Cults / Unorthodox / Questionable Material") {
+        m_cachedCategory = Cult;
+    } else if (cat == "Daily Devotional"
+               || m_module->getConfig().has("Feature","DailyDevotion"))
+    {
+        m_cachedCategory = DailyDevotional;
+    } else if (cat == "Glossaries"
+               || m_module->getConfig().has("Feature", "Glossary"))
+    {
+        m_cachedCategory = Glossary;
+    } else if (cat == "Images" || cat == "Maps") {
+        m_cachedCategory = Images;
+    } else {
+        switch (m_type) {
+            case Bible:       m_cachedCategory = Bibles; break;
+            case Commentary:  m_cachedCategory = Commentaries; break;
+            case Lexicon:     m_cachedCategory = Lexicons; break;
+            case GenericBook: m_cachedCategory = Books; break;
+            case Unknown: // Fall thru
+            default:          m_cachedCategory = UnknownCategory; break;
+        }
+    }
+    m_cachedCategoryValid = true;
+    return m_cachedCategory;
+}
+
+const CLanguageMgr::Language * CSwordModuleInfo::language() const {
+    if (m_cachedLanguage != 0)
+        return m_cachedLanguage;
+
+    CLanguageMgr const & lm = *CLanguageMgr::instance();
+    if (category() == Glossary) {
+        /*
+          Special handling for glossaries, we use the "from language" as
+          language for the module.
+        */
+        m_cachedLanguage = lm.languageForAbbrev(config(GlossaryFrom));
+    } else {
+        m_cachedLanguage = lm.languageForAbbrev(m_module->getLanguage());
+    }
+    return m_cachedLanguage;
+}
+
+bool CSwordModuleInfo::hasVersion() const {
+    if (!m_cachedHasVersionValid) {
+        const char * const version = m_module->getConfigEntry("Version");
+        m_cachedHasVersion = (version != 0 && *version != '\0');
+        m_cachedHasVersionValid = true;
+    }
+    return m_cachedHasVersion;
+}
+
+bool CSwordModuleInfo::isHidden() const {
+    return m_backend.isModuleHidden(m_cachedName);
+}
+
 bool CSwordModuleInfo::unlock(const QString & unlockKey) {
     if (!isEncrypted())
         return false;
@@ -216,34 +269,29 @@ QString CSwordModuleInfo::getModuleStandardIndexLocation() const {
 }
 
 bool CSwordModuleInfo::hasIndex() const {
-    { // Is this a directory?
-        QFileInfo fi(getModuleStandardIndexLocation());
-        if (!fi.isDir())
-            return false;
+    // Is there a completely built index?
+    BtIndexCatalog::Entry entry;
+    if (!BtIndexCatalog::instance().entry(m_cachedName, entry)
+        || entry.state != BtIndexCatalog::Ready)
+    {
+        return false;
     }
 
     // Are the index version and module version OK?
-    QSettings module_config(getModuleBaseIndexLocation()
-                            + QString("/bibletime-index.conf"),
-                            QSettings::IniFormat);
-
-    if (m_cachedHasVersion
-        && module_config.value("module-version").toString()
-           != config(CSwordModuleInfo::ModuleVersion))
+    if (hasVersion()
+        && entry.moduleVersion != config(CSwordModuleInfo::ModuleVersion))
     {
         return false;
     }
 
-    if (module_config.value("index-version").toUInt() != INDEX_VERSION) {
+    if (entry.indexVersion != INDEX_VERSION) {
         qDebug("%s: INDEX_VERSION is not compatible with this version of "
                "BibleTime.",
                m_cachedName.toUtf8().constData());
         return false;
     }
 
-    // Is the index there?
-    return lucene::index::IndexReader::indexExists(getModuleStandardIndexLocation()
-                                                   .toLatin1().constData());
+    return true;
 }
 
 bool CSwordModuleInfo::buildIndex() {
@@ -251,19 +299,20 @@ bool CSwordModuleInfo::buildIndex() {
 
     try {
         // Without this we don't get strongs, lemmas, etc.
-        m_backend.setFilterOptions(btConfig().getFilterOptions());
+        FilterOptions indexOptions(btConfig().getFilterOptions());
         /* Make sure we reset all important filter options which influcence the
            plain filters. Turn on these options, they are needed for the
            EntryAttributes population */
-        m_backend.setOption(CSwordModuleInfo::strongNumbers, true);
-        m_backend.setOption(CSwordModuleInfo::morphTags, true);
-        m_backend.setOption(CSwordModuleInfo::footnotes, true);
-        m_backend.setOption(CSwordModuleInfo::headings, true);
+        indexOptions.strongNumbers = 1;
+        indexOptions.morphTags = 1;
+        indexOptions.footnotes = 1;
+        indexOptions.headings = 1;
         /* We don't want the following in the text, the do not carry searchable
            information. */
-        m_backend.setOption(CSwordModuleInfo::morphSegmentation, false);
-        m_backend.setOption(CSwordModuleInfo::scriptureReferences, false);
-        m_backend.setOption(CSwordModuleInfo::redLetterWords, false);
+        indexOptions.morphSegmentation = 0;
+        indexOptions.scriptureReferences = 0;
+        indexOptions.redLetterWords = 0;
+        m_backend.setFilterOptions(indexOptions);
 
         // Do not use any stop words:
         static const TCHAR * stop_words[1u]  = { NULL };
@@ -275,6 +324,9 @@ bool CSwordModuleInfo::buildIndex() {
         dir.mkpath(getModuleBaseIndexLocation());
         dir.mkpath(getModuleStandardIndexLocation());
 
+        // Until it is complete, the index must not be used:
+        BtIndexCatalog::instance().setEntry(m_cachedName, BtIndexCatalog::Entry());
+
         if (lucene::index::IndexReader::indexExists(index.toLatin1().constData()))
             if (lucene::index::IndexReader::isLocked(index.toLatin1().constData()))
                 lucene::index::IndexReader::unlock(index.toLatin1().constData());
@@ -301,7 +353,7 @@ bool CSwordModuleInfo::buildIndex() {
         if (m_type == CSwordModuleInfo::Lexicon) {
             verseIndex = 0;
             verseLowIndex = 0;
-            verseSpan = static_cast<CSwordLexiconModuleInfo *>(this)->entries().size();
+            verseSpan = static_cast<CSwordLexiconModuleInfo *>(this)->keyIndex().count();
         }
 
         emit indexingProgress(0);
@@ -441,10 +493,20 @@ bool CSwordModuleInfo::buildIndex() {
             QSettings module_config(getModuleBaseIndexLocation()
                                     + QString("/bibletime-index.conf"),
                                     QSettings::IniFormat);
-            if (m_cachedHasVersion)
+            if (hasVersion())
                 module_config.setValue("module-version",
                                        config(CSwordModuleInfo::ModuleVersion));
             module_config.setValue("index-version", INDEX_VERSION);
+            module_config.sync();
+
+            BtIndexCatalog::Entry entry;
+            if (hasVersion())
+                entry.moduleVersion = config(CSwordModuleInfo::ModuleVersion);
+            entry.indexVersion = INDEX_VERSION;
+            entry.size = util::directory::getDirSizeRecursive(getModuleBaseIndexLocation());
+            entry.state = BtIndexCatalog::Ready;
+            BtIndexCatalog::instance().setEntry(m_cachedName, entry);
+
             emit hasIndexChanged(true);
         }
     } catch (CLuceneError & e) {
@@ -477,11 +539,14 @@ void CSwordModuleInfo::deleteIndex() {
 
 void CSwordModuleInfo::deleteIndexForModule(const QString & name) {
     util::directory::removeRecursive(getGlobalBaseIndexLocation() + "/" + name);
+    BtIndexCatalog::instance().remove(name);
 }
 
 unsigned long CSwordModuleInfo::indexSize() const {
-    namespace DU = util::directory;
-    return DU::getDirSizeRecursive(getModuleBaseIndexLocation());
+    BtIndexCatalog::Entry entry;
+    if (!BtIndexCatalog::instance().entry(m_cachedName, entry))
+        return 0u;
+    return static_cast<unsigned long>(entry.size);
 }
 
 int CSwordModuleInfo::searchIndexed(const QString & searchedText,
@@ -530,6 +595,13 @@ int CSwordModuleInfo::searchIndexed(const QString & searchedText,
         lucene::document::Document * doc = 0;
         QSharedPointer<sword::SWKey> swKey(m_module->createKey());
 
+        /* Verse results are filtered by their index in the versification of
+           the module, which also works for scopes of other versifications: */
+        QVector<IndexRange> scopeRanges;
+        const sword::VerseKey * const moduleVKey = dynamic_cast<const sword::VerseKey *>(swKey.data());
+        if (useScope && moduleVKey)
+            scopeRanges = scopeIndexRanges(scope, moduleVKey->getVersificationSystem());
+
 #ifdef CLUCENE2
         for (unsigned int i = 0; i < h->length(); ++i) {
 #else
@@ -543,7 +615,13 @@ int CSwordModuleInfo::searchIndexed(const QString & searchedText,
             swKey->setText(utfBuffer);
 
             // Limit results based on scope:
-            if (useScope) {
+            if (!scopeRanges.isEmpty()) {
+                const long index = moduleVKey->getIndex();
+                Q_FOREACH (const IndexRange &range, scopeRanges) {
+                    if (range.first <= index && index <= range.second)
+                        results.add(*swKey);
+                }
+            } else if (useScope) {
                 for (int j = 0; j < scope.getCount(); j++) {
                     Q_ASSERT(dynamic_cast<const sword::VerseKey *>(scope.getElement(j)));
                     const sword::VerseKey * const vkey = static_cast<const sword::VerseKey *>(scope.getElement(j));
@@ -637,7 +715,7 @@ QString CSwordModuleInfo::config(const CSwordModuleInfo::ConfigEntry entry) cons
         }
 
         case GlossaryFrom: {
-            if (m_cachedCategory != Glossary)
+            if (category() != Glossary)
                 return QString::null;
 
             const QString lang(getSimpleConfigEntry("GlossaryFrom"));
@@ -645,7 +723,7 @@ QString CSwordModuleInfo::config(const CSwordModuleInfo::ConfigEntry entry) cons
         }
 
         case GlossaryTo: {
-            if (m_cachedCategory != Glossary) {
+            if (category() != Glossary) {
                 return QString::null;
             };
 
@@ -756,7 +834,7 @@ QString CSwordModuleInfo::aboutText() const {
 
     text += row
             .arg(tr("Version"))
-            .arg(m_cachedHasVersion
+            .arg(hasVersion()
                  ? htmlEscape(config(CSwordModuleInfo::ModuleVersion))
                  : tr("unknown"));
 
@@ -775,7 +853,7 @@ QString CSwordModuleInfo::aboutText() const {
 
     text += row
             .arg(tr("Language"))
-            .arg(htmlEscape(m_cachedLanguage->translatedName()));
+            .arg(htmlEscape(language()->translatedName()));
 
     if (m_module->getConfigEntry("Category"))
         text += row
@@ -820,7 +898,7 @@ QString CSwordModuleInfo::aboutText() const {
     text += "</table><hr>";
 
     // Clearly say the module contains cult/questionable materials
-    if (m_cachedCategory == Cult)
+    if (category() == Cult)
         text += QString("<br/><b>%1</b><br/><br/>")
                 .arg(tr("Take care, this work contains cult / questionable "
                         "material!"));
@@ -880,7 +958,7 @@ QIcon CSwordModuleInfo::moduleIcon(const CSwordModuleInfo & module) {
 }
 
 const QString & CSwordModuleInfo::moduleIconFilename(const CSwordModuleInfo & module) {
-    const CSwordModuleInfo::Category cat(module.m_cachedCategory);
+    const CSwordModuleInfo::Category cat(module.category());
     switch (cat) {
         case CSwordModuleInfo::Bibles:
             return module.isLocked()
@@ -996,18 +1074,10 @@ QString CSwordModuleInfo::getFormattedConfigEntry(const QString & name) const {
 }
 
 bool CSwordModuleInfo::setHidden(bool hide) {
-    if (m_hidden == hide)
+    if (isHidden() == hide)
         return false;
 
-    m_hidden = hide;
-    QStringList hiddenModules(btConfig().value<QStringList>("state/hiddenModules"));
-    Q_ASSERT(hiddenModules.contains(m_cachedName) != hide);
-    if (hide) {
-        hiddenModules.append(m_cachedName);
-    } else {
-        hiddenModules.removeOne(m_cachedName);
-    }
-    btConfig().setValue("state/hiddenModules", hiddenModules);
+    m_backend.setModuleHidden(m_cachedName, hide);
     emit hiddenChanged(hide);
     return true;
 }
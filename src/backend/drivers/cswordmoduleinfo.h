@@ -227,9 +227,7 @@ wrong, or if the config file was write protected return false.
       \retval true if this module has a version number
       \retval false if it doesn't have a version number
     */
-    inline bool hasVersion() const {
-        return m_cachedHasVersion;
-    }
+    bool hasVersion() const;
 
     /**
       \returns true if the module's index has been built.
@@ -322,9 +320,7 @@ wrong, or if the config file was write protected return false.
     /**
       \returns the language of the module.
     */
-    inline const CLanguageMgr::Language * language() const {
-        return m_cachedLanguage;
-    }
+    const CLanguageMgr::Language * language() const;
 
     /**
       \returns whether this module may be written to.
@@ -336,9 +332,7 @@ wrong, or if the config file was write protected return false.
     /**
     * Returns true if this module is hidden (not to be shown with other modules in certain views).
     */
-    inline bool isHidden() const {
-        return m_hidden;
-    }
+    bool isHidden() const;
 
     /**
       Shows or hides the module.
@@ -350,9 +344,7 @@ wrong, or if the config file was write protected return false.
     /**
       \returns the category of this module.
     */
-    inline CSwordModuleInfo::Category category() const {
-        return m_cachedCategory;
-    }
+    CSwordModuleInfo::Category category() const;
 
     /**
     * The about text which belongs to this module.
@@ -438,14 +430,18 @@ private: /* Fields: */
     sword::SWModule * const m_module;
     CSwordBackend & m_backend;
     ModuleType m_type;
-    bool m_hidden;
     bool m_cancelIndexing;
 
     // Cached data:
     const QString m_cachedName;
-    CSwordModuleInfo::Category m_cachedCategory;
-    const CLanguageMgr::Language * m_cachedLanguage;
-    bool m_cachedHasVersion;
+
+    /* Read from the configuration of the module on first use, so that
+       creating the module infos of all installed modules stays cheap: */
+    mutable bool m_cachedCategoryValid;
+    mutable CSwordModuleInfo::Category m_cachedCategory;
+    mutable const CLanguageMgr::Language * m_cachedLanguage; // 0 until read
+    mutable bool m_cachedHasVersionValid;
+    mutable bool m_cachedHasVersion;
 
 };
 
@@ -9,9 +9,10 @@
 
 #include "backend/filters/gbftohtml.h"
 
-#include <QRegExp>
+#include <cstring>
 #include <QString>
 #include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/filters/wordspanbuilder.h"
 #include "backend/managers/cswordbackend.h"
 
 // Sword includes:
@@ -70,160 +71,159 @@ Filters::GbfToHtml::GbfToHtml() : sword::GBFHTML() {
     addTokenSubstitute("JL", "</span>"); // align end
 }
 
-/** No descriptions */
-char Filters::GbfToHtml::processText(sword::SWBuf& buf, const sword::SWKey * key, const sword::SWModule * module) {
-    GBFHTML::processText(buf, key, module);
+namespace {
 
-    if (!module->isProcessEntryAttributes()) {
-        return 1; //no processing should be done, may happen in a search
-    }
+inline bool isSeparator(char c) {
+    return c == '.' || c == ',' || c == ';' || c == ':';
+}
 
-    CSwordModuleInfo* m = CSwordBackend::instance()->findModuleByName( module->getName() );
+/**
+  \returns the closing '>' of the word tag (<WH...>, <WG...> or <WT...>) which
+           starts at \a p or 0 if there is no such tag at \a p.
+*/
+inline const char * wordTagEnd(const char * p, const char * end) {
+    if (end - p < 4 || p[0] != '<' || p[1] != 'W'
+        || (p[2] != 'H' && p[2] != 'G' && p[2] != 'T'))
+        return 0;
+    return static_cast<const char *>(memchr(p + 3, '>', end - p - 3));
+}
 
-    if (m && !(m->has(CSwordModuleInfo::lemmas) || m->has(CSwordModuleInfo::morphTags) || m->has(CSwordModuleInfo::strongNumbers))) { //only parse if the module has strongs or lemmas
-        return 1; //WARNING: Return alread here
+/** \returns the first word tag in [p, end) or 0 if there is none. */
+const char * findWordTag(const char * p, const char * end, const char *& tagEnd) {
+    while ((p = static_cast<const char *>(memchr(p, '<', end - p)))) {
+        if ((tagEnd = wordTagEnd(p, end)))
+            return p;
+        ++p;
     }
+    return 0;
+}
 
-    //Am Anfang<WH07225> schuf<WH01254><WTH8804> Gott<WH0430> Himmel<WH08064> und<WT> Erde<WH0776>.
-    //A simple word<WT> means: No entry for this word "word"
-    QString result;
-
-    QString t = QString::fromUtf8(buf.c_str());
-
-    QRegExp tag("([.,;:]?<W[HGT][^>]*>\\s*)+");
-
-    QStringList list;
-
-    int lastMatchEnd = 0;
-
-    int pos = tag.indexIn(t, 0);
+/**
+  Checks whether there is a word to which the tags at the end of the piece
+  belong to. Comparing the first char with < is not enough, because the
+  tokenReplace is done already so there might be html tags already.
+*/
+bool textPresent(const char * p, const char * end) {
+    p = Filters::WordSpanBuilder::skipSpace(p, end);
+    while (p < end && isSeparator(*p))
+        ++p;
+    if (p == end || *p != '<')
+        return true;
+    ++p;
+    while (p < end && isSeparator(*p))
+        ++p;
+    return p == end || *p != 'W';
+}
 
-    if (pos == -1) { //no strong or morph code found in this text
-        return 1; //WARNING: Return already here
+/**
+  Appends the piece [pieceStart, pieceEnd) to \a out. The piece is a word
+  followed by its tags, the first of which is [tag, tagEnd]. The word is
+  wrapped in a span with the values of all tags.
+*/
+void appendWord(sword::SWBuf & out,
+                const char * pieceStart,
+                const char * tag,
+                const char * tagEnd,
+                const char * pieceEnd)
+{
+    if (!textPresent(pieceStart, pieceEnd)) {
+        out.append(pieceStart, pieceEnd - pieceStart);
+        return;
     }
 
-    //split the text into parts which end with the GBF tag marker for strongs/lemmas
-    while (pos != -1) {
-        list.append(t.mid(lastMatchEnd, pos + tag.matchedLength() - lastMatchEnd));
+    const char * const wordEnd = tag;
+    Filters::WordSpanBuilder span;
+    sword::SWBuf tail; // The text between and after the tags
+    for (;;) {
+        const bool isMorph = (tag[2] == 'T');
+        const char * const value = isMorph ? tag + 3 : tag + 2;
+        if (value == tagEnd) { // e.g. <WT>, leave the rest as it is
+            tail.append(tag, pieceEnd - tag);
+            break;
+        }
+        span.add(isMorph, value, tagEnd);
 
-        lastMatchEnd = pos + tag.matchedLength();
-        pos = tag.indexIn(t, pos + tag.matchedLength());
+        const char * const textStart = tagEnd + 1;
+        tag = findWordTag(textStart, pieceEnd, tagEnd);
+        if (!tag) {
+            tail.append(textStart, pieceEnd - textStart);
+            break;
+        }
+        tail.append(textStart, tag - textStart);
     }
 
-    //append the trailing text to the list.
-    if (!t.right(t.length() - lastMatchEnd).isEmpty()) {
-        list.append(t.right(t.length() - lastMatchEnd));
+    if (span.isEmpty()) {
+        out.append(pieceStart, pieceEnd - pieceStart);
+        return;
     }
 
-    //list is now a list of words with 1-n Strongs at the end, which belong to this word.
-
-    //now create the necessary HTML in list entries and concat them to the result
-    tag = QRegExp("<W([HGT])([^>]*)>");
-    tag.setMinimal(true);
-
-    for (QStringList::iterator it = list.begin(); it != list.end(); ++it) {
-        QString e = (*it); //current entry to process
-        //qWarning(e.latin1());
-
-        //check if there is a word to which the strongs info belongs to.
-        //If yes, wrap that word with the strongs info
-        //If not, leave out the strongs info, because it can't be tight to a text
-        //Comparing the first char with < is not enough, because the tokenReplace is done already
-        //so there might be html tags already.
-        const bool textPresent = (e.trimmed().remove(QRegExp("[.,;:]")).left(2) != "<W");
-
-        if (!textPresent) {
-            result += (*it);
-            continue;
-        }
-
-        int pos = tag.indexIn(e, 0); //try to find a strong number marker
-        bool insertedTag = false;
-        bool hasLemmaAttr = false;
-        bool hasMorphAttr = false;
-
-        QString value = QString::null;
-        int tagAttributeStart = -1;
-
-        while (pos != -1) { //work on all strong/lemma tags in this section, should be between 1-3 loops
-            const bool isMorph = (tag.cap(1) == "T");
-            value = isMorph ? tag.cap(2) : tag.cap(2).prepend( tag.cap(1) );
-
-            if (value.isEmpty()) {
-                break;
-            }
-
-            //insert the span
-            if (!insertedTag) { //we have to insert a new tag end and beginning, i.e. our first loop
-                e.replace(pos, tag.matchedLength(), "</span>");
-                pos += 7;
-
-                //skip blanks, commas, dots and stuff at the beginning, it doesn't belong to the morph code
-                QString rep("<span ");
-                rep.append(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\">");
-
-                hasMorphAttr = isMorph;
-                hasLemmaAttr = !isMorph;
-
-                int startPos = 0;
-                QChar c = e[startPos];
-
-                while ((startPos < pos) && (c.isSpace() || c.isPunct())) {
-                    ++startPos;
-
-                    c = e[startPos];
-                }
+    //skip blanks, commas, dots and stuff at the beginning, it doesn't belong to the morph code
+    const char * const wordStart =
+            Filters::WordSpanBuilder::skipSpaceAndPunct(pieceStart, wordEnd);
+    out.append(pieceStart, wordStart - pieceStart);
+    span.appendOpenTag(out);
+    out.append(wordStart, wordEnd - wordStart);
+    out.append("</span>");
+    out.append(tail);
+}
 
-                e.insert( startPos, rep );
-                tagAttributeStart = startPos + 6; //to point to the start of the attributes
-                pos += rep.length();
-            }
-            else { //add the attribute to the existing tag
-                e.remove(pos, tag.matchedLength());
+} // anonymous namespace
 
-                if (tagAttributeStart == -1) {
-                    continue; //nothing valid found
-                }
+char Filters::GbfToHtml::processText(sword::SWBuf& buf, const sword::SWKey * key, const sword::SWModule * module) {
+    GBFHTML::processText(buf, key, module);
 
-                if ((!isMorph && hasLemmaAttr) || (isMorph && hasMorphAttr)) { //we append another attribute value, e.g. 3000 gets 3000|5000
-                    //search the existing attribute start
-                    QRegExp attrRegExp( isMorph ? "morph=\".+(?=\")" : "lemma=\".+(?=\")" );
-                    attrRegExp.setMinimal(true);
-                    const int foundPos = e.indexOf(attrRegExp, tagAttributeStart);
+    if (!module->isProcessEntryAttributes()) {
+        return 1; //no processing should be done, may happen in a search
+    }
 
-                    if (foundPos != -1) {
-                        e.insert(foundPos + attrRegExp.matchedLength(), QString("|").append(value));
-                        pos += value.length() + 1;
+    CSwordModuleInfo* m = CSwordBackend::instance()->findModuleByName( module->getName() );
 
-                        hasLemmaAttr = !isMorph;
-                        hasMorphAttr = isMorph;
-                    }
-                }
-                else { //attribute was not yet inserted
-                    QString attr = QString(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\" ");
+    if (m && !(m->has(CSwordModuleInfo::lemmas) || m->has(CSwordModuleInfo::morphTags) || m->has(CSwordModuleInfo::strongNumbers))) { //only parse if the module has strongs or lemmas
+        return 1; //WARNING: Return alread here
+    }
 
-                    e.insert(tagAttributeStart, attr);
-                    pos += attr.length();
+    addWordSpans(buf);
+    return 1;
+}
 
-                    hasMorphAttr = isMorph;
-                    hasLemmaAttr = !isMorph;
-                }
+void Filters::GbfToHtml::addWordSpans(sword::SWBuf & buf) {
+    //Am Anfang<WH07225> schuf<WH01254><WTH8804> Gott<WH0430> Himmel<WH08064> und<WT> Erde<WH0776>.
+    //A simple word<WT> means: No entry for this word "word"
+    const char * const begin = buf.c_str();
+    const char * const end = begin + buf.length();
 
-                //tagAttributeStart remains the same
-            }
+    const char * tagEnd;
+    const char * tag = findWordTag(begin, end, tagEnd);
+    if (!tag) { //no strong or morph code found in this text
+        return;
+    }
 
-            insertedTag = true;
-            pos = tag.indexIn(e, pos);
+    //split the text into pieces which end with the GBF tags for strongs/lemmas
+    //and wrap the word of each piece
+    sword::SWBuf result;
+    const char * pieceStart = begin;
+    while (tag) {
+        //all directly following tags belong to the same word
+        const char * pieceEnd = WordSpanBuilder::skipSpace(tagEnd + 1, end);
+        for (;;) {
+            const char * next = pieceEnd;
+            if (next < end && isSeparator(*next))
+                ++next;
+            const char * const nextEnd = wordTagEnd(next, end);
+            if (!nextEnd)
+                break;
+            pieceEnd = WordSpanBuilder::skipSpace(nextEnd + 1, end);
         }
 
-        result += e;
-    }
+        appendWord(result, pieceStart, tag, tagEnd, pieceEnd);
 
-    if (list.count()) {
-        buf = (const char*)result.toUtf8().constData();
+        pieceStart = pieceEnd;
+        tag = findWordTag(pieceStart, end, tagEnd);
     }
 
-    return 1;
+    //append the trailing text
+    result.append(pieceStart, end - pieceStart);
+    buf = result;
 }
 
 bool Filters::GbfToHtml::handleToken(sword::SWBuf &buf, const char *token, sword::BasicFilterUserData *userData) {
@@ -14,6 +14,7 @@
 
 // Sword includes:
 #include <gbfhtml.h>
+#include <swbuf.h>
 
 
 namespace Filters {
@@ -49,6 +50,13 @@ class GbfToHtml: public sword::GBFHTML {
                                  const sword::SWKey *key,
                                  const sword::SWModule *module = 0);
 
+        /**
+          Wraps each word followed by GBF Strong's or morph tags in a <span>
+          with lemma and morph attributes. Used by processText() on the HTML
+          of GBFHTML.
+        */
+        static void addWordSpans(sword::SWBuf &buf);
+
     protected: /* Methods: */
         /** Reimplemented from sword::OSISHTMLHREF. */
         virtual inline sword::BasicFilterUserData *createUserData(
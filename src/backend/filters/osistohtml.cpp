@@ -9,6 +9,9 @@
 
 #include "backend/filters/osistohtml.h"
 
+#include <cctype>
+#include <cstring>
+#include <QMutexLocker>
 #include <QString>
 #include "backend/config/btconfig.h"
 #include "backend/drivers/cswordmoduleinfo.h"
@@ -19,7 +22,6 @@
 // Sword includes:
 #include <swbuf.h>
 #include <swmodule.h>
-#include <utilxml.h>
 
 
 Filters::OsisToHtml::OsisToHtml() : sword::OSISHTMLHREF() {
@@ -48,6 +50,274 @@ Filters::OsisToHtml::OsisToHtml() : sword::OSISHTMLHREF() {
 
 }
 
+namespace {
+
+/** A string inside a token, which is not null-terminated. */
+struct StringView {
+    inline StringView() : data(0), size(0) {}
+    inline StringView(const char * d, int s) : data(d), size(s) {}
+
+    inline bool isNull() const { return !data; }
+
+    inline bool operator==(const char * other) const {
+        return data && !strncmp(data, other, size) && !other[size];
+    }
+    inline bool operator!=(const char * other) const {
+        return !(*this == other);
+    }
+
+    inline bool startsWith(const char * prefix, int length) const {
+        return size >= length && !strncmp(data, prefix, length);
+    }
+
+    inline const char * find(char c) const {
+        return static_cast<const char *>(memchr(data, c, size));
+    }
+
+    inline int count(char c) const {
+        int n = 0;
+        for (int i = 0; i < size; i++)
+            if (data[i] == c)
+                n++;
+        return n;
+    }
+
+    /** Same as sword::XMLTag::getAttribute(name, part, split). */
+    StringView part(int partNum, char split) const {
+        const char * begin = data;
+        const char * const end = data + size;
+        for (; partNum > 0; partNum--) {
+            begin = static_cast<const char *>(memchr(begin, split, end - begin));
+            if (!begin)
+                return StringView();
+            begin++;
+        }
+        const char * partEnd =
+                static_cast<const char *>(memchr(begin, split, end - begin));
+        return StringView(begin, (partEnd ? partEnd : end) - begin);
+    }
+
+    const char * data;
+    int size;
+};
+
+inline void append(sword::SWBuf & buf, const StringView & s) {
+    if (s.size > 0)
+        buf.append(s.data, s.size);
+}
+
+inline void appendAttribute(sword::SWBuf & buf,
+                            const char * name,
+                            const StringView & value)
+{
+    // Same quoting as sword::XMLTag::toString():
+    const char quote = value.find('"') ? '\'' : '"';
+    buf.append(' ');
+    buf.append(name);
+    buf.append('=');
+    buf.append(quote);
+    append(buf, value);
+    buf.append(quote);
+}
+
+/**
+  \brief Read-only view of an OSIS token.
+
+  Parses the token the same way as sword::XMLTag does, but without copying the
+  name and the attributes of the tag.
+*/
+class TagView {
+
+    public: /* Methods: */
+
+        explicit TagView(const char * token)
+            : m_endTag(false), m_empty(false)
+        {
+            const char * p = token;
+            for (; *p && !isalpha(static_cast<unsigned char>(*p)); p++)
+                if (*p == '/')
+                    m_endTag = true;
+
+            const char * const nameStart = p;
+            for (; *p && !strchr("\t\r\n />", *p); p++);
+            m_name = StringView(nameStart, p - nameStart);
+            m_attributes = p;
+
+            if (!m_endTag) {
+                const char * end = p + strlen(p);
+                while (end > p && isspace(static_cast<unsigned char>(end[-1])))
+                    end--;
+                m_empty = (end > p && end[-1] == '/');
+            }
+        }
+
+        inline const StringView & name() const { return m_name; }
+        inline bool isEndTag() const { return m_endTag; }
+        inline bool isEmpty() const { return m_empty; }
+
+        /**
+          \returns the value of the given attribute or a null view if the tag
+                   has no such attribute.
+        */
+        StringView attribute(const char * name) const {
+            const size_t nameLength = strlen(name);
+            StringView result;
+            const char * p = m_attributes;
+            while (*p) {
+                if (!strchr("\t\r\n ", *p)) {
+                    p++;
+                    continue;
+                }
+                for (; *p && !isalpha(static_cast<unsigned char>(*p)); p++);
+                if (!*p)
+                    break;
+
+                const char * const attrName = p;
+                for (; *p && *p != ' ' && *p != '='; p++);
+                const bool match = (size_t(p - attrName) == nameLength
+                                    && !strncmp(attrName, name, nameLength));
+
+                for (; *p == ' '; p++);
+                if (*p)
+                    p++; // '='
+                for (; *p == ' '; p++);
+                const char quote = *p;
+                if (quote)
+                    p++;
+                if (!*p)
+                    break;
+
+                const char * const value = p;
+                for (; *p && *p != quote; p++);
+                if (match) // The last one wins, as in sword::XMLTag
+                    result = StringView(value, p - value);
+                if (*p)
+                    p++;
+            }
+            return result;
+        }
+
+    private: /* Fields: */
+
+        StringView m_name;
+        const char * m_attributes;
+        bool m_endTag;
+        bool m_empty;
+
+};
+
+enum TagName {
+    UnknownTag,
+    AbbrTag,
+    DivTag,
+    DivineNameTag,
+    HiTag,
+    MilestoneTag,
+    NameTag,
+    NoteTag,
+    PTag,
+    QTag,
+    ReferenceTag,
+    SegTag,
+    TitleTag,
+    TransChangeTag,
+    WTag
+};
+
+struct TagNameEntry {
+    const char * name;
+    TagName tag;
+};
+
+/// The tags handled by OsisToHtml, sorted for the binary search in tagName().
+const TagNameEntry tagNames[] = {
+    { "abbr",        AbbrTag },
+    { "div",         DivTag },
+    { "divineName",  DivineNameTag },
+    { "hi",          HiTag },
+    { "milestone",   MilestoneTag },
+    { "name",        NameTag },
+    { "note",        NoteTag },
+    { "p",           PTag },
+    { "q",           QTag },
+    { "reference",   ReferenceTag },
+    { "seg",         SegTag },
+    { "title",       TitleTag },
+    { "transChange", TransChangeTag },
+    { "w",           WTag }
+};
+
+inline int compare(const StringView & name, const char * other) {
+    const int r = strncmp(name.data, other, name.size);
+    if (r != 0)
+        return r;
+    return other[name.size] ? -1 : 0;
+}
+
+TagName tagName(const StringView & name) {
+    int low = 0;
+    int high = sizeof(tagNames) / sizeof(tagNames[0]) - 1;
+    while (low <= high) {
+        const int middle = (low + high) / 2;
+        const int r = compare(name, tagNames[middle].name);
+        if (r == 0)
+            return tagNames[middle].tag;
+        if (r < 0) {
+            high = middle - 1;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return UnknownTag;
+}
+
+/**
+  Splits an attribute value like sword::XMLTag::getAttributePartCount() with
+  '|' or, if that gives less parts, ' '.
+*/
+inline int splitAttribute(const StringView & value, char & splitChar) {
+    const int countSplit1 = value.count('|') + 1;
+    const int countSplit2 = value.count(' ') + 1; /// \todo not allowed, remove soon
+    if (countSplit1 > countSplit2) {
+        splitChar = '|';
+        return countSplit1;
+    }
+    splitChar = ' ';
+    return countSplit2;
+}
+
+/** \returns the value after the "prefix:" of \a value. */
+inline StringView stripPrefix(const StringView & value) {
+    const char * const colon = value.find(':');
+    if (!colon)
+        return value;
+    return StringView(colon + 1, value.data + value.size - colon - 1);
+}
+
+/** Letters of the osisRef, any non-ASCII UTF-8 byte is taken for a letter. */
+inline bool isLetter(char c) {
+    return isalpha(static_cast<unsigned char>(c))
+           || static_cast<unsigned char>(c) >= 0x80;
+}
+
+/** Looks up the body of a footnote without inserting empty entries. */
+const char * footnoteBody(const sword::AttributeTypeList & attributes,
+                          const sword::SWBuf & number)
+{
+    const sword::AttributeTypeList::const_iterator t(attributes.find("Footnote"));
+    if (t == attributes.end())
+        return "";
+    const sword::AttributeList::const_iterator n(t->second.find(number));
+    if (n == t->second.end())
+        return "";
+    const sword::AttributeValue::const_iterator b(n->second.find("body"));
+    if (b == n->second.end())
+        return "";
+    return b->second.c_str();
+}
+
+} // anonymous namespace
+
 bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, sword::BasicFilterUserData *userData) {
     // manually process if it wasn't a simple substitution
 
@@ -55,20 +325,21 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
         UserData* myUserData = dynamic_cast<UserData*>(userData);
         sword::SWModule* myModule = const_cast<sword::SWModule*>(myUserData->module); //hack
 
-        sword::XMLTag tag(token);
+        const TagView tag(token);
         //     qWarning("found %s", token);
-        const bool osisQToTick = ((!userData->module->getConfigEntry("OSISqToTick")) || (strcmp(userData->module->getConfigEntry("OSISqToTick"), "false")));
 
-        if (!tag.getName()) {
+        if (!tag.name().size) {
             return false;
         }
 
+        switch (tagName(tag.name())) {
+
         // <div> tag
-        if (!strcmp(tag.getName(), "div")) {
+        case DivTag:
             if (tag.isEndTag()) {
                 buf.append("</div>");
             } else {
-                sword::SWBuf type( tag.getAttribute("type") );
+                const StringView type(tag.attribute("type"));
                 if (type == "introduction") {
                     if (!tag.isEmpty())
                         buf.append("<div class=\"introduction\">");
@@ -81,144 +352,94 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                     buf.append("<div>");
                 }
             }
-        }
-        else if (!strcmp(tag.getName(), "w")) {
-            if ((!tag.isEmpty()) && (!tag.isEndTag())) { //start tag
-                const char *attrib;
-                const char *val;
+            break;
 
-                sword::XMLTag outTag("span");
-                sword::SWBuf attrValue;
-
-                if ((attrib = tag.getAttribute("xlit"))) {
-                    val = strchr(attrib, ':');
-                    val = (val) ? (val + 1) : attrib;
-                    outTag.setAttribute("xlit", val);
-                }
+        case WTag:
+            if ((!tag.isEmpty()) && (!tag.isEndTag())) { //start tag
+                // The attributes are written in the same order as
+                // sword::XMLTag::toString() would write them.
+                buf.append("<span");
 
-                if ((attrib = tag.getAttribute("gloss"))) {
-                    val = strchr(attrib, ':');
-                    val = (val) ? (val + 1) : attrib;
-                    outTag.setAttribute("gloss", val);
+                StringView attrib;
+                if (!(attrib = tag.attribute("gloss")).isNull()) {
+                    appendAttribute(buf, "gloss", stripPrefix(attrib));
                 }
 
-                if ((attrib = tag.getAttribute("lemma"))) {
-                    char splitChar = '|';
-                    const int countSplit1 = tag.getAttributePartCount("lemma", '|');
-                    const int countSplit2 = tag.getAttributePartCount("lemma", ' '); /// \todo not allowed, remove soon
-                    int count = 0;
-
-                    if (countSplit1 > countSplit2) { //| split char
-                        splitChar = '|'; /// \todo not allowed, remove soon
-                        count = countSplit1;
-                    }
-                    else {
-                        splitChar = ' ';
-                        count = countSplit2;
-                    }
-
-                    int i = (count > 1) ? 0 : -1;  // -1 for whole value cuz it's faster, but does the same thing as 0
-                    attrValue = "";
+                sword::SWBuf attrValue;
+                if (!(attrib = tag.attribute("lemma")).isNull()) {
+                    char splitChar;
+                    const int count = splitAttribute(attrib, splitChar);
 
-                    do {
+                    for (int i = 0; i < count; i++) {
                         if (attrValue.length()) {
                             attrValue.append( '|' );
                         }
-
-                        attrib = tag.getAttribute("lemma", i, splitChar);
-
-                        if (i < 0) { // to handle our -1 condition
-                            i = 0;
-                        }
-
-                        val = strchr(attrib, ':');
-                        val = (val) ? (val + 1) : attrib;
-
-                        attrValue.append(val);
+                        // the whole value if there is only one part
+                        append(attrValue, stripPrefix((count > 1) ? attrib.part(i, splitChar) : attrib));
                     }
-                    while (++i < count);
 
                     if (attrValue.length()) {
-                        outTag.setAttribute("lemma", attrValue.c_str());
+                        appendAttribute(buf, "lemma", StringView(attrValue.c_str(), attrValue.length()));
                     }
                 }
 
-                if ((attrib = tag.getAttribute("morph"))) {
-                    char splitChar = '|';
-                    const int countSplit1 = tag.getAttributePartCount("morph", '|');
-                    const int countSplit2 = tag.getAttributePartCount("morph", ' '); /// \todo not allowed, remove soon
-                    int count = 0;
-
-                    if (countSplit1 > countSplit2) { //| split char
-                        splitChar = '|';
-                        count = countSplit1;
-                    }
-                    else {
-                        splitChar = ' ';
-                        count = countSplit2;
-                    }
-
-                    int i = (count > 1) ? 0 : -1;  // -1 for whole value cuz it's faster, but does the same thing as 0
+                if (!(attrib = tag.attribute("morph")).isNull()) {
+                    char splitChar;
+                    const int count = splitAttribute(attrib, splitChar);
 
                     attrValue = "";
 
-                    do {
+                    for (int i = 0; i < count; i++) {
                         if (attrValue.length()) {
                             attrValue.append('|');
                         }
 
-                        attrib = tag.getAttribute("morph", i, splitChar);
+                        const StringView val((count > 1) ? attrib.part(i, splitChar) : attrib);
 
-                        if (i < 0) {
-                            i = 0; // to handle our -1 condition
-                        }
-
-                        val = strchr(attrib, ':');
-
-                        if (val) { //the prefix gives the modulename
+                        if (val.find(':')) { //the prefix gives the modulename
                             //check the prefix
-                            if (!strncmp("robinson:", attrib, 9)) { //robinson
+                            if (val.startsWith("robinson:", 9)) { //robinson
                                 attrValue.append( "Robinson:" ); //work is not the same as Sword's module name
-                                attrValue.append( val + 1 );
+                                append(attrValue, stripPrefix(val));
                             }
                             //strongs is handled by BibleTime
-                            /*else if (!strncmp("strongs", attrib, val-atrrib)) {
-                                attrValue.append( !strncmp(attrib, "x-", 2) ? attrib+2 : attrib );
-                            }*/
+                            else if (val.startsWith("x-", 2)) {
+                                append(attrValue, StringView(val.data + 2, val.size - 2));
+                            }
                             else {
-                                attrValue.append( !strncmp(attrib, "x-", 2) ? attrib + 2 : attrib );
+                                append(attrValue, val);
                             }
                         }
                         else { //no prefix given
-                            val = attrib;
-                            const bool skipFirst = ((val[0] == 'T') && ((val[1] == 'H') || (val[1] == 'G')));
-                            attrValue.append( skipFirst ? val + 1 : val );
+                            const bool skipFirst = (val.size >= 2 && (val.data[0] == 'T') && ((val.data[1] == 'H') || (val.data[1] == 'G')));
+                            append(attrValue, skipFirst ? StringView(val.data + 1, val.size - 1) : val);
                         }
                     }
-                    while (++i < count);
 
                     if (attrValue.length()) {
-                        outTag.setAttribute("morph", attrValue.c_str());
+                        appendAttribute(buf, "morph", StringView(attrValue.c_str(), attrValue.length()));
                     }
                 }
 
-                if ((attrib = tag.getAttribute("POS"))) {
-                    val = strchr(attrib, ':');
-                    val = (val) ? (val + 1) : attrib;
-                    outTag.setAttribute("pos", val);
+                if (!(attrib = tag.attribute("POS")).isNull()) {
+                    appendAttribute(buf, "pos", stripPrefix(attrib));
                 }
 
-                buf.append( outTag.toString() );
+                if (!(attrib = tag.attribute("xlit")).isNull()) {
+                    appendAttribute(buf, "xlit", stripPrefix(attrib));
+                }
+
+                buf.append('>');
             }
             else if (tag.isEndTag()) { // end or empty <w> tag
                 buf.append("</span>");
             }
-        }
+            break;
 
         // <note> tag
-        else if (!strcmp(tag.getName(), "note")) {
+        case NoteTag:
             if (!tag.isEndTag()) { //start tag
-                const sword::SWBuf type( tag.getAttribute("type") );
+                const StringView type(tag.attribute("type"));
 
                 if (type == "crossReference") { //note containing cross references
                     myUserData->inCrossrefNote = true;
@@ -234,9 +455,10 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                      */
 
                     buf.append("<span class=\"crossreference\">");
-                    sword::SWBuf footnoteNumber = tag.getAttribute("swordFootnote");
-                    sword::SWBuf footnoteBody = myUserData->entryAttributes["Footnote"][footnoteNumber]["body"];
-                    buf += myModule->renderText(footnoteBody);
+                    sword::SWBuf footnoteNumber;
+                    append(footnoteNumber, tag.attribute("swordFootnote"));
+                    const sword::SWBuf body(footnoteBody(myUserData->entryAttributes, footnoteNumber));
+                    buf += myModule->renderText(body);
                 }
 
                 /* else if (type == "explanation") {
@@ -259,12 +481,16 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                     buf.append('/');
                     buf.append(myUserData->key->getShortText());
                     buf.append('/');
-                    buf.append( QString::number(myUserData->swordFootnote++).toUtf8().constData() ); //inefficient
+                    buf.appendFormatted("%u", static_cast<unsigned int>(myUserData->swordFootnote++));
 
-                    const sword::SWBuf n = tag.getAttribute("n");
+                    const StringView n(tag.attribute("n"));
 
                     buf.append("\">");
-                    buf.append( (n.length() > 0) ? n.c_str() : "*" );
+                    if (n.size > 0) {
+                        append(buf, n);
+                    } else {
+                        buf.append('*');
+                    }
                     buf.append("</span> ");
 
                     myUserData->noteType = UserData::Footnote;
@@ -283,13 +509,13 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                 myUserData->noteType = UserData::Unknown;
                 myUserData->suspendTextPassThru = false;
             }
-        }
+            break;
+
         // The <p> paragraph tag is handled by OSISHTMLHref
-        else if (!strcmp(tag.getName(), "reference")) { // <reference> tag
+        case ReferenceTag: // <reference> tag
             if (!tag.isEndTag() && !tag.isEmpty()) {
-
-                renderReference(tag.getAttribute("osisRef"), buf, myModule, myUserData);
-
+                const StringView osisRef(tag.attribute("osisRef"));
+                renderReference(osisRef.data, osisRef.size, buf, myModule, myUserData);
             }
             else if (tag.isEndTag()) {
                 buf.append("</a>");
@@ -297,11 +523,11 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
             else { // empty reference marker
                 // -- what should we do?  nothing for now.
             }
-        }
+            break;
 
         // <l> is handled by OSISHTMLHref
         // <title>
-        else if (!strcmp(tag.getName(), "title")) {
+        case TitleTag:
             if (!tag.isEndTag() && !tag.isEmpty()) {
                 buf.append("<div class=\"sectiontitle\">");
             }
@@ -312,13 +538,13 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                 // what to do?  is this even valid?
                 buf.append("<br/>");
             }
-        }
+            break;
 
         // <hi> highlighted text
-        else if (!strcmp(tag.getName(), "hi")) {
-            const sword::SWBuf type = tag.getAttribute("type");
-
+        case HiTag:
             if ((!tag.isEndTag()) && (!tag.isEmpty())) {
+                const StringView type(tag.attribute("type"));
+
                 if (type == "bold") {
                     buf.append("<span class=\"bold\">");
                 }
@@ -347,13 +573,13 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
             else if (tag.isEndTag()) { //all hi replacements are html spans
                 buf.append("</span>");
             }
-        }
+            break;
 
         //name
-        else if (!strcmp(tag.getName(), "name")) {
-            const sword::SWBuf type = tag.getAttribute("type");
-
+        case NameTag:
             if ((!tag.isEndTag()) && (!tag.isEmpty())) {
+                const StringView type(tag.attribute("type"));
+
                 if (type == "geographic") {
                     buf.append("<span class=\"name\"><span class=\"geographic\">");
                 }
@@ -376,15 +602,16 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
             else if (tag.isEndTag()) { //all hi replacements are html spans
                 buf.append("</span></span> ");
             }
-        }
-        else if (!strcmp(tag.getName(), "transChange")) {
-            sword::SWBuf type( tag.getAttribute("type") );
-
-            if ( !type.length() ) {
-                type = tag.getAttribute("changeType");
-            }
+            break;
 
+        case TransChangeTag:
             if ((!tag.isEndTag()) && (!tag.isEmpty())) {
+                StringView type( tag.attribute("type") );
+
+                if ( !type.size ) {
+                    type = tag.attribute("changeType");
+                }
+
                 if (type == "added") {
                     buf.append("<span class=\"transchange\" title=\"");
                     buf.append(QObject::tr("Added text").toUtf8().constData());
@@ -414,28 +641,32 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
             else if (tag.isEndTag()) { //all hi replacements are html spans
                 buf.append("</span></span>");
             }
-        }
-        else if (!strcmp(tag.getName(), "p")) {
+            break;
+
+        case PTag:
             if (tag.isEmpty()) {
                 buf.append("<p/>");
             }
-        }
+            break;
 
         // <q> quote
-        else if (!strcmp(tag.getName(), "q")) {
-            //sword::SWBuf type = tag.getAttribute("type");
-            sword::SWBuf who = tag.getAttribute("who");
-            const char *lev = tag.getAttribute("level");
-            int level = (lev) ? atoi(lev) : 1;
-            sword::SWBuf quoteMarker = tag.getAttribute("marker");
+        case QTag: {
+            //StringView type = tag.attribute("type");
+            const StringView who(tag.attribute("who"));
+            const StringView lev(tag.attribute("level"));
+            const int level = (!lev.isNull()) ? atoi(lev.data) : 1; // stops at the closing quote
+            const StringView quoteMarker(tag.attribute("marker"));
+            const char * const qToTick = userData->module->getConfigEntry("OSISqToTick");
+            const bool osisQToTick = (!qToTick || strcmp(qToTick, "false"));
 
             if ((!tag.isEndTag())) {
                 if (!tag.isEmpty()) {
-                    myUserData->quote.who = who;
+                    myUserData->quote.who = "";
+                    append(myUserData->quote.who, who);
                 }
 
-                if (quoteMarker.size() > 0) {
-                    buf.append(quoteMarker);
+                if (quoteMarker.size > 0) {
+                    append(buf, quoteMarker);
                 }
                 else if (osisQToTick) //alternate " and '
                     buf.append((level % 2) ? '\"' : '\'');
@@ -448,8 +679,8 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                 if (myUserData->quote.who == "Jesus") {
                     buf.append("</span>");
                 }
-                if (quoteMarker.size() > 0) {
-                    buf.append(quoteMarker);
+                if (quoteMarker.size > 0) {
+                    append(buf, quoteMarker);
                 }
                 else if (osisQToTick) { //alternate " and '
                     buf.append((level % 2) ? '\"' : '\'');
@@ -457,25 +688,24 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
 
                 myUserData->quote.who = "";
             }
+            break;
         }
 
         // abbr tag
-        else if (!strcmp(tag.getName(), "abbr")) {
+        case AbbrTag:
             if (!tag.isEndTag() && !tag.isEmpty()) {
-                const sword::SWBuf expansion = tag.getAttribute("expansion");
-
                 buf.append("<span class=\"abbreviation\" expansion=\"");
-                buf.append(expansion);
+                append(buf, tag.attribute("expansion"));
                 buf.append("\">");
             }
             else if (tag.isEndTag()) {
                 buf.append("</span>");
             }
-        }
+            break;
 
         // <milestone> tag
-        else if (!strcmp(tag.getName(), "milestone")) {
-            const sword::SWBuf type = tag.getAttribute("type");
+        case MilestoneTag: {
+            const StringView type(tag.attribute("type"));
 
             if ((type == "screen") || (type == "line")) {//line break
                 buf.append("<br/>");
@@ -483,31 +713,24 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
             }
             else if (type == "x-p") { //e.g. occurs in the KJV2006 module
                 //buf.append("<br/>");
-                const sword::SWBuf marker = tag.getAttribute("marker");
-                if (marker.length() > 0) {
-                    buf.append(marker);
-                }
+                append(buf, tag.attribute("marker"));
             }
+            break;
         }
+
         //seg tag
-        else if (!strcmp(tag.getName(), "seg")) {
+        case SegTag:
             if (!tag.isEndTag() && !tag.isEmpty()) {
-
-                const sword::SWBuf type = tag.getAttribute("type");
-
-                if (type == "morph") {//line break
+                if (tag.attribute("type") == "morph") {//line break
                     //This code is for WLC and MORPH (WHI)
-                    sword::XMLTag outTag("span");
-                    outTag.setAttribute("class", "morphSegmentation");
-                    const char* attrValue;
-                    //Transfer the values to the span
+                    //Transfer the values to the span, in the order of sword::XMLTag::toString()
                     //Problem: the data is in hebrew/aramaic, how to encode in HTML/BibleTime?
-                    if ((attrValue = tag.getAttribute("lemma"))) outTag.setAttribute("lemma", attrValue);
-                    if ((attrValue = tag.getAttribute("morph"))) outTag.setAttribute("morph", attrValue);
-                    if ((attrValue = tag.getAttribute("homonym"))) outTag.setAttribute("homonym", attrValue);
-
-                    buf.append(outTag.toString());
-                    //buf.append("<span class=\"morphSegmentation\">");
+                    buf.append("<span class=\"morphSegmentation\"");
+                    StringView attrValue;
+                    if (!(attrValue = tag.attribute("homonym")).isNull()) appendAttribute(buf, "homonym", attrValue);
+                    if (!(attrValue = tag.attribute("lemma")).isNull()) appendAttribute(buf, "lemma", attrValue);
+                    if (!(attrValue = tag.attribute("morph")).isNull()) appendAttribute(buf, "morph", attrValue);
+                    buf.append('>');
                 }
                 else {
                     buf.append("<span>");
@@ -517,19 +740,19 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
                 buf.append("</span>");
             }
             //qWarning(QString("handled <seg> token. result: %1").arg(buf.c_str()).latin1());
-        }
+            break;
 
         //divine name, don't use simple tag replacing because it may have attributes
-        else if (!strcmp(tag.getName(), "divineName")) {
+        case DivineNameTag:
             if (!tag.isEndTag()) {
                 buf.append("<span class=\"name\"><span class=\"divine\">");
             }
             else { //all hi replacements are html spans
                 buf.append("</span></span>");
             }
-        }
+            break;
 
-        else { //all tokens handled by OSISHTMLHref will run through the filter now
+        default: //all tokens handled by OSISHTMLHref will run through the filter now
             return sword::OSISHTMLHREF::handleToken(buf, token, userData);
         }
     }
@@ -537,12 +760,10 @@ bool Filters::OsisToHtml::handleToken(sword::SWBuf &buf, const char *token, swor
     return false;
 }
 
-void Filters::OsisToHtml::renderReference(const char *osisRef, sword::SWBuf &buf, sword::SWModule *myModule, UserData *myUserData) {
-    QString ref( osisRef );
-    QString hrefRef( ref );
-    //Q_ASSERT(!ref.isEmpty()); checked later
+void Filters::OsisToHtml::renderReference(const char *osisRef, int osisRefLength, sword::SWBuf &buf, sword::SWModule *myModule, UserData *myUserData) {
+    //Q_ASSERT(osisRefLength > 0); checked later
 
-    if (!ref.isEmpty()) {
+    if (osisRef && osisRefLength > 0) {
         //find out the mod, using the current module makes sense if it's a bible or commentary because the refs link into a bible by default.
         //If the osisRef is something like "ModuleID:key comes here" then the
         // modulename is given, so we'll use that one
@@ -558,37 +779,70 @@ void Filters::OsisToHtml::renderReference(const char *osisRef, sword::SWBuf &buf
         // Q_ASSERT(mod); There's no necessarily a module or standard Bible
 
         //if the osisRef like "GerLut:key" contains a module, use that
-        int pos = ref.indexOf(":");
-
-        if ((pos >= 0) && ref.at(pos - 1).isLetter() && ref.at(pos + 1).isLetter()) {
-            QString newModuleName = ref.left(pos);
-            hrefRef = ref.mid(pos + 1);
-
-            if (CSwordBackend::instance()->findModuleByName(newModuleName)) {
-                mod = CSwordBackend::instance()->findModuleByName(newModuleName);
+        const char * const refEnd = osisRef + osisRefLength;
+        const char * hrefRef = osisRef;
+        const char * const colon = static_cast<const char *>(memchr(osisRef, ':', osisRefLength));
+
+        if (colon && colon > osisRef && colon + 1 < refEnd
+            && isLetter(colon[-1]) && isLetter(colon[1]))
+        {
+            hrefRef = colon + 1;
+
+            CSwordModuleInfo * const newModule =
+                    CSwordBackend::instance()->findModuleByName(QString::fromUtf8(osisRef, colon - osisRef));
+            if (newModule) {
+                mod = newModule;
             }
         }
 
         if (mod) {
+            const char * const sourceLanguage = myModule->getLanguage();
+
+            /* OSIS references like "Gen.1.1" don't depend on the current key,
+               so the generated link can be reused. */
+            const bool cacheable = isalpha(static_cast<unsigned char>(hrefRef[0]))
+                    || (isdigit(static_cast<unsigned char>(hrefRef[0]))
+                        && hrefRef + 1 < refEnd
+                        && isalpha(static_cast<unsigned char>(hrefRef[1])));
+            QByteArray cacheKey;
+            if (cacheable && memchr(hrefRef, '.', refEnd - hrefRef)) {
+                cacheKey = mod->name().toUtf8();
+                cacheKey.append('\n').append(sourceLanguage).append('\n').append(osisRef, osisRefLength);
+
+                QMutexLocker locker(&m_referenceCacheMutex);
+                const QHash<QByteArray, QByteArray>::const_iterator it = m_referenceCache.constFind(cacheKey);
+                if (it != m_referenceCache.constEnd()) {
+                    buf.append(it.value().constData(), it.value().size());
+                    return;
+                }
+            }
+
             ReferenceManager::ParseOptions options;
             options.refBase = QString::fromUtf8(myUserData->key->getText());
             options.refDestinationModule = QString(mod->name());
-            options.sourceLanguage = QString(myModule->getLanguage());
+            options.sourceLanguage = QString(sourceLanguage);
             options.destinationLanguage = QString("en");
 
-            buf.append("<a href=\"");
-            buf.append( //create the hyperlink with key and mod
+            QByteArray link("<a href=\"");
+            link.append( //create the hyperlink with key and mod
                 ReferenceManager::encodeHyperlink(
                     mod->name(),
-                    ReferenceManager::parseVerseReference(hrefRef, options),
+                    ReferenceManager::parseVerseReference(QString::fromUtf8(hrefRef, refEnd - hrefRef), options),
                     ReferenceManager::typeFromModule(mod->type())
-                ).toUtf8().constData()
+                ).toUtf8()
             );
-            buf.append("\" crossrefs=\"");
-            buf.append((const char*)ReferenceManager::parseVerseReference(ref, options).toUtf8().constData()); //ref must contain the osisRef module marker if there was any
-            buf.append("\">");
+            link.append("\" crossrefs=\"");
+            link.append(ReferenceManager::parseVerseReference(QString::fromUtf8(osisRef, osisRefLength), options).toUtf8()); //ref must contain the osisRef module marker if there was any
+            link.append("\">");
+            buf.append(link.constData(), link.size());
+
+            if (!cacheKey.isEmpty()) {
+                QMutexLocker locker(&m_referenceCacheMutex);
+                if (m_referenceCache.size() >= 4096)
+                    m_referenceCache.clear();
+                m_referenceCache.insert(cacheKey, link);
+            }
         }
         // should we add something if there were no referenced module available?
     }
 }
-
@@ -12,6 +12,10 @@
 #ifndef FILTERS_OSISTOHTML_H
 #define FILTERS_OSISTOHTML_H
 
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
 // Sword includes:
 #include <osishtmlhref.h>
 #include <swbuf.h>
@@ -35,7 +39,7 @@ class OsisToHtml: public sword::OSISHTMLHREF {
 
                 unsigned short int swordFootnote;
                 bool inCrossrefNote;
-                sword::AttributeTypeList entryAttributes;
+                const sword::AttributeTypeList & entryAttributes;
 
                 enum NoteType {
                     Unknown,
@@ -68,8 +72,17 @@ class OsisToHtml: public sword::OSISHTMLHREF {
         }
 
     private: /* Methods: */
-        void renderReference(const char *osisRef, sword::SWBuf &buf,
-                             sword::SWModule *myModule, UserData *myUserData);
+        void renderReference(const char *osisRef, int osisRefLength,
+                             sword::SWBuf &buf, sword::SWModule *myModule,
+                             UserData *myUserData);
+
+    private: /* Fields: */
+        /**
+          The opening <a> tags of already rendered references, keyed by the
+          destination module, the source language and the osisRef.
+        */
+        QHash<QByteArray, QByteArray> m_referenceCache;
+        QMutex m_referenceCacheMutex;
 };
 
 } // namespace Filters
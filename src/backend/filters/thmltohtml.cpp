@@ -9,12 +9,14 @@
 
 #include "backend/filters/thmltohtml.h"
 
+#include <cstring>
 #include <QString>
-#include <QRegExp>
+#include <QStringList>
 #include <QUrl>
 #include <QTextCodec>
 #include "backend/config/btconfig.h"
 #include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/filters/wordspanbuilder.h"
 #include "backend/managers/clanguagemgr.h"
 #include "backend/managers/referencemanager.h"
 #include "backend/managers/cswordbackend.h"
@@ -42,160 +44,202 @@ ThmlToHtml::ThmlToHtml() {
     removeTokenSubstitute("/note");
 }
 
-char ThmlToHtml::processText(sword::SWBuf &buf, const sword::SWKey *key,
-                             const sword::SWModule *module)
-{
-    sword::ThMLHTML::processText(buf, key, module);
+namespace {
 
-    CSwordModuleInfo* m = CSwordBackend::instance()->findModuleByName( module->getName() );
-
-    if (m && !(m->has(CSwordModuleInfo::lemmas) || m->has(CSwordModuleInfo::strongNumbers))) { //only parse if the module has strongs or lemmas
-        return 1;
-    }
-
-    QString result;
-
-    QString t = QString::fromUtf8(buf.c_str());
-    QRegExp tag("([.,;]?<sync[^>]+(type|value)=\"([^\"]+)\"[^>]+(type|value)=\"([^\"]+)\"([^<]*)>)+");
+inline bool isSeparator(char c) {
+    return c == '.' || c == ',' || c == ';';
+}
 
-    QStringList list;
-    int lastMatchEnd = 0;
-    int pos = tag.indexIn(t, 0);
+/**
+  \returns the closing '>' of the <sync type="..." value="..."> tag which
+           starts at \a p or 0 if there is no such tag at \a p.
+*/
+const char * syncTagEnd(const char * p, const char * end) {
+    if (end - p < 6 || strncmp(p, "<sync", 5) != 0 || p[5] == '>')
+        return 0;
+
+    const char * const tagEnd =
+            static_cast<const char *>(memchr(p + 5, '>', end - p - 5));
+    if (!tagEnd)
+        return 0;
+
+    const char * value;
+    const char * valueEnd;
+    if (!WordSpanBuilder::findAttribute(p, tagEnd, "type", value, valueEnd)
+        || value == valueEnd
+        || !WordSpanBuilder::findAttribute(p, tagEnd, "value", value, valueEnd)
+        || value == valueEnd)
+        return 0;
+
+    return tagEnd;
+}
 
-    if (pos == -1) { //no strong or morph code found in this text
-        return 1; //WARNING: Return already here
+/** \returns the first sync tag in [p, end) or 0 if there is none. */
+const char * findSyncTag(const char * p, const char * end, const char *& tagEnd) {
+    while ((p = static_cast<const char *>(memchr(p, '<', end - p)))) {
+        if ((tagEnd = syncTagEnd(p, end)))
+            return p;
+        ++p;
     }
+    return 0;
+}
 
-    while (pos != -1) {
-        list.append(t.mid(lastMatchEnd, pos + tag.matchedLength() - lastMatchEnd));
-
-        lastMatchEnd = pos + tag.matchedLength();
-        pos = tag.indexIn(t, pos + tag.matchedLength());
+/**
+  Checks whether there is a word to which the sync tags belong to, i.e. some
+  text other than whitespace and punctuation in [p, end) outside of markup.
+*/
+bool textPresent(const char * p, const char * end) {
+    while ((p = WordSpanBuilder::skipSpaceAndPunct(p, end)) < end) {
+        if (*p != '<')
+            return true;
+        p = static_cast<const char *>(memchr(p, '>', end - p));
+        if (!p)
+            return false;
+        ++p;
     }
+    return false;
+}
 
-    if (!t.right(t.length() - lastMatchEnd).isEmpty()) {
-        list.append(t.right(t.length() - lastMatchEnd));
+/**
+  \returns the start of the word in [p, end). Closing and empty tags in front
+           of it belong to the preceding text and are skipped, too.
+*/
+const char * findWordStart(const char * p, const char * end) {
+    for (;;) {
+        p = WordSpanBuilder::skipSpaceAndPunct(p, end);
+        if (end - p < 2 || *p != '<')
+            return p;
+
+        const char * const tagEnd =
+                static_cast<const char *>(memchr(p, '>', end - p));
+        if (!tagEnd || (p[1] != '/' && tagEnd[-1] != '/'))
+            return p;
+        p = tagEnd + 1;
     }
+}
 
-    tag = QRegExp("<sync[^>]+(type|value|class)=\"([^\"]+)\"[^>]+(type|value|class)=\"([^\"]+)\"[^>]+((type|value|class)=\"([^\"]+)\")*([^<]*)>");
-
-    for (QStringList::iterator it = list.begin(); it != list.end(); ++it) {
-        QString e( *it );
-
-        const bool textPresent = (e.trimmed().remove(QRegExp("[.,;:]")).left(1) != "<");
+/** Adds the value of the sync tag [tag, tagEnd] to \a span. */
+void addSyncValue(WordSpanBuilder & span,
+                  const char * tag,
+                  const char * tagEnd)
+{
+    const char * type;
+    const char * typeEnd;
+    const char * value;
+    const char * valueEnd;
+    WordSpanBuilder::findAttribute(tag, tagEnd, "type", type, typeEnd);
+    WordSpanBuilder::findAttribute(tag, tagEnd, "value", value, valueEnd);
+    const bool isMorph = (typeEnd - type == 5 && !strncmp(type, "morph", 5));
+
+    // prepend the class qualifier to the value
+    const char * valueClass;
+    const char * valueClassEnd;
+    if (WordSpanBuilder::findAttribute(tag, tagEnd, "class",
+                                       valueClass, valueClassEnd)
+        && valueClass != valueClassEnd)
+    {
+        sword::SWBuf qualified;
+        qualified.append(valueClass, valueClassEnd - valueClass);
+        qualified.append(':');
+        qualified.append(value, valueEnd - value);
+        span.add(isMorph, qualified.c_str(),
+                 qualified.c_str() + qualified.length());
+    } else {
+        span.add(isMorph, value, valueEnd);
+    }
+}
 
-        if (!textPresent) {
-            continue;
+/**
+  Appends the piece [pieceStart, pieceEnd) to \a out. The piece is a word
+  followed by its sync tags, the first of which is [tag, tagEnd]. The word may
+  contain markup, e.g. <i>word</i>, which is wrapped in the span as a whole.
+  Without a word only the sync tags are left out.
+*/
+void appendWord(sword::SWBuf & out,
+                const char * pieceStart,
+                const char * tag,
+                const char * tagEnd,
+                const char * pieceEnd)
+{
+    const char * const wordEnd = tag;
+    WordSpanBuilder span;
+    sword::SWBuf tail; // The separators between the tags
+    for (;;) {
+        addSyncValue(span, tag, tagEnd);
+
+        const char * const textStart = tagEnd + 1;
+        tag = findSyncTag(textStart, pieceEnd, tagEnd);
+        if (!tag) {
+            tail.append(textStart, pieceEnd - textStart);
+            break;
         }
+        tail.append(textStart, tag - textStart);
+    }
 
+    if (!textPresent(pieceStart, wordEnd)) {
+        out.append(pieceStart, wordEnd - pieceStart);
+        out.append(tail);
+        return;
+    }
 
-        bool hasLemmaAttr = false;
-        bool hasMorphAttr = false;
-
-        int pos = tag.indexIn(e, 0);
-        bool insertedTag = false;
-        QString value;
-        QString valueClass;
-
-        while (pos != -1) {
-            bool isMorph = false;
-            bool isStrongs = false;
-            value = QString::null;
-            valueClass = QString::null;
-
-            // check 3 attribute/value pairs
-
-            for (int i = 1; i < 6; i += 2) {
-                if (i > 4)
-                    i++;
-
-                if (tag.cap(i) == "type") {
-                    isMorph   = (tag.cap(i + 1) == "morph");
-                    isStrongs = (tag.cap(i + 1) == "Strongs");
-                }
-                else if (tag.cap(i) == "value") {
-                    value = tag.cap(i + 1);
-                }
-                else if (tag.cap(i) == "class") {
-                    valueClass = tag.cap(i + 1);
-                }
-            }
-
-            // prepend the class qualifier to the value
-            if (!valueClass.isEmpty()) {
-                value = valueClass + ":" + value;
-                //     value.append(":").append(value);
-            }
-
-            if (value.isEmpty()) {
-                break;
-            }
-
-            //insert the span
-            if (!insertedTag) {
-                e.replace(pos, tag.matchedLength(), "</span>");
-                pos += 7;
-
-                QString rep = QString("<span lemma=\"").append(value).append("\">");
-                int startPos = 0;
-                QChar c = e[startPos];
-
-                while ((startPos < pos) && (c.isSpace() || c.isPunct())) {
-                    ++startPos;
-                    c = e[startPos];
-                }
-
-                hasLemmaAttr = isStrongs;
-                hasMorphAttr = isMorph;
+    const char * const wordStart = findWordStart(pieceStart, wordEnd);
+    out.append(pieceStart, wordStart - pieceStart);
+    span.appendOpenTag(out);
+    out.append(wordStart, wordEnd - wordStart);
+    out.append("</span>");
+    out.append(tail);
+}
 
-                e.insert( startPos, rep );
-                pos += rep.length();
-            }
-            else { //add the attribute to the existing tag
-                e.remove(pos, tag.matchedLength());
+} // anonymous namespace
 
-                if ((!isMorph && hasLemmaAttr) || (isMorph && hasMorphAttr)) { //we append another attribute value, e.g. 3000 gets 3000|5000
-                    //search the existing attribute start
-                    QRegExp attrRegExp( isMorph ? "morph=\".+(?=\")" : "lemma=\".+(?=\")" );
-                    attrRegExp.setMinimal(true);
-                    const int foundAttrPos = e.indexOf(attrRegExp, pos);
+char ThmlToHtml::processText(sword::SWBuf &buf, const sword::SWKey *key,
+                             const sword::SWModule *module)
+{
+    sword::ThMLHTML::processText(buf, key, module);
 
-                    if (foundAttrPos != -1) {
-                        e.insert(foundAttrPos + attrRegExp.matchedLength(), QString("|").append(value));
-                        pos += value.length() + 1;
+    CSwordModuleInfo* m = CSwordBackend::instance()->findModuleByName( module->getName() );
 
-                        hasLemmaAttr = !isMorph;
-                        hasMorphAttr = isMorph;
-                    }
-                }
-                else { //attribute was not yet inserted
-                    const int attrPos = e.indexOf(QRegExp("morph=|lemma="), 0);
+    if (m && !(m->has(CSwordModuleInfo::lemmas) || m->has(CSwordModuleInfo::strongNumbers))) { //only parse if the module has strongs or lemmas
+        return 1;
+    }
 
-                    if (attrPos >= 0) {
-                        QString attr;
-                        attr.append(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\" ");
-                        e.insert(attrPos, attr);
+    addWordSpans(buf);
+    return 1;
+}
 
-                        hasMorphAttr = isMorph;
-                        hasLemmaAttr = !isMorph;
+void ThmlToHtml::addWordSpans(sword::SWBuf &buf) {
+    const char * const begin = buf.c_str();
+    const char * const end = begin + buf.length();
 
-                        pos += attr.length();
-                    }
-                }
-            }
+    const char * tagEnd;
+    const char * tag = findSyncTag(begin, end, tagEnd);
+    if (!tag) { //no strong or morph code found in this text
+        return;
+    }
 
-            insertedTag = true;
-            pos = tag.indexIn(e, pos);
+    sword::SWBuf result;
+    const char * pieceStart = begin;
+    while (tag) {
+        //all directly following sync tags belong to the same word
+        const char * pieceEnd = tagEnd + 1;
+        for (;;) {
+            const char * next = pieceEnd;
+            if (next < end && isSeparator(*next))
+                ++next;
+            const char * const nextEnd = syncTagEnd(next, end);
+            if (!nextEnd)
+                break;
+            pieceEnd = nextEnd + 1;
         }
 
-        result.append( e );
-    }
+        appendWord(result, pieceStart, tag, tagEnd, pieceEnd);
 
-    if (list.count()) {
-        buf = (const char*)result.toUtf8();
+        pieceStart = pieceEnd;
+        tag = findSyncTag(pieceStart, end, tagEnd);
     }
 
-    return 1;
+    result.append(pieceStart, end - pieceStart);
+    buf = result;
 }
 
 
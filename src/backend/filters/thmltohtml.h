@@ -50,6 +50,12 @@ class ThmlToHtml: public sword::ThMLHTML {
                                  const sword::SWKey *key,
                                  const sword::SWModule *module = 0);
 
+        /**
+          Wraps each word followed by <sync> tags in a <span> with lemma and
+          morph attributes. Used by processText() on the HTML of ThMLHTML.
+        */
+        static void addWordSpans(sword::SWBuf &buf);
+
     protected: /* Methods: */
         /** Reimplemented from sword::OSISHTMLHREF. */
         virtual inline sword::BasicFilterUserData *createUserData(
@@ -0,0 +1,162 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/filters/wordspanbuilder.h"
+
+#include <cstring>
+#include <QChar>
+
+
+namespace {
+
+/**
+  Decodes the UTF-8 character at \a p. Invalid sequences are treated as single
+  byte characters.
+  \param[out] length the number of bytes of the character.
+*/
+inline uint decodeUtf8(const char * p, const char * end, int & length) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    length = 1;
+    if (c < 0x80)
+        return c;
+
+    uint ucs;
+    int extra;
+    if ((c & 0xe0) == 0xc0) {
+        ucs = c & 0x1f;
+        extra = 1;
+    } else if ((c & 0xf0) == 0xe0) {
+        ucs = c & 0x0f;
+        extra = 2;
+    } else if ((c & 0xf8) == 0xf0) {
+        ucs = c & 0x07;
+        extra = 3;
+    } else {
+        return 0xfffd;
+    }
+
+    if (end - p <= extra)
+        return 0xfffd;
+
+    for (int i = 1; i <= extra; i++) {
+        const unsigned char cc = static_cast<unsigned char>(p[i]);
+        if ((cc & 0xc0) != 0x80)
+            return 0xfffd;
+        ucs = (ucs << 6) | (cc & 0x3f);
+    }
+    length = extra + 1;
+    return ucs;
+}
+
+inline bool isSpace(uint ucs) {
+    return ucs <= 0xffff && QChar(static_cast<ushort>(ucs)).isSpace();
+}
+
+inline bool isPunct(uint ucs) {
+    if (ucs <= 0xffff)
+        return QChar(static_cast<ushort>(ucs)).isPunct();
+
+    const QChar::Category c = QChar::category(ucs);
+    return c >= QChar::Punctuation_Connector && c <= QChar::Punctuation_Other;
+}
+
+inline void appendValue(sword::SWBuf & attr,
+                        const char * value,
+                        const char * valueEnd)
+{
+    if (attr.length())
+        attr.append('|');
+    attr.append(value, valueEnd - value);
+}
+
+inline void appendAttribute(sword::SWBuf & out,
+                            const char * name,
+                            const sword::SWBuf & value)
+{
+    out.append(name);
+    out.append("=\"");
+    out.append(value);
+    out.append('"');
+}
+
+} // anonymous namespace
+
+namespace Filters {
+
+void WordSpanBuilder::add(bool isMorph,
+                          const char * value,
+                          const char * valueEnd)
+{
+    if (isEmpty())
+        m_firstIsMorph = isMorph;
+    appendValue(isMorph ? m_morph : m_lemma, value, valueEnd);
+}
+
+void WordSpanBuilder::appendOpenTag(sword::SWBuf & out) const {
+    out.append("<span ");
+    const sword::SWBuf & first = m_firstIsMorph ? m_morph : m_lemma;
+    const sword::SWBuf & second = m_firstIsMorph ? m_lemma : m_morph;
+    const char * firstName = m_firstIsMorph ? "morph" : "lemma";
+    const char * secondName = m_firstIsMorph ? "lemma" : "morph";
+
+    if (second.length()) {
+        appendAttribute(out, secondName, second);
+        out.append(' ');
+    }
+    appendAttribute(out, firstName, first);
+    out.append('>');
+}
+
+const char * WordSpanBuilder::skipSpaceAndPunct(const char * begin,
+                                                const char * end)
+{
+    while (begin < end) {
+        int length;
+        const uint ucs = decodeUtf8(begin, end, length);
+        if (!isSpace(ucs) && !isPunct(ucs))
+            break;
+        begin += length;
+    }
+    return begin;
+}
+
+const char * WordSpanBuilder::skipSpace(const char * begin, const char * end) {
+    while (begin < end) {
+        int length;
+        if (!isSpace(decodeUtf8(begin, end, length)))
+            break;
+        begin += length;
+    }
+    return begin;
+}
+
+bool WordSpanBuilder::findAttribute(const char * tag,
+                                    const char * tagEnd,
+                                    const char * name,
+                                    const char *& value,
+                                    const char *& valueEnd)
+{
+    const size_t nameLength = strlen(name);
+    for (const char * p = tag + 1; p + nameLength + 2 < tagEnd; p++) {
+        if (p[-1] != ' ' && p[-1] != '\t' && p[-1] != '\n')
+            continue;
+        if (strncmp(p, name, nameLength) != 0
+            || p[nameLength] != '='
+            || p[nameLength + 1] != '"')
+            continue;
+
+        value = p + nameLength + 2;
+        valueEnd = static_cast<const char *>(
+                memchr(value, '"', tagEnd - value));
+        return valueEnd != 0;
+    }
+    return false;
+}
+
+} // namespace Filters
@@ -0,0 +1,80 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef FILTERS_WORDSPANBUILDER_H
+#define FILTERS_WORDSPANBUILDER_H
+
+// Sword includes:
+#include <swbuf.h>
+
+
+namespace Filters {
+
+/**
+  \brief Collects the Strong's numbers and morphology codes of a word.
+
+  Used by the GBF and ThML filters to wrap a word in a
+  <span lemma="..." morph="..."> element. The filters scan the UTF-8 output of
+  Sword directly, so everything here works on byte ranges.
+*/
+class WordSpanBuilder {
+
+    public: /* Methods: */
+
+        inline WordSpanBuilder() : m_firstIsMorph(false) {}
+
+        inline bool isEmpty() const {
+            return !m_lemma.length() && !m_morph.length();
+        }
+
+        /**
+          Adds a value to the lemma or morph attribute. Values of the same kind
+          are separated by '|'.
+        */
+        void add(bool isMorph, const char * value, const char * valueEnd);
+
+        /**
+          Appends the opening <span> tag with all collected attributes to
+          \a out. An attribute which was added later is written first.
+        */
+        void appendOpenTag(sword::SWBuf & out) const;
+
+        /**
+          \returns the first character in [begin, end) which is neither
+                   whitespace nor punctuation (in the QChar sense).
+        */
+        static const char * skipSpaceAndPunct(const char * begin,
+                                              const char * end);
+
+        /** \returns the first non-whitespace character in [begin, end). */
+        static const char * skipSpace(const char * begin, const char * end);
+
+        /**
+          Looks up a double-quoted attribute inside the tag [tag, tagEnd).
+          \returns whether the attribute was found.
+        */
+        static bool findAttribute(const char * tag,
+                                  const char * tagEnd,
+                                  const char * name,
+                                  const char *& value,
+                                  const char *& valueEnd);
+
+    private: /* Fields: */
+
+        sword::SWBuf m_lemma;
+        sword::SWBuf m_morph;
+        bool m_firstIsMorph;
+
+};
+
+} // namespace Filters
+
+#endif
@@ -0,0 +1,139 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/keys/btversificationmap.h"
+
+#include <cstring>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include "util/directory.h"
+
+// Sword includes:
+#include <swversion.h>
+#include <versekey.h>
+
+
+namespace {
+
+/** Change it once the format changed to make all systems rebuild their caches. */
+const QString CACHE_FORMAT = "1";
+
+QMutex mapsMutex;
+QHash<QByteArray, BtVersificationMap *> maps;
+
+inline QString swordVersion() {
+    return QString::fromLatin1(sword::SWVersion::currentVersion.getText());
+}
+
+} // anonymous namespace
+
+const BtVersificationMap &BtVersificationMap::get(const char *from, const char *to) {
+    const QByteArray id = QByteArray(from).append('\n').append(to);
+
+    QMutexLocker lock(&mapsMutex);
+    BtVersificationMap *&m = maps[id];
+    if (m == 0)
+        m = new BtVersificationMap(from, to);
+    return *m;
+}
+
+bool BtVersificationMap::position(sword::VerseKey &to, const sword::VerseKey &from) {
+    if (strcmp(to.getVersificationSystem(), from.getVersificationSystem()) == 0) {
+        to.positionFrom(from);
+        return !to.popError();
+    }
+
+    const long index = get(from.getVersificationSystem(),
+                           to.getVersificationSystem()).map(from.getIndex());
+    if (index < 0)
+        return false;
+
+    // The map includes intros, so they have to be enabled to set the index:
+    const bool intros = to.isIntros();
+    to.setIntros(true);
+    to.setIndex(index);
+    to.setIntros(intros);
+    return !to.popError();
+}
+
+QVector<qint32> BtVersificationMap::compute(const char *from, const char *to) {
+    sword::VerseKey src;
+    src.setVersificationSystem(from);
+    src.setIntros(true);
+    sword::VerseKey dst;
+    dst.setVersificationSystem(to);
+    dst.setIntros(true);
+
+    src.setPosition(sword::BOTTOM);
+    const long count = src.getIndex() + 1;
+
+    QVector<qint32> table(count);
+    for (long i = 0; i < count; i++) {
+        src.setIndex(i);
+        if (src.popError() || src.getIndex() != i) {
+            table[i] = -1;
+            continue;
+        }
+        dst.positionFrom(src);
+        table[i] = dst.popError() ? -1 : dst.getIndex();
+    }
+    return table;
+}
+
+QString BtVersificationMap::cacheFileName(const char *from, const char *to) {
+    namespace DU = util::directory;
+    return DU::getUserCacheDir().absolutePath()
+           .append("/v11n-").append(from)
+           .append('-').append(to).append(".map");
+}
+
+BtVersificationMap::BtVersificationMap(const char *from, const char *to) {
+    const QString fileName = cacheFileName(from, to);
+    if (load(fileName))
+        return;
+
+    m_table = compute(from, to);
+    save(fileName);
+}
+
+bool BtVersificationMap::load(const QString &fileName) {
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream s(&f);
+    QString format;
+    QString version;
+    s >> format >> version;
+    if (format != CACHE_FORMAT || version != swordVersion())
+        return false;
+
+    QVector<qint32> table;
+    s >> table;
+    if (s.status() != QDataStream::Ok || table.isEmpty())
+        return false;
+
+    m_table = table;
+    return true;
+}
+
+void BtVersificationMap::save(const QString &fileName) const {
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write the versification map" << fileName;
+        return;
+    }
+
+    QDataStream s(&f);
+    s << CACHE_FORMAT << swordVersion() << m_table;
+}
@@ -0,0 +1,85 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTVERSIFICATIONMAP_H
+#define BTVERSIFICATIONMAP_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+
+namespace sword {
+class VerseKey;
+}
+
+/**
+  \brief Maps verse indexes of one versification system to another.
+
+  Converting a VerseKey between versification systems with Sword's
+  VerseKey::positionFrom() is too slow to be done for every verse of a
+  rendered chapter or every search result. The conversion of all verse
+  indexes (including intros) of a pair of versification systems is therefore
+  computed once, stored in the user cache directory and afterwards answered by
+  a single array lookup. The cache files are rebuilt when the Sword version
+  changes, since the versification data is compiled into the library.
+*/
+class BtVersificationMap {
+
+    public: /* Methods: */
+
+        /**
+          \returns the map from versification \a from to versification \a to,
+                   which is loaded from the cache or computed on first use.
+          \note This method is thread-safe, the maps are never freed.
+        */
+        static const BtVersificationMap &get(const char *from, const char *to);
+
+        /**
+          Positions \a to on the verse corresponding to \a from, using the map
+          between their versification systems.
+          \returns whether there is a corresponding verse.
+        */
+        static bool position(sword::VerseKey &to, const sword::VerseKey &from);
+
+        /**
+          Computes the map between the given versification systems using
+          VerseKey::positionFrom(), without touching any caches.
+        */
+        static QVector<qint32> compute(const char *from, const char *to);
+
+        /** \returns the file name the map between the given systems is cached in. */
+        static QString cacheFileName(const char *from, const char *to);
+
+        /**
+          \returns the verse index (with intros) in the target versification or
+                   -1 if the given index has no corresponding verse.
+        */
+        inline long map(long index) const {
+            return (index >= 0 && index < m_table.size()) ? m_table.at(index) : -1;
+        }
+
+        inline const QVector<qint32> &table() const { return m_table; }
+
+    private: /* Methods: */
+
+        BtVersificationMap(const char *from, const char *to);
+
+        bool load(const QString &fileName);
+        void save(const QString &fileName) const;
+
+    private: /* Fields: */
+
+        QVector<qint32> m_table;
+
+};
+
+#endif
@@ -9,13 +9,16 @@
 
 #include "backend/keys/cswordkey.h"
 
+#include <QHash>
 #include <QRegExp>
 #include <QString>
 #include <QTextCodec>
 #include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/btversificationmap.h"
 #include "backend/keys/cswordldkey.h"
 #include "backend/keys/cswordtreekey.h"
 #include "backend/keys/cswordversekey.h"
+#include "backend/rendering/btrendersink.h"
 
 // Sword includes:
 #include <swkey.h>
@@ -26,6 +29,79 @@
 #include <versekey.h>
 
 
+namespace {
+
+inline bool isWordChar(const QChar c) {
+    return c.isLetterOrNumber() || c == '_';
+}
+
+/**
+  Links the numbers in the text of a lexicon entry which are referred to as
+  "GREEK for 0123" or "HEBREW for 123" to their Strong's entries. All the
+  references are collected first, then the text is rewritten in one pass.
+*/
+QString linkStrongsReferences(const QString & text) {
+    const QRegExp rx("(GREEK|HEBREW) for 0*([1-9]\\d*)"); // ignore 0's before number
+
+    // The language of each referenced number without leading zeros:
+    QHash<QString, QString> languages;
+    for (int pos = rx.indexIn(text); pos != -1; pos = rx.indexIn(text, pos + rx.matchedLength()))
+        if (!languages.contains(rx.cap(2)))
+            languages.insert(rx.cap(2), rx.cap(1));
+
+    if (languages.isEmpty())
+        return text;
+
+    QString ret;
+    ret.reserve(text.size() + languages.size() * 64);
+
+    // Numbers are only linked in text after a tag, not inside of tags:
+    bool inTag = false;
+    bool afterTag = false;
+    const int size = text.size();
+    int i = 0;
+    while (i < size) {
+        const QChar c = text.at(i);
+        if (inTag || !afterTag || !c.isDigit() || (i > 0 && isWordChar(text.at(i - 1)))) {
+            if (c == '<') {
+                inTag = true;
+            } else if (c == '>') {
+                inTag = false;
+                afterTag = true;
+            }
+            ret.append(c);
+            i++;
+            continue;
+        }
+
+        int end = i;
+        while (end < size && text.at(end).isDigit())
+            end++;
+        const QString digits(text.mid(i, end - i));
+        i = end;
+
+        int zeros = 0;
+        while (zeros < digits.size() - 1 && digits.at(zeros) == '0')
+            zeros++;
+
+        const QHash<QString, QString>::const_iterator it = languages.constFind(digits.mid(zeros));
+        if (it == languages.constEnd() || (end < size && isWordChar(text.at(end)))) {
+            ret.append(digits);
+            continue;
+        }
+
+        const QString & language = it.value();
+        const QString paddedNumber = it.key().rightJustified(5, '0'); // Form 00123
+        ret.append("<span lemma=\"").append(language.at(0)).append(paddedNumber)
+           .append("\"><a href=\"strongs://").append(language).append('/').append(paddedNumber)
+           .append("\">").append(digits).append("</a></span>");
+    }
+
+    return ret;
+}
+
+} // anonymous namespace
+
 const QTextCodec * CSwordKey::m_cp1252Codec = QTextCodec::codecForName("Windows-1252");
 
 QString CSwordKey::rawText() {
@@ -41,9 +117,7 @@ QString CSwordKey::rawText() {
     return QString::fromUtf8(m_module->module()->getRawEntry());
 }
 
-QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
-    Q_ASSERT(m_module);
-
+bool CSwordKey::positionModuleKey() {
     sword::SWKey * const k = dynamic_cast<sword::SWKey *>(this);
 
     if (k) {
@@ -51,7 +125,11 @@ QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
         if (vk_mod)
             vk_mod->setIntros(true);
 
-        m_module->module()->getKey()->setText(rawKey());
+        /* Verse keys are positioned without parsing the text of the key,
+           across versifications with the precomputed verse map: */
+        const sword::VerseKey * const vk = dynamic_cast<const sword::VerseKey *>(k);
+        if (!vk_mod || !vk || !BtVersificationMap::position(*vk_mod, *vk))
+            m_module->module()->getKey()->setText(rawKey());
 
         if (m_module->type() == CSwordModuleInfo::Lexicon) {
             m_module->snap();
@@ -62,12 +140,18 @@ QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
                 && !strstr(m_module->module()->getKey()->getText(), rawKey()))
             {
                 qDebug("return an empty key for %s", m_module->module()->getKey()->getText());
-                return QString::null;
+                return false;
             }
         }
     }
 
-    if (key().isNull())
+    return !key().isNull();
+}
+
+QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
+    Q_ASSERT(m_module);
+
+    if (!positionModuleKey())
         return QString::null;
 
     bool DoRender = mode != ProcessEntryAttributesOnly;
@@ -76,26 +160,8 @@ QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
         return QString::null;
 
     // This is yucky, but if we want strong lexicon refs we have to do it here.
-    if (m_module->type() == CSwordModuleInfo::Lexicon) {
-        const QString t(text);
-        const QRegExp rx("(GREEK|HEBREW) for 0*([1-9]\\d*)");    // ignore 0's before number
-        int pos = 0;
-        while ((pos = rx.indexIn(t, pos)) != -1) {
-            const QString language = rx.cap(1);
-            const QString langcode = QString(language.at(0));    // "G" or "H"
-            const QString number = rx.cap(2);
-            const QString paddednumber = number.rightJustified(5, '0');    // Form 00123
-
-            text.replace(
-                QRegExp(QString(
-                            "(>[^<>]+)"            // Avoid replacing inside tags
-                            "\\b(0*%1)\\b").arg(number)),    // And span around 0's
-                QString("\\1<span lemma=\"%1%2\"><a href=\"strongs://%3/%4\">\\2</a></span>")
-                    .arg(langcode, paddednumber, language, paddednumber)
-            );
-            pos += rx.matchedLength();
-        }
-    }
+    if (m_module->type() == CSwordModuleInfo::Lexicon)
+        text = linkStrongsReferences(text);
 
     if (mode == HTMLEscaped) {
         /*
@@ -122,6 +188,45 @@ QString CSwordKey::renderedText(const CSwordKey::TextRenderType mode) {
     }
 }
 
+bool CSwordKey::renderedText(Rendering::BtRenderSink & out) {
+    Q_ASSERT(m_module);
+
+    // Strong's references in lexicon entries are linked on the QString level:
+    if (m_module->type() == CSwordModuleInfo::Lexicon) {
+        const QString text(renderedText());
+        out.append(text);
+        return !text.isNull();
+    }
+
+    if (!positionModuleKey())
+        return false;
+
+    out.append(m_module->module()->renderText());
+    return true;
+}
+
+void CSwordKey::renderedText(Rendering::BtRenderSink & out,
+                             sword::AttributeTypeList & attributes)
+{
+    attributes.clear();
+
+    /* The option filters fill the entry attributes during the render pass,
+       so there is no need to run the filters a second time for them. */
+    if (renderedText(out))
+        attributes.swap(m_module->module()->getEntryAttributes());
+}
+
+sword::AttributeTypeList CSwordKey::entryAttributes() {
+    sword::AttributeTypeList attributes;
+
+    if (m_module && positionModuleKey()) {
+        m_module->module()->renderText(0, -1, false);
+        attributes.swap(m_module->module()->getEntryAttributes());
+    }
+
+    return attributes;
+}
+
 QString CSwordKey::strippedText() {
     if (!m_module)
         return QString::null;
@@ -136,6 +241,16 @@ QString CSwordKey::strippedText() {
     return QString::fromUtf8(m_module->module()->stripText());
 }
 
+void CSwordKey::strippedText(Rendering::BtRenderSink & out) {
+    if (!m_module)
+        return;
+
+    if (dynamic_cast<sword::SWKey*>(this))
+        m_module->module()->getKey()->setText(rawKey());
+
+    out.append(m_module->module()->stripText());
+}
+
 void CSwordKey::emitBeforeChanged() {
     if (!m_beforeChangedSignaller.isNull())
         m_beforeChangedSignaller->emitSignal();
@@ -16,10 +16,17 @@
 #include <QString>
 #include "util/btsignal.h"
 
+// Sword includes:
+#include <swmodule.h>
+
 
 class CSwordModuleInfo;
 class QTextCodec;
 
+namespace Rendering {
+class BtRenderSink;
+}
+
 /** Base class for all Sword based keys. */
 class CSwordKey {
 
@@ -82,11 +89,38 @@ public: /* Types: */
     */
     QString renderedText(const CSwordKey::TextRenderType mode = CSwordKey::Normal);
 
+    /**
+      Appends the rendered text under the current key to the given sink. The
+      UTF-8 output of the filters is written without a QString round trip.
+      \returns false if there was no entry to render for this key.
+    */
+    bool renderedText(Rendering::BtRenderSink & out);
+
+    /**
+      Like renderedText(Rendering::BtRenderSink &), but additionally moves the
+      entry attributes (headings, footnotes, Strong's numbers etc.) which were
+      collected by the same filter pass into \a attributes. The module's own
+      attributes are left empty.
+    */
+    void renderedText(Rendering::BtRenderSink & out,
+                      sword::AttributeTypeList & attributes);
+
+    /**
+      \returns the entry attributes of the current key. The entry is only
+               passed through the option and strip filters, not rendered.
+    */
+    sword::AttributeTypeList entryAttributes();
+
     /**
       \returns the text after removing all markup tags from it.
     */
     QString strippedText();
 
+    /**
+      Appends the text without markup tags to the given sink.
+    */
+    void strippedText(Rendering::BtRenderSink & out);
+
     const BtSignal * beforeChangedSignaller();
     const BtSignal * afterChangedSignaller();
 
@@ -123,6 +157,12 @@ protected: /* Methods: */
 
 private: /* Methods: */
 
+    /**
+      Sets the key of the module to this key before rendering.
+      \returns false if there is nothing to render for this key.
+    */
+    bool positionModuleKey();
+
     /**
       Disable the assignment operator
     */
@@ -0,0 +1,178 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/managers/btindexcatalog.h"
+
+#include <CLucene.h>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSettings>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "util/directory.h"
+
+
+namespace {
+
+/** Change it once the format changed to make all systems rebuild the catalog. */
+const QString CATALOG_FORMAT = "1";
+
+} // anonymous namespace
+
+BtIndexCatalog & BtIndexCatalog::instance() {
+    static BtIndexCatalog catalog;
+    return catalog;
+}
+
+BtIndexCatalog::BtIndexCatalog() {
+    if (!load()) {
+        loadFromIndexDirectories();
+        save();
+    }
+}
+
+bool BtIndexCatalog::entry(const QString & moduleName, Entry & entry) const {
+    QMutexLocker lock(&m_mutex);
+    const QHash<QString, Entry>::const_iterator it = m_entries.constFind(moduleName);
+    if (it == m_entries.constEnd())
+        return false;
+
+    entry = *it;
+    return true;
+}
+
+QStringList BtIndexCatalog::moduleNames() const {
+    QMutexLocker lock(&m_mutex);
+    return m_entries.keys();
+}
+
+void BtIndexCatalog::setEntry(const QString & moduleName, const Entry & entry) {
+    QMutexLocker lock(&m_mutex);
+    m_entries.insert(moduleName, entry);
+    save();
+}
+
+void BtIndexCatalog::remove(const QString & moduleName) {
+    QMutexLocker lock(&m_mutex);
+    if (m_entries.remove(moduleName) > 0)
+        save();
+}
+
+bool BtIndexCatalog::addFromIndexDirectory(const QString & moduleName) {
+    Entry e;
+    if (!probeIndexDirectory(moduleName, e))
+        return false;
+
+    QMutexLocker lock(&m_mutex);
+    m_entries.insert(moduleName, e);
+    save();
+    return true;
+}
+
+QString BtIndexCatalog::fileName() const {
+    return CSwordModuleInfo::getGlobalBaseIndexLocation()
+           + QString("/bibletime-index-catalog");
+}
+
+bool BtIndexCatalog::load() {
+    QFile f(fileName());
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream s(&f);
+    s.setVersion(QDataStream::Qt_4_6);
+
+    QString format;
+    quint32 count;
+    s >> format >> count;
+    if (format != CATALOG_FORMAT)
+        return false;
+
+    QHash<QString, Entry> entries;
+    for (quint32 i = 0; i < count && s.status() == QDataStream::Ok; i++) {
+        QString moduleName;
+        Entry e;
+        quint32 state;
+        s >> moduleName >> e.moduleVersion >> e.indexVersion >> e.size >> state;
+        e.state = (state == Ready) ? Ready : Building;
+        entries.insert(moduleName, e);
+    }
+    if (s.status() != QDataStream::Ok)
+        return false;
+
+    m_entries = entries;
+    return true;
+}
+
+void BtIndexCatalog::loadFromIndexDirectories() {
+    Q_FOREACH (const QString & moduleName,
+               QDir(CSwordModuleInfo::getGlobalBaseIndexLocation())
+                   .entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        Entry e;
+        if (probeIndexDirectory(moduleName, e))
+            m_entries.insert(moduleName, e);
+    }
+}
+
+bool BtIndexCatalog::probeIndexDirectory(const QString & moduleName,
+                                         Entry & entry) const
+{
+    namespace DU = util::directory;
+
+    const QString moduleDir = CSwordModuleInfo::getGlobalBaseIndexLocation()
+                              + "/" + moduleName;
+    const QString standardDir = moduleDir + "/standard";
+    if (!QDir(standardDir).exists()
+        || !lucene::index::IndexReader::indexExists(standardDir.toLatin1().constData()))
+        return false;
+
+    const QSettings module_config(moduleDir + QString("/bibletime-index.conf"),
+                                  QSettings::IniFormat);
+    entry.moduleVersion = module_config.value("module-version").toString();
+    entry.indexVersion = module_config.value("index-version").toUInt();
+    entry.size = DU::getDirSizeRecursive(moduleDir);
+    entry.state = Ready;
+    return true;
+}
+
+void BtIndexCatalog::save() const {
+    const QString name = fileName();
+    QDir().mkpath(CSwordModuleInfo::getGlobalBaseIndexLocation());
+
+    // Write a new file and replace the old one, so no half-written catalog is read:
+    const QString tempName = name + ".new";
+    QFile f(tempName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write the index catalog" << name;
+        return;
+    }
+
+    QDataStream s(&f);
+    s.setVersion(QDataStream::Qt_4_6);
+    s << CATALOG_FORMAT << static_cast<quint32>(m_entries.size());
+    for (QHash<QString, Entry>::const_iterator it = m_entries.constBegin();
+         it != m_entries.constEnd();
+         ++it)
+    {
+        s << it.key() << it->moduleVersion << it->indexVersion << it->size
+          << static_cast<quint32>(it->state);
+    }
+    f.close();
+
+    if (f.error() != QFile::NoError
+        || (QFile::exists(name) && !QFile::remove(name))
+        || !QFile::rename(tempName, name))
+    {
+        qWarning() << "Failed to write the index catalog" << name;
+        QFile::remove(tempName);
+    }
+}
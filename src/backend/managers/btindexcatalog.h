@@ -0,0 +1,101 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTINDEXCATALOG_H
+#define BTINDEXCATALOG_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+
+/**
+  \brief Catalog of the search indices of the modules.
+
+  Whether a module has a usable index used to be found out by probing the
+  index directory, its bibletime-index.conf and the Lucene index every time it
+  was asked. The catalog keeps this information in memory instead. It is
+  loaded once from a file in the index directory, updated when indices are
+  built or deleted, and saved by replacing the file as a whole.
+
+  If there is no catalog yet, it is created once from the existing index
+  directories.
+
+  \note The methods are thread-safe, indices are built in a separate thread.
+*/
+class BtIndexCatalog {
+
+    public: /* Types: */
+
+        enum State {
+            Building, /**< The index is being built or building it was interrupted. */
+            Ready
+        };
+
+        struct Entry {
+            QString moduleVersion;
+            quint32 indexVersion;
+            qint64 size;
+            State state;
+
+            inline Entry() : indexVersion(0u), size(0), state(Building) {}
+        };
+
+    public: /* Methods: */
+
+        static BtIndexCatalog & instance();
+
+        /**
+          \param[out] entry The catalog entry of the module, if any.
+          \returns whether the catalog has an entry for the given module.
+        */
+        bool entry(const QString & moduleName, Entry & entry) const;
+
+        /** \returns the names of the modules with an entry in the catalog. */
+        QStringList moduleNames() const;
+
+        void setEntry(const QString & moduleName, const Entry & entry);
+        void remove(const QString & moduleName);
+
+        /**
+          Looks for a complete index of the module in its index directory, like
+          it was done before the catalog existed, and adds it to the catalog.
+          This is for indices the catalog doesn't know about, e.g. if the
+          catalog file was lost.
+          \returns whether an index was found and added.
+        */
+        bool addFromIndexDirectory(const QString & moduleName);
+
+    private: /* Methods: */
+
+        BtIndexCatalog();
+
+        QString fileName() const;
+        bool load();
+        void loadFromIndexDirectories();
+
+        /**
+          \param[out] entry The entry for the index found.
+          \returns whether the index directory of the module holds a complete
+                   index.
+        */
+        bool probeIndexDirectory(const QString & moduleName, Entry & entry) const;
+        void save() const;
+
+    private: /* Fields: */
+
+        mutable QMutex m_mutex;
+        QHash<QString, Entry> m_entries;
+
+};
+
+#endif
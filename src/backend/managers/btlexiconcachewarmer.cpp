@@ -0,0 +1,84 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/managers/btlexiconcachewarmer.h"
+
+#include <QTimer>
+#include "backend/drivers/cswordlexiconmoduleinfo.h"
+#include "backend/managers/cswordbackend.h"
+
+
+namespace {
+
+/** The number of keys read per step, small enough not to block the GUI. */
+const int KEYS_PER_STEP = 200;
+
+/** The delay between the steps, to leave the event loop some time. */
+const int STEP_INTERVAL = 10;
+
+} // anonymous namespace
+
+BtLexiconCacheWarmer::BtLexiconCacheWarmer(QObject * parent)
+    : QObject(parent)
+    , m_total(0)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(STEP_INTERVAL);
+    m_timer->setSingleShot(true);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(step()));
+}
+
+bool BtLexiconCacheWarmer::start() {
+    m_pending.clear();
+
+    Q_FOREACH (const CSwordModuleInfo * m, CSwordBackend::instance()->moduleList()) {
+        const CSwordLexiconModuleInfo * const lexicon =
+                qobject_cast<const CSwordLexiconModuleInfo *>(m);
+        if (lexicon != 0 && !lexicon->hasKeyIndex())
+            m_pending.append(lexicon->name());
+    }
+
+    m_total = m_pending.count();
+    if (m_pending.isEmpty())
+        return false;
+
+    m_timer->start();
+    return true;
+}
+
+void BtLexiconCacheWarmer::cancel() {
+    if (m_pending.isEmpty())
+        return;
+
+    m_timer->stop();
+    m_pending.clear();
+    emit finished();
+}
+
+void BtLexiconCacheWarmer::step() {
+    if (m_pending.isEmpty())
+        return;
+
+    const QString name = m_pending.first();
+    const CSwordLexiconModuleInfo * const lexicon =
+            qobject_cast<const CSwordLexiconModuleInfo *>(
+                    CSwordBackend::instance()->findModuleByName(name));
+
+    // Modules may have been removed or reloaded with a valid cache meanwhile:
+    if (lexicon == 0 || lexicon->buildKeyIndex(KEYS_PER_STEP))
+        m_pending.removeFirst();
+
+    emit progress(name, m_total - m_pending.count(), m_total);
+
+    if (m_pending.isEmpty()) {
+        emit finished();
+    } else {
+        m_timer->start();
+    }
+}
@@ -0,0 +1,81 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTLEXICONCACHEWARMER_H
+#define BTLEXICONCACHEWARMER_H
+
+#include <QObject>
+
+#include <QStringList>
+
+
+class QTimer;
+
+/**
+  \brief Creates missing or outdated key caches of the lexicon modules.
+
+  Without a valid cache the first use of a lexicon has to read all of its
+  keys, which takes seconds for the large ones. The warmer reads the keys of
+  the lexicons needing it in small steps from the event loop, because Sword
+  is not thread-safe. Modules are looked up by name for every step, so the
+  warmer is not affected by the backend reloading its modules.
+*/
+class BtLexiconCacheWarmer: public QObject {
+
+    Q_OBJECT
+
+public: /* Methods: */
+
+    BtLexiconCacheWarmer(QObject * parent = 0);
+
+    /**
+      Checks the key caches of all lexicons and starts creating the ones
+      which are missing or outdated.
+      \returns whether any cache needs to be created.
+    */
+    bool start();
+
+    inline bool isRunning() const { return !m_pending.isEmpty(); }
+
+public slots:
+
+    /**
+      Stops creating the caches. The keys read so far are kept by the modules
+      and reused when the caches are needed later on.
+    */
+    void cancel();
+
+signals:
+
+    /**
+      Emitted after each step.
+      \param[in] module The name of the lexicon being processed.
+      \param[in] done The number of lexicons processed.
+      \param[in] total The number of lexicons to process.
+    */
+    void progress(const QString & module, int done, int total);
+
+    /** Emitted when all caches were created or the warmer was canceled. */
+    void finished();
+
+private slots:
+
+    void step();
+
+private: /* Fields: */
+
+    QStringList m_pending;
+    int m_total;
+    QTimer * m_timer;
+
+};
+
+#endif
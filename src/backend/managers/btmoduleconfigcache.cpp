@@ -0,0 +1,215 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/managers/btmoduleconfigcache.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include "util/directory.h"
+
+// Sword includes:
+#include <swconfig.h>
+
+
+namespace {
+
+/** Change it once the format changed to make all systems rebuild their caches. */
+const QString CACHE_FORMAT = "1";
+
+typedef QList<QPair<QByteArray, QByteArray> > Entries;
+typedef QList<QPair<QByteArray, Entries> > Sections;
+
+struct ConfFile {
+    qint64 modified;
+    qint64 size;
+    Sections sections;
+};
+
+typedef QHash<QString, ConfFile> Snapshot;
+
+QString snapshotFileName(const QString & dirName) {
+    namespace DU = util::directory;
+    const QByteArray hash = QCryptographicHash::hash(QFile::encodeName(dirName),
+                                                     QCryptographicHash::Md5);
+    return DU::getUserCacheDir().absolutePath().append("/modsd-")
+           .append(QString::fromLatin1(hash.toHex())).append(".snapshot");
+}
+
+Snapshot loadSnapshot(const QString & fileName, const QString & dirName) {
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return Snapshot();
+
+    // Read it at once, the snapshot is small compared to the parsing work:
+    const QByteArray data = f.readAll();
+    QDataStream s(data);
+    s.setVersion(QDataStream::Qt_4_6);
+
+    QString format;
+    QString dir;
+    quint32 fileCount;
+    s >> format >> dir >> fileCount;
+    if (format != CACHE_FORMAT || dir != dirName)
+        return Snapshot();
+
+    Snapshot snapshot;
+    for (quint32 i = 0; i < fileCount && s.status() == QDataStream::Ok; i++) {
+        QString name;
+        ConfFile file;
+        quint32 sectionCount;
+        s >> name >> file.modified >> file.size >> sectionCount;
+        for (quint32 j = 0; j < sectionCount && s.status() == QDataStream::Ok; j++) {
+            QPair<QByteArray, Entries> section;
+            quint32 entryCount;
+            s >> section.first >> entryCount;
+            for (quint32 k = 0; k < entryCount && s.status() == QDataStream::Ok; k++) {
+                QPair<QByteArray, QByteArray> entry;
+                s >> entry.first >> entry.second;
+                section.second.append(entry);
+            }
+            file.sections.append(section);
+        }
+        snapshot.insert(name, file);
+    }
+    return (s.status() == QDataStream::Ok) ? snapshot : Snapshot();
+}
+
+void saveSnapshot(const QString & fileName,
+                  const QString & dirName,
+                  const Snapshot & snapshot)
+{
+    // Write a new file and replace the old one, so no half-written snapshot is read:
+    const QString tempFileName = fileName + ".new";
+    QFile f(tempFileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write the module configuration snapshot" << fileName;
+        return;
+    }
+
+    QDataStream s(&f);
+    s.setVersion(QDataStream::Qt_4_6);
+    s << CACHE_FORMAT << dirName << static_cast<quint32>(snapshot.size());
+    for (Snapshot::const_iterator it = snapshot.constBegin(); it != snapshot.constEnd(); ++it) {
+        const ConfFile & file = it.value();
+        s << it.key() << file.modified << file.size
+          << static_cast<quint32>(file.sections.size());
+        typedef QPair<QByteArray, Entries> Section;
+        Q_FOREACH (const Section & section, file.sections) {
+            s << section.first << static_cast<quint32>(section.second.size());
+            typedef QPair<QByteArray, QByteArray> Entry;
+            Q_FOREACH (const Entry & entry, section.second)
+                s << entry.first << entry.second;
+        }
+    }
+    f.close();
+
+    if (f.error() != QFile::NoError
+        || (QFile::exists(fileName) && !QFile::remove(fileName))
+        || !QFile::rename(tempFileName, fileName))
+    {
+        qWarning() << "Failed to write the module configuration snapshot" << fileName;
+        QFile::remove(tempFileName);
+    }
+}
+
+Sections sectionsOf(const sword::SWConfig & config) {
+    Sections sections;
+    for (sword::SectionMap::const_iterator it = config.Sections.begin();
+         it != config.Sections.end();
+         ++it)
+    {
+        Entries entries;
+        for (sword::ConfigEntMap::const_iterator e = it->second.begin();
+             e != it->second.end();
+             ++e)
+        {
+            entries.append(qMakePair(QByteArray(e->first.c_str()),
+                                     QByteArray(e->second.c_str())));
+        }
+        sections.append(qMakePair(QByteArray(it->first.c_str()), entries));
+    }
+    return sections;
+}
+
+sword::SWConfig * configOf(const QByteArray & fileName, const Sections & sections) {
+    // An empty file name makes SWConfig skip reading a file:
+    sword::SWConfig * const config = new sword::SWConfig("");
+    config->filename = fileName.constData();
+
+    typedef QPair<QByteArray, Entries> Section;
+    Q_FOREACH (const Section & section, sections) {
+        sword::ConfigEntMap & map = config->Sections[section.first.constData()];
+        typedef QPair<QByteArray, QByteArray> Entry;
+        Q_FOREACH (const Entry & entry, section.second)
+            map.insert(sword::ConfigEntMap::value_type(entry.first.constData(),
+                                                       entry.second.constData()));
+    }
+    return config;
+}
+
+} // anonymous namespace
+
+namespace BtModuleConfigCache {
+
+QList<sword::SWConfig *> load(const QString & dirName) {
+    QList<sword::SWConfig *> configs;
+
+    const QDir dir(dirName);
+    if (!dir.isReadable())
+        return configs;
+
+    const QString cacheFileName = snapshotFileName(dirName);
+    const Snapshot oldSnapshot = loadSnapshot(cacheFileName, dirName);
+    Snapshot snapshot;
+    bool changed = false;
+
+    Q_FOREACH (const QFileInfo & info, dir.entryInfoList(QDir::Files | QDir::Hidden,
+                                                         QDir::Name))
+    {
+        // Like Sword, only take files ending with ".conf" into account:
+        const QString name = info.fileName();
+        if (name.size() <= 5 || !name.endsWith(".conf", Qt::CaseSensitive))
+            continue;
+
+        const QByteArray path = QFile::encodeName(info.absoluteFilePath());
+        ConfFile file;
+        file.modified = info.lastModified().toMSecsSinceEpoch();
+        file.size = info.size();
+
+        const Snapshot::const_iterator it = oldSnapshot.constFind(name);
+        if (it != oldSnapshot.constEnd()
+            && it->modified == file.modified
+            && it->size == file.size)
+        {
+            file.sections = it->sections;
+            configs.append(configOf(path, file.sections));
+        } else {
+            sword::SWConfig * const config = new sword::SWConfig(path.constData());
+            file.sections = sectionsOf(*config);
+            configs.append(config);
+            changed = true;
+        }
+        snapshot.insert(name, file);
+    }
+
+    if (changed || snapshot.size() != oldSnapshot.size())
+        saveSnapshot(cacheFileName, dirName, snapshot);
+
+    return configs;
+}
+
+} // namespace BtModuleConfigCache
@@ -0,0 +1,46 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTMODULECONFIGCACHE_H
+#define BTMODULECONFIGCACHE_H
+
+#include <QList>
+#include <QString>
+
+
+namespace sword {
+class SWConfig;
+}
+
+/**
+  \brief Reads the module configuration files of a mods.d directory through a
+         snapshot cache.
+
+  Parsing hundreds of .conf files with sword::SWConfig on every start is
+  measurable. The parsed sections of all files of a directory are therefore
+  kept in a binary snapshot in the user cache directory, which is read at once.
+  Only files whose modification time or size differ from the snapshot are
+  parsed again, after which the snapshot is rewritten.
+*/
+namespace BtModuleConfigCache {
+
+/**
+  Reads the configuration files of the given mods.d directory in the order
+  sword::SWMgr::loadConfigDir() would merge them.
+  \returns the configurations of the files, the caller takes ownership. The
+           list is empty if the directory can't be read or contains no
+           configuration files.
+*/
+QList<sword::SWConfig *> load(const QString & dirName);
+
+} // namespace BtModuleConfigCache
+
+#endif
@@ -190,7 +190,6 @@ QString CDisplayTemplateMgr::fillTemplate(const QString & name,
           .replace("#DISPLAYTYPE#", displayTypeString)
           .replace("#LANG_CSS#", langCSS)
           .replace("#PAGE_DIRECTION#", settings.textDirectionAsHtmlDirAttr())
-          .replace("#CONTENT#", newContent)
           .replace("#MODTYPE#", displayTypeString)
           .replace("#MODNAME#", moduleName)
           .replace("#DISPLAY_TEMPLATES_PATH#", DU::getDisplayTemplatesDir().absolutePath());
@@ -198,6 +197,11 @@ QString CDisplayTemplateMgr::fillTemplate(const QString & name,
     if (templateIsCss)
         output.replace("#THEME_STYLE#", readFileToString(m_cssMap[name]));
 
+    // Insert the content last, so the other placeholders are not searched in it:
+    const int contentPos = output.indexOf("#CONTENT#");
+    if (contentPos >= 0)
+        output.replace(contentPos, 9, newContent);
+
     return output;
 }
 
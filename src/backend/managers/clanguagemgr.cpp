@@ -11,6 +11,7 @@
 
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/managers/cswordbackend.h"
+#include "util/btstartupprofiler.h"
 
 
 /****************************************************/
@@ -26,6 +27,7 @@ void CLanguageMgr::destroyInstance() {
 
 CLanguageMgr *CLanguageMgr::instance() {
     if (m_instance == 0) {
+        BtStartupProfiler::Phase phase("Language manager");
         m_instance = new CLanguageMgr();
     }
 
@@ -11,7 +11,9 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
 #include <QSet>
 #include <QString>
 #include <QTextCodec>
@@ -22,6 +24,8 @@
 #include "backend/drivers/cswordlexiconmoduleinfo.h"
 #include "backend/filters/btosismorphsegmentation.h"
 #include "backend/filters/thmltoplain.h"
+#include "backend/managers/btindexcatalog.h"
+#include "backend/managers/btmoduleconfigcache.h"
 #include "btglobal.h"
 #include "util/directory.h"
 
@@ -32,6 +36,7 @@
 #include <swdisp.h>
 #include <swfiltermgr.h>
 #include <swfilter.h>
+#include <swoptfilter.h>
 #include <utilstr.h>
 
 
@@ -43,6 +48,10 @@ CSwordBackend::CSwordBackend()
         : sword::SWMgr(0, 0, false,
                        new sword::EncodingFilterMgr(sword::ENC_UTF8), true)
         , m_dataModel(this)
+        , m_descriptionIndexValid(false)
+        , m_hiddenModulesLoaded(false)
+        , m_appliedFilterOptions(0u)
+        , m_filterOptionsApplied(false)
 {
     filterInit();
 }
@@ -51,6 +60,10 @@ CSwordBackend::CSwordBackend(const QString & path, const bool augmentHome)
         : sword::SWMgr(!path.isEmpty() ? path.toLocal8Bit().constData() : 0,
                        false, new sword::EncodingFilterMgr(sword::ENC_UTF8),
                        false, augmentHome)
+        , m_descriptionIndexValid(false)
+        , m_hiddenModulesLoaded(false)
+        , m_appliedFilterOptions(0u)
+        , m_filterOptionsApplied(false)
 { // don't allow module renaming, because we load from a path
     filterInit();
 }
@@ -76,6 +89,8 @@ void CSwordBackend::filterInit() {
     delete thmlplain;
     thmlplain = new Filters::ThmlToPlain();
     cleanupFilters.push_back(thmlplain);
+
+    updateOptionFilters();
 }
 
 QList<CSwordModuleInfo *> CSwordBackend::takeModulesFromList(const QStringList & names) {
@@ -87,8 +102,10 @@ QList<CSwordModuleInfo *> CSwordBackend::takeModulesFromList(const QStringList &
             list.append(mInfo);
         }
     }
-    if (!list.isEmpty())
+    if (!list.isEmpty()) {
+        updateModuleIndices();
         emit sigSwordSetupChanged(RemovedModules);
+    }
     return list;
 }
 
@@ -122,6 +139,7 @@ CSwordBackend::LoadError CSwordBackend::initModules(const SetupChangedReason rea
 
     sword::ModMap::iterator end = Modules.end();
     const LoadError ret = static_cast<LoadError>(Load());
+    updateOptionFilters();
 
     for (sword::ModMap::iterator it = Modules.begin(); it != end; ++it) {
         sword::SWModule * const curMod = it->second;
@@ -145,15 +163,19 @@ CSwordBackend::LoadError CSwordBackend::initModules(const SetupChangedReason rea
         }
 
         // Append the new modules to our list, but only if it's supported
-        // The constructor of CSwordModuleInfo prints a warning on stdout
         if (!newModule->hasVersion()
             || (newModule->minimumSwordVersion() <= sword::SWVersion::currentVersion))
         {
             m_dataModel.addModule(newModule);
         } else {
+            qWarning("The module \"%s\" requires a newer Sword library. Please "
+                     "update to \"Sword %s\".",
+                     newModule->name().toUtf8().constData(),
+                     newModule->minimumSwordVersion().getText());
             delete newModule;
         }
     }
+    updateModuleIndices();
 
     // Unlock modules if keys are present:
     Q_FOREACH(CSwordModuleInfo * mod, m_dataModel.moduleList()) {
@@ -198,8 +220,25 @@ void CSwordBackend::AddRenderFilters(sword::SWModule * module,
         module->addRenderFilter(&m_plainFilter);
 }
 
+void CSwordBackend::loadConfigDir(const char * ipath) {
+    QList<sword::SWConfig *> configs(BtModuleConfigCache::load(QFile::decodeName(ipath)));
+    if (configs.isEmpty()) {
+        // Let Sword handle unreadable and empty directories:
+        sword::SWMgr::loadConfigDir(ipath);
+        return;
+    }
+
+    if (!config)
+        config = myconfig = configs.takeFirst();
+    Q_FOREACH (sword::SWConfig * c, configs) {
+        *config += *c;
+        delete c;
+    }
+}
+
 void CSwordBackend::shutdownModules() {
     m_dataModel.clear(true);
+    updateModuleIndices();
     //BT  mods are deleted now, delete Sword mods, too.
     DeleteMods();
 
@@ -217,65 +256,222 @@ void CSwordBackend::shutdownModules() {
     cipherFilters.clear();
 }
 
-void CSwordBackend::setOption(const CSwordModuleInfo::FilterTypes type,
-                              const int state)
+namespace {
+
+/** The option values, see optionValue(). */
+const char * const onOffValues[] = { "Off", "On" };
+const char * const textualVariantValues[] = {
+    "Primary Reading",
+    "Secondary Reading",
+    "All Readings"
+};
+
+/** The options in the order of the FilterOptionsSnapshot entries. */
+const CSwordModuleInfo::FilterTypes snapshotTypes[] = {
+    CSwordModuleInfo::footnotes,
+    CSwordModuleInfo::strongNumbers,
+    CSwordModuleInfo::headings,
+    CSwordModuleInfo::morphTags,
+    CSwordModuleInfo::lemmas,
+    CSwordModuleInfo::hebrewPoints,
+    CSwordModuleInfo::hebrewCantillation,
+    CSwordModuleInfo::greekAccents,
+    CSwordModuleInfo::redLetterWords,
+    CSwordModuleInfo::textualVariants,
+    CSwordModuleInfo::morphSegmentation,
+    // CSwordModuleInfo::transliteration,
+    CSwordModuleInfo::scriptureReferences
+};
+
+inline const char * optionValue(const CSwordModuleInfo::FilterTypes type,
+                                const int state)
 {
     if (type == CSwordModuleInfo::textualVariants) {
-        switch (state) {
-        case 0:
-            setGlobalOption(optionName(type).toUtf8().constData(),
-                            "Primary Reading");
-            break;
-        case 1:
-            setGlobalOption(optionName(type).toUtf8().constData(),
-                            "Secondary Reading");
-            break;
-        default:
-            setGlobalOption(optionName(type).toUtf8().constData(),
-                            "All Readings");
-            break;
+        if (state == 0 || state == 1)
+            return textualVariantValues[state];
+        return textualVariantValues[2];
+    }
+    return onOffValues[state ? 1 : 0];
+}
+
+inline int optionState(const FilterOptions & options,
+                       const CSwordModuleInfo::FilterTypes type)
+{
+    switch (type) {
+        case CSwordModuleInfo::footnotes:           return options.footnotes;
+        case CSwordModuleInfo::strongNumbers:       return options.strongNumbers;
+        case CSwordModuleInfo::headings:            return options.headings;
+        case CSwordModuleInfo::morphTags:           return options.morphTags;
+        case CSwordModuleInfo::lemmas:              return options.lemmas;
+        case CSwordModuleInfo::hebrewPoints:        return options.hebrewPoints;
+        case CSwordModuleInfo::hebrewCantillation:  return options.hebrewCantillation;
+        case CSwordModuleInfo::greekAccents:        return options.greekAccents;
+        case CSwordModuleInfo::redLetterWords:      return options.redLetterWords;
+        case CSwordModuleInfo::textualVariants:     return options.textualVariants;
+        case CSwordModuleInfo::scriptureReferences: return options.scriptureReferences;
+        case CSwordModuleInfo::morphSegmentation:   return options.morphSegmentation;
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+const QList<sword::SWOptionFilter *> & CSwordBackend::optionFiltersForType(
+        const CSwordModuleInfo::FilterTypes type) const
+{
+    Q_ASSERT(m_optionFilters.contains(type));
+    return *m_optionFilters.constFind(type);
+}
+
+void CSwordBackend::updateOptionFilters() {
+    QMutexLocker lock(&m_filterOptionsMutex);
+    m_optionFilters.clear();
+    m_filterOptionsSnapshots.clear();
+    m_filterOptionsApplied = false;
+
+    for (int type = CSwordModuleInfo::filterTypesMIN;
+         type <= CSwordModuleInfo::filterTypesMAX;
+         type++)
+    {
+        // Same matching as sword::SWMgr::setGlobalOption():
+        const CSwordModuleInfo::FilterTypes filterType =
+                static_cast<CSwordModuleInfo::FilterTypes>(type);
+        const QByteArray name(optionName(filterType).toUtf8());
+        QList<sword::SWOptionFilter *> filters;
+        typedef sword::OptionFilterMap::const_iterator OFMCI;
+        for (OFMCI f = optionFilters.begin(); f != optionFilters.end(); ++f)
+            if (f->second->getOptionName()
+                && !sword::stricmp(name.constData(), f->second->getOptionName()))
+                filters.append(f->second);
+        m_optionFilters.insert(type, filters);
+    }
+}
+
+const CSwordBackend::FilterOptionsSnapshot & CSwordBackend::filterOptionsSnapshot(
+        const FilterOptions & options)
+{
+    const quint32 key = options.toBitmask();
+    QHash<quint32, FilterOptionsSnapshot>::const_iterator it =
+            m_filterOptionsSnapshots.constFind(key);
+    if (it != m_filterOptionsSnapshots.constEnd())
+        return *it;
+
+    FilterOptionsSnapshot snapshot;
+    for (size_t i = 0u; i < sizeof(snapshotTypes) / sizeof(snapshotTypes[0]); i++) {
+        const CSwordModuleInfo::FilterTypes type = snapshotTypes[i];
+        const char * const value = optionValue(type, optionState(options, type));
+        Q_FOREACH (sword::SWOptionFilter * filter, optionFiltersForType(type)) {
+            const OptionFilterState state = { filter, value };
+            snapshot.append(state);
         }
-    } else {
-        setGlobalOption(optionName(type).toUtf8().constData(),
-                        state ? "On" : "Off");
     }
+    return *m_filterOptionsSnapshots.insert(key, snapshot);
+}
+
+void CSwordBackend::setOption(const CSwordModuleInfo::FilterTypes type,
+                              const int state)
+{
+    QMutexLocker lock(&m_filterOptionsMutex);
+    const char * const value = optionValue(type, state);
+    Q_FOREACH (sword::SWOptionFilter * filter, optionFiltersForType(type))
+        filter->setOptionValue(value);
+
+    // The filters no longer match any snapshot:
+    m_filterOptionsApplied = false;
 }
 
 void CSwordBackend::setFilterOptions(const FilterOptions & options) {
-    setOption(CSwordModuleInfo::footnotes,           options.footnotes);
-    setOption(CSwordModuleInfo::strongNumbers,       options.strongNumbers);
-    setOption(CSwordModuleInfo::headings,            options.headings);
-    setOption(CSwordModuleInfo::morphTags,           options.morphTags);
-    setOption(CSwordModuleInfo::lemmas,              options.lemmas);
-    setOption(CSwordModuleInfo::hebrewPoints,        options.hebrewPoints);
-    setOption(CSwordModuleInfo::hebrewCantillation,  options.hebrewCantillation);
-    setOption(CSwordModuleInfo::greekAccents,        options.greekAccents);
-    setOption(CSwordModuleInfo::redLetterWords,      options.redLetterWords);
-    setOption(CSwordModuleInfo::textualVariants,     options.textualVariants);
-    setOption(CSwordModuleInfo::morphSegmentation,   options.morphSegmentation);
-    // setOption(CSwordModuleInfo::transliteration,   options.transliteration);
-    setOption(CSwordModuleInfo::scriptureReferences, options.scriptureReferences);
+    QMutexLocker lock(&m_filterOptionsMutex);
+    const quint32 key = options.toBitmask();
+    if (m_filterOptionsApplied && key == m_appliedFilterOptions)
+        return;
+
+    const FilterOptionsSnapshot & snapshot = filterOptionsSnapshot(options);
+    const FilterOptionsSnapshot * const applied = m_filterOptionsApplied
+            ? &*m_filterOptionsSnapshots.constFind(m_appliedFilterOptions)
+            : 0;
+
+    // All snapshots list the same filters in the same order:
+    for (int i = 0; i < snapshot.size(); i++) {
+        const OptionFilterState & state = snapshot.at(i);
+        if (!applied || applied->at(i).value != state.value)
+            state.filter->setOptionValue(state.value);
+    }
+
+    m_appliedFilterOptions = key;
+    m_filterOptionsApplied = true;
+}
+
+void CSwordBackend::updateModuleIndices() {
+    m_modulesByName.clear();
+    m_modulesBySwordModule.clear();
+    m_descriptionIndexValid = false;
+
+    const QList<CSwordModuleInfo *> & modules = m_dataModel.moduleList();
+    m_modulesByName.reserve(modules.size());
+    m_modulesBySwordModule.reserve(modules.size());
+
+    Q_FOREACH (CSwordModuleInfo * mod, modules) {
+        // The first module wins, like the linear searches did before:
+        const QString & name = mod->name();
+        if (!m_modulesByName.contains(name))
+            m_modulesByName.insert(name, mod);
+
+        m_modulesBySwordModule.insert(mod->module(), mod);
+    }
+}
+
+void CSwordBackend::updateDescriptionIndex() const {
+    if (m_descriptionIndexValid)
+        return;
+
+    m_modulesByDescription.clear();
+
+    const QList<CSwordModuleInfo *> & modules = m_dataModel.moduleList();
+    m_modulesByDescription.reserve(modules.size());
+    Q_FOREACH (CSwordModuleInfo * mod, modules) {
+        const QString description(mod->config(CSwordModuleInfo::Description));
+        if (!m_modulesByDescription.contains(description))
+            m_modulesByDescription.insert(description, mod);
+    }
+    m_descriptionIndexValid = true;
 }
 
 CSwordModuleInfo * CSwordBackend::findModuleByDescription(const QString & description) const {
-    Q_FOREACH (CSwordModuleInfo * mod, m_dataModel.moduleList())
-        if (mod->config(CSwordModuleInfo::Description) == description)
-            return mod;
-    return 0;
+    updateDescriptionIndex();
+    return m_modulesByDescription.value(description, 0);
+}
+
+bool CSwordBackend::isModuleHidden(const QString & name) const {
+    if (!m_hiddenModulesLoaded) {
+        m_hiddenModules = btConfig().value<QStringList>("state/hiddenModules",
+                                                        QStringList()).toSet();
+        m_hiddenModulesLoaded = true;
+    }
+    return m_hiddenModules.contains(name);
+}
+
+void CSwordBackend::setModuleHidden(const QString & name, bool hidden) {
+    if (isModuleHidden(name) == hidden)
+        return;
+
+    QStringList hiddenModules(btConfig().value<QStringList>("state/hiddenModules"));
+    if (hidden) {
+        m_hiddenModules.insert(name);
+        hiddenModules.append(name);
+    } else {
+        m_hiddenModules.remove(name);
+        hiddenModules.removeAll(name);
+    }
+    btConfig().setValue("state/hiddenModules", hiddenModules);
 }
 
 CSwordModuleInfo * CSwordBackend::findModuleByName(const QString & name) const {
-    Q_FOREACH (CSwordModuleInfo * mod, m_dataModel.moduleList())
-        if (mod->name() == name)
-            return mod;
-    return 0;
+    return m_modulesByName.value(name, 0);
 }
 
 CSwordModuleInfo * CSwordBackend::findSwordModuleByPointer(const sword::SWModule * const swmodule) const {
-    Q_FOREACH (CSwordModuleInfo * mod, m_dataModel.moduleList())
-        if (mod->module() == swmodule)
-            return mod;
-    return 0;
+    return m_modulesBySwordModule.value(swmodule, 0);
 }
 
 QString CSwordBackend::optionName(const CSwordModuleInfo::FilterTypes option) {
@@ -491,12 +687,18 @@ QStringList CSwordBackend::swordDirList() const {
 }
 
 void CSwordBackend::deleteOrphanedIndices() {
+    BtIndexCatalog & catalog = BtIndexCatalog::instance();
     const QStringList entries = QDir(CSwordModuleInfo::getGlobalBaseIndexLocation()).entryList(QDir::Dirs);
     Q_FOREACH(const QString & entry, entries) {
         if (entry == "." || entry == "..")
             continue;
         CSwordModuleInfo * const module = findModuleByName(entry);
         if (module) { //mod exists
+            // An index the catalog doesn't know about is probed as before:
+            BtIndexCatalog::Entry catalogEntry;
+            if (!catalog.entry(entry, catalogEntry))
+                catalog.addFromIndexDirectory(entry);
+
             if (!module->hasIndex()) { //index files found, but wrong version etc.
                 qDebug() << "deleting outdated index for module" << entry;
                 CSwordModuleInfo::deleteIndexForModule(entry);
@@ -508,4 +710,10 @@ void CSwordBackend::deleteOrphanedIndices() {
             }
         }
     }
+
+    // Forget about indices whose directories were removed behind our back:
+    const QSet<QString> directories = entries.toSet();
+    Q_FOREACH(const QString & name, catalog.moduleNames())
+        if (!directories.contains(name))
+            catalog.remove(name);
 }
@@ -12,9 +12,13 @@
 #ifndef CSWORDBACKEND_H
 #define CSWORDBACKEND_H
 
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/bookshelfmodel/btbookshelfmodel.h"
 #include "backend/filters/gbftohtml.h"
@@ -131,6 +135,17 @@ public: /* Methods: */
     */
     void setOption(const CSwordModuleInfo::FilterTypes type, const int state);
 
+    /**
+      \brief Brings the Sword option filters into the state for the given
+             options.
+
+      The filter states for each FilterOptions::toBitmask() value are computed
+      only once. Only the filters whose state differs from the currently
+      applied options are touched, so calling this with unchanged options
+      costs a single comparison.
+      \note The cached states are guarded by a mutex, since this is also
+            called from the indexing thread. Sword itself is not thread-safe.
+    */
     void setFilterOptions(const FilterOptions & options);
 
     /**
@@ -161,6 +176,18 @@ public: /* Methods: */
     */
     CSwordModuleInfo * findSwordModuleByPointer(const sword::SWModule * const swmodule) const;
 
+    /**
+      \returns whether the module with the given name is hidden. The list of
+               hidden modules is read from the configuration once.
+    */
+    bool isModuleHidden(const QString & name) const;
+
+    /**
+      \brief Shows or hides the module with the given name.
+      \note This does not emit CSwordModuleInfo::hiddenChanged().
+    */
+    void setModuleHidden(const QString & name, bool hidden);
+
     /**
       \returns The global config object containing the configs of all modules
                merged together.
@@ -242,6 +269,12 @@ protected: /* Methods: */
     void AddRenderFilters(sword::SWModule * module,
                           sword::ConfigEntMap & section);
 
+    /**
+      Reimplemented from sword::SWMgr to read the configuration files through
+      BtModuleConfigCache.
+    */
+    void loadConfigDir(const char * ipath);
+
     /** Overrides Sword filters which appear to be buggy. */
     void filterInit();
 
@@ -249,6 +282,51 @@ protected: /* Methods: */
     QString getPrivateSwordConfigPath() const;
     QString getPrivateSwordConfigFile() const;
 
+private: /* Types: */
+
+    struct OptionFilterState {
+        sword::SWOptionFilter * filter;
+        const char * value;
+    };
+    typedef QVector<OptionFilterState> FilterOptionsSnapshot;
+
+private: /* Methods: */
+
+    /**
+      \returns the prepared option filter states for the given options.
+    */
+    const FilterOptionsSnapshot & filterOptionsSnapshot(
+            const FilterOptions & options);
+
+    /**
+      \returns the option filters which implement the given option.
+    */
+    const QList<sword::SWOptionFilter *> & optionFiltersForType(
+            const CSwordModuleInfo::FilterTypes type) const;
+
+    /**
+      \brief Looks up the option filters of all options.
+      \note Called on construction and by initModules(), so the lookup table
+            is never written while the filters are used.
+    */
+    void updateOptionFilters();
+
+    /**
+      \brief Rebuilds the lookup tables of the find*() methods.
+      \note Must be called whenever modules are added to or removed from
+            m_dataModel.
+    */
+    void updateModuleIndices();
+
+    /**
+      \brief Builds the lookup table of findModuleByDescription(), if it is
+             outdated.
+
+      This is done on first use instead of in updateModuleIndices(), so that
+      the configuration of the modules is not read unless it is needed.
+    */
+    void updateDescriptionIndex() const;
+
 private: /* Fields: */
 
     // Filters:
@@ -265,6 +343,27 @@ private: /* Fields: */
 
     BtBookshelfModel m_dataModel;
 
+    // Lookup tables for m_dataModel, see updateModuleIndices():
+    QHash<QString, CSwordModuleInfo *> m_modulesByName;
+    QHash<const sword::SWModule *, CSwordModuleInfo *> m_modulesBySwordModule;
+
+    // Lookup table for m_dataModel, see updateDescriptionIndex():
+    mutable QHash<QString, CSwordModuleInfo *> m_modulesByDescription;
+    mutable bool m_descriptionIndexValid;
+
+    // Names of the hidden modules, see isModuleHidden():
+    mutable QSet<QString> m_hiddenModules;
+    mutable bool m_hiddenModulesLoaded;
+
+    // Option filters, see updateOptionFilters():
+    QHash<int, QList<sword::SWOptionFilter *> > m_optionFilters;
+
+    // Filter option states, see setFilterOptions():
+    QMutex m_filterOptionsMutex;
+    QHash<quint32, FilterOptionsSnapshot> m_filterOptionsSnapshots;
+    quint32 m_appliedFilterOptions;
+    bool m_filterOptionsApplied;
+
     static CSwordBackend * m_instance;
 
 };
@@ -9,14 +9,224 @@
 
 #include "backend/managers/referencemanager.h"
 
-#include <algorithm>
-#include <QRegExp>
+#include <QCache>
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
 #include "backend/config/btconfig.h"
 #include "backend/keys/cswordversekey.h"
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/managers/cswordbackend.h"
 
+// Sword includes:
+#include <listkey.h>
+#include <localemgr.h>
+#include <swlocale.h>
+#include <versekey.h>
+#include <versificationmgr.h>
+
+
+namespace {
+
+/**
+  \brief Book names and abbreviations of a Sword locale.
+
+  The names are kept in a trie of their upper case UTF-8 bytes. Like Sword,
+  a name given by the user matches the first book in sorted order which has
+  a name or abbreviation starting with it. Only books of the default
+  versification are considered.
+*/
+class BookNameTrie {
+
+public: /* Methods: */
+
+    BookNameTrie(const QByteArray & localeName);
+
+    /**
+      \returns the absolute number of the book with the given name or
+               abbreviation or -1 if it is not known.
+    */
+    int find(const QString & name) const;
+
+private: /* Types: */
+
+    struct Node {
+        QByteArray labels;
+        QVector<int> children;
+        int book;
+
+        inline Node() : book(-1) {}
+    };
+
+private: /* Methods: */
+
+    int findBytes(const QByteArray & name) const;
+
+private: /* Fields: */
+
+    QVector<Node> m_nodes;
+
+};
+
+BookNameTrie::BookNameTrie(const QByteArray & localeName)
+    : m_nodes(1)
+{
+    sword::SWLocale * const locale =
+            sword::LocaleMgr::getSystemLocaleMgr()->getLocale(localeName.constData());
+    if (locale == 0)
+        return;
+
+    const sword::VerseKey vk;
+    const sword::VersificationMgr::System * const v11n =
+            sword::VersificationMgr::getSystemVersificationMgr()->getVersificationSystem(vk.getVersificationSystem());
+    if (v11n == 0)
+        return;
+
+    // The abbreviations come sorted, so the first book stored in a node wins:
+    int count = 0;
+    const struct sword::abbrev * const abbrevs = locale->getBookAbbrevs(&count);
+    for (int i = 0; i < count; i++) {
+        const int book = v11n->getBookNumberByOSISName(abbrevs[i].osis);
+        if (book < 1)
+            continue;
+
+        int node = 0;
+        for (const char * c = abbrevs[i].ab; *c != '\0'; c++) {
+            const int label = m_nodes.at(node).labels.indexOf(*c);
+            if (label >= 0) {
+                node = m_nodes.at(node).children.at(label);
+            } else {
+                const int child = m_nodes.size();
+                m_nodes.append(Node());
+                m_nodes[node].labels.append(*c);
+                m_nodes[node].children.append(child);
+                node = child;
+            }
+
+            if (m_nodes.at(node).book < 0)
+                m_nodes[node].book = book;
+        }
+    }
+}
+
+int BookNameTrie::findBytes(const QByteArray & name) const {
+    int node = 0;
+    for (int i = 0; i < name.size(); i++) {
+        const int label = m_nodes.at(node).labels.indexOf(name.at(i));
+        if (label < 0)
+            return -1;
+        node = m_nodes.at(node).children.at(label);
+    }
+    return (node == 0) ? -1 : m_nodes.at(node).book;
+}
+
+int BookNameTrie::find(const QString & name) const {
+    // Like Sword try the upper case name first:
+    const int book = findBytes(name.toUpper().toUtf8());
+    return (book >= 0) ? book : findBytes(name.toUtf8());
+}
+
+QMutex localesMutex;
+QSet<QString> availableLocales;
+bool haveAvailableLocales = false;
+QHash<QString, QSharedPointer<const BookNameTrie> > bookNameTries;
+
+QMutex parseCacheMutex;
+QCache<QString, QString> parseCache(1000);
+
+bool isAvailableLocale(const QString & name) {
+    QMutexLocker locker(&localesMutex);
+    if (!haveAvailableLocales) {
+        const sword::StringList locales = sword::LocaleMgr::getSystemLocaleMgr()->getAvailableLocales();
+        for (sword::StringList::const_iterator it = locales.begin(); it != locales.end(); ++it)
+            availableLocales.insert(QString::fromUtf8(it->c_str()));
+        haveAvailableLocales = true;
+    }
+    return availableLocales.contains(name);
+}
+
+QSharedPointer<const BookNameTrie> bookNameTrie(const QString & localeName) {
+    QMutexLocker locker(&localesMutex);
+    QSharedPointer<const BookNameTrie> & trie = bookNameTries[localeName];
+    if (!trie)
+        trie = QSharedPointer<const BookNameTrie>(new BookNameTrie(localeName.toUtf8()));
+    return trie;
+}
+
+/** Positions the key at the given verse of the given absolute book number. */
+void setVerse(sword::VerseKey & key, int book, int chapter, int verse) {
+    const int otBooks = key.BMAX[0];
+    key.setTestament((book > otBooks) ? 2 : 1);
+    key.setBook((book > otBooks) ? (book - otBooks) : book);
+    key.setChapter(chapter);
+    key.setVerse(verse);
+}
+
+/**
+  Parses the simple and by far most common forms of references, "Book C:V",
+  "Book C:V-V" and "Book C:V-C:V", without Sword's generic parser.
+  \returns false if the reference is not of one of these forms or not valid,
+           in which case nothing was appended to \a out.
+*/
+bool parseSimpleReference(const QString & ref,
+                          const BookNameTrie & bookNames,
+                          const QByteArray & destinationLocale,
+                          QString & out)
+{
+    QRegExp rx("^\\s*([^:;,.\\-]*[^\\d\\s:;,.\\-])\\s*(\\d+):(\\d+)(?:\\s*-\\s*(?:(\\d+):)?(\\d+))?\\s*$");
+    if (!rx.exactMatch(ref))
+        return false;
+
+    const int book = bookNames.find(rx.cap(1).simplified());
+    if (book < 1)
+        return false;
+
+    const int chapter = rx.cap(2).toInt();
+    const int verse = rx.cap(3).toInt();
+    const int endChapter = rx.cap(4).isEmpty() ? chapter : rx.cap(4).toInt();
+    const int endVerse = rx.cap(5).isEmpty() ? verse : rx.cap(5).toInt();
+
+    sword::VerseKey lower;
+    lower.setLocale(destinationLocale.constData());
+
+    const sword::VersificationMgr::System * const v11n =
+            sword::VersificationMgr::getSystemVersificationMgr()->getVersificationSystem(lower.getVersificationSystem());
+    const sword::VersificationMgr::Book * const b = v11n ? v11n->getBook(book - 1) : 0;
+
+    // Leave everything Sword would have to normalize to Sword:
+    if (b == 0
+        || chapter < 1 || verse < 1
+        || endChapter > b->getChapterMax()
+        || endChapter < chapter
+        || (endChapter == chapter && endVerse < verse)
+        || verse > b->getVerseMax(chapter)
+        || endVerse > b->getVerseMax(endChapter))
+        return false;
+
+    setVerse(lower, book, chapter, verse);
+    if (endChapter == chapter && endVerse == verse) {
+        out.append(QString::fromUtf8(lower.getText())).append("; ");
+        return true;
+    }
+
+    sword::VerseKey upper;
+    upper.setLocale(destinationLocale.constData());
+    setVerse(upper, book, endChapter, endVerse);
+
+    sword::VerseKey range;
+    range.setLocale(destinationLocale.constData());
+    range.setLowerBound(lower);
+    range.setUpperBound(upper);
+    out.append(QString::fromUtf8(range.getRangeText())).append("; ");
+    return true;
+}
+
+} // anonymous namespace
 
 /** Returns a hyperlink used to be imbedded in the display windows. At the moment the format is sword://module/key */
 const QString ReferenceManager::encodeHyperlink( const QString moduleName, const QString key, const ReferenceManager::Type type) {
@@ -320,37 +530,59 @@ const QString ReferenceManager::parseVerseReference( const QString& ref, const R
     QString sourceLanguage = options.sourceLanguage;
     QString destinationLanguage = options.destinationLanguage;
 
-    sword::StringList locales = sword::LocaleMgr::getSystemLocaleMgr()->getAvailableLocales();
-    if (/*options.sourceLanguage == "en" ||*/ std::find(locales.begin(), locales.end(), sourceLanguage.toUtf8().constData()) == locales.end()) { //sourceLanguage not available
+    if (!isAvailableLocale(sourceLanguage)) { //sourceLanguage not available
         sourceLanguage = "en_US";
     }
 
-    if (/*options.destinationLanguage == "en" ||*/ std::find(locales.begin(), locales.end(), sourceLanguage.toUtf8().constData()) == locales.end()) { //destination not available
+    if (!isAvailableLocale(destinationLanguage)) { //destination not available
         destinationLanguage = "en_US";
     }
 
+    const QString cacheKey = QString(sourceLanguage).append('\x1f')
+                             .append(destinationLanguage).append('\x1f')
+                             .append(options.refBase).append('\x1f')
+                             .append(ref);
+    {
+        QMutexLocker locker(&parseCacheMutex);
+        if (const QString * const cached = parseCache.object(cacheKey))
+            return *cached;
+    }
+
+    const QByteArray sourceLocale(sourceLanguage.toUtf8());
+    const QByteArray destinationLocale(destinationLanguage.toUtf8());
+    const QSharedPointer<const BookNameTrie> bookNames(bookNameTrie(sourceLanguage));
+
     QString ret;
     QStringList refList = ref.split(";");
 
-    CSwordVerseKey baseKey(0);
-    baseKey.setLocale( sourceLanguage.toUtf8().constData() );
-    baseKey.setKey(options.refBase); //probably in the sourceLanguage
-    baseKey.setLocale( "en_US" ); //english works in all environments as base
-
-//     CSwordVerseKey dummy(0);
-    //HACK: We have to workaround a Sword bug, we have to set the default locale to the same as the sourceLanguage !
-    const QString oldLocaleName = CSwordBackend::instance()->booknameLanguage();
-    CSwordBackend::instance()->booknameLanguage(sourceLanguage);
+    /* The base key is only needed by Sword for references which are not
+       handled by the fast path below, so it is created on demand: */
+    QByteArray baseKeyText;
+    bool haveBaseKey = false;
 
+    /* Sword looks the book names up in the locale of the key, so there is no
+       need to change the global bookname locale for parsing: */
     sword::VerseKey dummy;
-    dummy.setLocale( sourceLanguage.toUtf8().constData() );
-    Q_ASSERT( !strcmp(dummy.getLocale(), sourceLanguage.toUtf8().constData()) );
+    dummy.setLocale( sourceLocale.constData() );
+    Q_ASSERT( !strcmp(dummy.getLocale(), sourceLocale.constData()) );
 
 //     qDebug("Parsing '%s' in '%s' using '%s' as base, source lang '%s', dest lang '%s'", ref.latin1(), options.refDestinationModule.latin1(), baseKey.key().latin1(), sourceLanguage.latin1(), destinationLanguage.latin1());
 
     for (QStringList::iterator it = refList.begin(); it != refList.end(); ++it) {
+        if (parseSimpleReference(*it, *bookNames, destinationLocale, ret))
+            continue;
+
+        if (!haveBaseKey) {
+            CSwordVerseKey baseKey(0);
+            baseKey.setLocale( sourceLocale.constData() );
+            baseKey.setKey(options.refBase); //probably in the sourceLanguage
+            baseKey.setLocale( "en_US" ); //english works in all environments as base
+            baseKeyText = baseKey.key().toUtf8();
+            haveBaseKey = true;
+        }
+
         //The listkey may contain more than one item, because a ref lik "Gen 1:3,5" is parsed into two single refs
-        sword::ListKey lk = dummy.parseVerseList((*it).toUtf8().constData(), baseKey.key().toUtf8().constData(), true);
+        sword::ListKey lk = dummy.parseVerseList((*it).toUtf8().constData(), baseKeyText.constData(), true);
         Q_ASSERT(!dummy.popError());
 
         //Q_ASSERT(lk.Count());
@@ -363,15 +595,15 @@ const QString ReferenceManager::parseVerseReference( const QString& ref, const R
             if (dynamic_cast<sword::VerseKey*>(lk.getElement(i))) { // a range
                 sword::VerseKey* k = dynamic_cast<sword::VerseKey*>(lk.getElement(i));
                 Q_ASSERT(k);
-                k->setLocale( destinationLanguage.toUtf8().constData() );
+                k->setLocale( destinationLocale.constData() );
 
                 ret.append( QString::fromUtf8(k->getRangeText()) ).append("; ");
             }
             else { // a single ref
                 sword::VerseKey vk;
-                vk.setLocale( sourceLanguage.toUtf8().constData() );
+                vk.setLocale( sourceLocale.constData() );
                 vk = lk.getElement(i)->getText();
-                vk.setLocale( destinationLanguage.toUtf8().constData() );
+                vk.setLocale( destinationLocale.constData() );
 
                 ret.append( QString::fromUtf8(vk.getText()) ).append("; ");
             }
@@ -379,6 +611,7 @@ const QString ReferenceManager::parseVerseReference( const QString& ref, const R
 
     }
 
-    CSwordBackend::instance()->booknameLanguage(oldLocaleName);
+    QMutexLocker locker(&parseCacheMutex);
+    parseCache.insert(cacheKey, new QString(ret));
     return ret;
 }
@@ -86,6 +86,11 @@ struct ParseOptions {
 * @param ref The verse reference.
 * @param lang The language of the verse reference
 * @param newLang The language of the reference, which will be returned. For example: If BibleTime using an english environment parses a spanish ref (lang=es) the returned ref should be in english (newLang=en), because his english standard module only understands en.
+*
+* The global bookname language is left untouched and the results are cached.
+* Only the cache and the book name tables are protected by mutexes. The
+* parsing itself uses the locales and keys of Sword, which are not
+* thread-safe, so this must not be called from several threads at once.
 */
 const QString parseVerseReference( const QString& ref, const ParseOptions& options);
 
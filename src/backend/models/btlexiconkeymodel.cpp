@@ -0,0 +1,176 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License
+* version 2.0.
+*
+**********/
+
+#include "backend/models/btlexiconkeymodel.h"
+
+#include "backend/drivers/btlexiconkeyindex.h"
+#include "backend/drivers/cswordlexiconmoduleinfo.h"
+
+
+BtLexiconKeyModel::BtLexiconKeyModel(QObject * parent)
+    : QAbstractListModel(parent)
+{
+    // Intentionally empty
+}
+
+void BtLexiconKeyModel::setModules(
+        const QList<const CSwordLexiconModuleInfo *> & modules,
+        MergeMode mode)
+{
+    beginResetModel();
+
+    m_indexes.clear();
+    m_keys.clear();
+    Q_FOREACH (const CSwordLexiconModuleInfo * m, modules)
+        m_indexes.append(&m->keyIndex());
+
+    if (m_indexes.count() > 1)
+        merge(mode);
+
+    endResetModel();
+}
+
+inline const char * BtLexiconKeyModel::keyData(const KeyRef & ref,
+                                               int & size) const
+{
+    return m_indexes.at(ref.index)->keyData(ref.key, size);
+}
+
+void BtLexiconKeyModel::merge(MergeMode mode) {
+    const int count = m_indexes.count();
+
+    /* The current position of every index in its sorted order. For the
+       intersection we can stop as soon as any of the indexes is exhausted. */
+    QVector<int> positions(count, 0);
+    int largest = 0;
+    Q_FOREACH (const BtLexiconKeyIndex * index, m_indexes)
+        largest = qMax(largest, index->count());
+    m_keys.reserve(largest);
+
+    for (;;) {
+        // Find the smallest key at the current positions:
+        KeyRef smallest = { -1, -1 };
+        const char * smallestData = 0;
+        int smallestSize = 0;
+        int exhausted = 0;
+        for (int i = 0; i < count; i++) {
+            const BtLexiconKeyIndex * const index = m_indexes.at(i);
+            if (positions[i] >= index->count()) {
+                exhausted++;
+                continue;
+            }
+
+            int size;
+            const int key = index->sortedIndex(positions[i]);
+            const char * const data = index->keyData(key, size);
+            if (smallestData == 0
+                || BtLexiconKeyIndex::compare(data, size,
+                                              smallestData, smallestSize) < 0)
+            {
+                smallest.index = i;
+                smallest.key = key;
+                smallestData = data;
+                smallestSize = size;
+            }
+        }
+
+        if (smallestData == 0 || (mode == Intersection && exhausted > 0))
+            break;
+
+        // Advance all indexes past the smallest key, skipping duplicates:
+        int found = 0;
+        for (int i = 0; i < count; i++) {
+            const BtLexiconKeyIndex * const index = m_indexes.at(i);
+            bool contains = false;
+            while (positions[i] < index->count()) {
+                int size;
+                const char * const data =
+                        index->keyData(index->sortedIndex(positions[i]), size);
+                if (BtLexiconKeyIndex::compare(data, size,
+                                               smallestData, smallestSize) != 0)
+                    break;
+                contains = true;
+                positions[i]++;
+            }
+            if (contains)
+                found++;
+        }
+
+        if (mode == Union || found == count)
+            m_keys.append(smallest);
+    }
+
+    m_keys.squeeze();
+}
+
+int BtLexiconKeyModel::rowCount(const QModelIndex & parent) const {
+    if (parent.isValid())
+        return 0;
+
+    if (m_indexes.count() == 1)
+        return m_indexes.first()->count();
+
+    return m_keys.count();
+}
+
+QVariant BtLexiconKeyModel::data(const QModelIndex & index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+        return key(index.row());
+
+    return QVariant();
+}
+
+QString BtLexiconKeyModel::key(int row) const {
+    if (m_indexes.count() == 1)
+        return m_indexes.first()->key(row);
+
+    int size;
+    const char * const data = keyData(m_keys.at(row), size);
+    return QString::fromUtf8(data, size);
+}
+
+int BtLexiconKeyModel::indexOf(const QString & key) const {
+    if (m_indexes.isEmpty())
+        return -1;
+
+    if (m_indexes.count() == 1)
+        return m_indexes.first()->indexOf(key);
+
+    // The merged keys are sorted, so use a binary search:
+    const QByteArray utf8 = key.toUtf8();
+    int first = 0;
+    int length = m_keys.count();
+    while (length > 0) {
+        const int half = length / 2;
+        int size;
+        const char * const data = keyData(m_keys.at(first + half), size);
+        if (BtLexiconKeyIndex::compare(data, size,
+                                       utf8.constData(), utf8.size()) < 0)
+        {
+            first += half + 1;
+            length -= half + 1;
+        } else {
+            length = half;
+        }
+    }
+
+    if (first >= m_keys.count())
+        return -1;
+
+    int size;
+    const char * const data = keyData(m_keys.at(first), size);
+    return (BtLexiconKeyIndex::compare(data, size,
+                                       utf8.constData(), utf8.size()) == 0)
+           ? first
+           : -1;
+}
@@ -0,0 +1,86 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License
+* version 2.0.
+*
+**********/
+
+#ifndef BTLEXICONKEYMODEL_H
+#define BTLEXICONKEYMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QVector>
+
+
+class BtLexiconKeyIndex;
+class CSwordLexiconModuleInfo;
+
+/**
+    \brief List model of the keys of one or more lexicon modules.
+
+    For a single module the rows are the keys of the module in module order
+    and map directly to its key index. For several modules the key indexes are
+    merged once in their sorted order into a list of references to the keys,
+    either as the union or as the intersection of the keys of all modules.
+    In both cases a key is only converted to a QString when a view asks for
+    its row.
+ */
+class BtLexiconKeyModel: public QAbstractListModel {
+
+    Q_OBJECT
+
+public: /* Types: */
+
+    enum MergeMode {
+        Union,
+        Intersection
+    };
+
+public: /* Methods: */
+
+    BtLexiconKeyModel(QObject * parent = 0);
+
+    /** Resets the model to the keys of the given modules. */
+    void setModules(const QList<const CSwordLexiconModuleInfo *> & modules,
+                    MergeMode mode = Union);
+
+    virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
+
+    virtual QVariant data(const QModelIndex & index,
+                          int role = Qt::DisplayRole) const;
+
+    /** \returns the key of the given row. */
+    QString key(int row) const;
+
+    /** \returns the row of the given key or -1 if it is not in the model. */
+    int indexOf(const QString & key) const;
+
+private: /* Types: */
+
+    struct KeyRef {
+        int index;  ///< Position in m_indexes
+        int key;    ///< Index of the key in module order
+    };
+
+private: /* Methods: */
+
+    void merge(MergeMode mode);
+
+    inline const char * keyData(const KeyRef & ref, int & size) const;
+
+private: /* Fields: */
+
+    QList<const BtLexiconKeyIndex *> m_indexes;
+
+    /** The merged keys, empty unless there are several modules. */
+    QVector<KeyRef> m_keys;
+
+};
+
+#endif
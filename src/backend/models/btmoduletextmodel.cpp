@@ -12,6 +12,8 @@
 
 #include "btmoduletextmodel.h"
 
+#include <QTimer>
+
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/drivers/cswordbiblemoduleinfo.h"
 #include "backend/drivers/cswordbookmoduleinfo.h"
@@ -23,27 +25,51 @@
 #include "backend/rendering/ctextrendering.h"
 
 
+namespace {
+
+/** Number of rendered rows kept by each model. */
+const int ROW_CACHE_SIZE = 200;
+/** Number of rows rendered ahead in the scroll direction. */
+const int PREFETCH_ROWS = 30;
+/** Number of rows rendered per event loop iteration while prefetching. */
+const int PREFETCH_BATCH = 3;
+
+} // anonymous namespace
+
 // Static so all models use the same colors
 static QColor s_linkColor = QColor(0,191,255);
 static QColor s_highlightColor = QColor(255,255,0);
 static QColor s_jesusWordsColor = QColor(255,0,0);
+// Changed with the colors, so the models know when to recolor their rows
+static int s_colorGeneration = 0;
 
 /*static*/ void BtModuleTextModel::setLinkColor(const QColor& color) {
     s_linkColor = color;
+    ++s_colorGeneration;
 }
 
 /*static*/ void BtModuleTextModel::setHighlightColor(const QColor& color) {
     s_highlightColor = color;
+    ++s_colorGeneration;
 }
 
 /*static*/ void BtModuleTextModel::setJesusWordsColor(const QColor& color) {
     s_jesusWordsColor = color;
+    ++s_colorGeneration;
 }
 
 
 
 BtModuleTextModel::BtModuleTextModel(QObject *parent)
-    : QAbstractListModel(parent), m_firstEntry(0), m_maxEntries(0) {
+    : QAbstractListModel(parent), m_firstEntry(0), m_maxEntries(0),
+      m_rowCache(ROW_CACHE_SIZE), m_displayCache(ROW_CACHE_SIZE),
+      m_colorGeneration(s_colorGeneration), m_lastRow(0), m_prefetchRow(0),
+      m_prefetchDirection(1), m_prefetchRemaining(0),
+      m_prefetchTimer(new QTimer(this)) {
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(0);
+    bool ok = connect(m_prefetchTimer, SIGNAL(timeout()), this, SLOT(prefetchRows()));
+    Q_ASSERT(ok);
     QHash<int, QByteArray> roleNames;
     roleNames[ModuleEntry::ReferenceRole] =  "keyName";
     roleNames[ModuleEntry::TextRole] = "line";
@@ -67,6 +93,7 @@ BtModuleTextModel::BtModuleTextModel(QObject *parent)
 
 void BtModuleTextModel::setModules(const QStringList& modules) {
     beginResetModel();
+    clearCaches();
 
     m_moduleInfoList.clear();
     for (int i = 0; i < modules.count(); ++i) {
@@ -87,7 +114,7 @@ void BtModuleTextModel::setModules(const QStringList& modules) {
     else if(isLexicon())
     {
         const CSwordLexiconModuleInfo *lm = qobject_cast<const CSwordLexiconModuleInfo*>(firstModule);
-        m_maxEntries = lm->entries().size();
+        m_maxEntries = lm->keyIndex().count();
     }
 
     else if(isBook())
@@ -106,77 +133,127 @@ void BtModuleTextModel::setModules(const QStringList& modules) {
 
 QVariant BtModuleTextModel::data(const QModelIndex & index, int role) const {
 
+    if (!isBible() && !isCommentary() && !isBook() && !isLexicon())
+        return QVariant("invalid");
+
+    if (role == ModuleEntry::TextRole)
+        return displayText(index.row());
+    if (role == ModuleEntry::ReferenceRole && isLexicon())
+        return indexToKeyName(index.row());
+    return QString();
+}
+
+QString BtModuleTextModel::displayText(int row) const {
+    // The colors are shared by all models, check whether they were changed:
+    if (m_colorGeneration != s_colorGeneration) {
+        m_displayCache.clear();
+        m_colorGeneration = s_colorGeneration;
+    }
+
+    schedulePrefetch(row);
+
+    if (const QString * const cached = m_displayCache.object(row))
+        return *cached;
+
+    QString text = replaceColors(rowText(row));
+    text = CSwordModuleSearch::highlightSearchedText(text, m_highlightWords);
+    m_displayCache.insert(row, new QString(text));
+    return text;
+}
+
+QString BtModuleTextModel::rowText(int row) const {
+    if (const QString * const cached = m_rowCache.object(row))
+        return *cached;
+
+    QString text;
     if (isBible() || isCommentary())
-        return verseData(index, role);
+        text = verseText(row);
     else if (isBook())
-        return bookData(index, role);
+        text = bookText(row);
     else if (isLexicon())
-        return lexiconData(index, role);
-    return QVariant("invalid");
+        text = lexiconText(row);
+    m_rowCache.insert(row, new QString(text));
+    return text;
 }
 
-QVariant BtModuleTextModel::lexiconData(const QModelIndex & index, int role) const {
-    int row = index.row();
+void BtModuleTextModel::schedulePrefetch(int row) const {
+    if (row == m_lastRow && m_prefetchRemaining > 0)
+        return;
+
+    m_prefetchDirection = (row >= m_lastRow) ? 1 : -1;
+    m_lastRow = row;
+    m_prefetchRow = row + m_prefetchDirection;
+    m_prefetchRemaining = PREFETCH_ROWS;
+    m_prefetchTimer->start();
+}
 
+void BtModuleTextModel::prefetchRows() {
+    // Only a few rows at a time, so the user interface stays responsive:
+    for (int i = 0; i < PREFETCH_BATCH && m_prefetchRemaining > 0; ++i) {
+        if (m_prefetchRow < 0 || m_prefetchRow >= m_maxEntries) {
+            m_prefetchRemaining = 0;
+            break;
+        }
+        if (!m_rowCache.contains(m_prefetchRow))
+            rowText(m_prefetchRow);
+        m_prefetchRow += m_prefetchDirection;
+        --m_prefetchRemaining;
+    }
+    if (m_prefetchRemaining > 0)
+        m_prefetchTimer->start();
+}
+
+void BtModuleTextModel::clearCaches() {
+    m_prefetchTimer->stop();
+    m_prefetchRemaining = 0;
+    m_rowCache.clear();
+    m_displayCache.clear();
+}
+
+QString BtModuleTextModel::lexiconText(int row) const {
     const CSwordLexiconModuleInfo *lexiconModule = qobject_cast<const CSwordLexiconModuleInfo*>(m_moduleInfoList.at(0));
     QList<const CSwordModuleInfo*> moduleList;
     moduleList << lexiconModule;
-    QString keyName = lexiconModule->entries()[row];
-
-    if (role == ModuleEntry::TextRole) {
-        Rendering::CEntryDisplay entryDisplay;
-        QString text = entryDisplay.text(moduleList, keyName,
-            m_displayOptions, m_filterOptions);
-        text.replace("#CHAPTERTITLE#", "");
-        text = replaceColors(text);
-        return CSwordModuleSearch::highlightSearchedText(text, m_highlightWords);
-    }
-    else if (role == ModuleEntry::ReferenceRole){
-        return keyName;
-    }
-    return QString();
+    QString keyName = lexiconModule->keyIndex().key(row);
+
+    Rendering::CEntryDisplay entryDisplay;
+    QString text = entryDisplay.text(moduleList, keyName,
+        m_displayOptions, m_filterOptions);
+    text.replace("#CHAPTERTITLE#", "");
+    return text;
 }
 
-QVariant BtModuleTextModel::bookData(const QModelIndex & index, int role) const {
-    if (role == ModuleEntry::TextRole) {
-        const CSwordBookModuleInfo *bookModule = qobject_cast<const CSwordBookModuleInfo*>(m_moduleInfoList.at(0));
-        CSwordTreeKey key(bookModule->tree(), bookModule);
-        int bookIndex = index.row() * 4;
-        key.setIndex(bookIndex);
-        Rendering::CEntryDisplay entryDisplay;
-        QList<const CSwordModuleInfo*> moduleList;
-        moduleList << bookModule;
-        QString text = entryDisplay.textKeyRendering(moduleList, key.key(),
-                                                     m_displayOptions, m_filterOptions,
-                                                     Rendering::CTextRendering::KeyTreeItem::Settings::SimpleKey);
-        text.replace("#CHAPTERTITLE#", "");
-        return CSwordModuleSearch::highlightSearchedText(text, m_highlightWords);
-        return text;
-    }
-    return QString();
+QString BtModuleTextModel::bookText(int row) const {
+    const CSwordBookModuleInfo *bookModule = qobject_cast<const CSwordBookModuleInfo*>(m_moduleInfoList.at(0));
+    CSwordTreeKey key(bookModule->tree(), bookModule);
+    int bookIndex = row * 4;
+    key.setIndex(bookIndex);
+    Rendering::CEntryDisplay entryDisplay;
+    QList<const CSwordModuleInfo*> moduleList;
+    moduleList << bookModule;
+    QString text = entryDisplay.textKeyRendering(moduleList, key.key(),
+                                                 m_displayOptions, m_filterOptions,
+                                                 Rendering::CTextRendering::KeyTreeItem::Settings::SimpleKey);
+    text.replace("#CHAPTERTITLE#", "");
+    return text;
 }
 
-QVariant BtModuleTextModel::verseData(const QModelIndex & index, int role) const {
-    int row = index.row();
+QString BtModuleTextModel::verseText(int row) const {
     CSwordVerseKey key = indexToVerseKey(row);
     int verse = key.getVerse();
-    if (role == ModuleEntry::TextRole) {
-        if (verse == 0)
-            return QString();
-        QString text;
-
-        QString chapterTitle;
-        if (verse == 1)
-            chapterTitle = key.book() + " " + QString::number(key.getChapter());
-
-        text += Rendering::CEntryDisplay().textKeyRendering(m_moduleInfoList,
-            key.key(), m_displayOptions, m_filterOptions,
-            Rendering::CTextRendering::KeyTreeItem::Settings::SimpleKey);
-        text.replace("#CHAPTERTITLE#", chapterTitle);
-        text = replaceColors(text);
-        return CSwordModuleSearch::highlightSearchedText(text, m_highlightWords);
-    }
-    return QString();
+    if (verse == 0)
+        return QString();
+    QString text;
+
+    QString chapterTitle;
+    if (verse == 1)
+        chapterTitle = key.book() + " " + QString::number(key.getChapter());
+
+    text += Rendering::CEntryDisplay().textKeyRendering(m_moduleInfoList,
+        key.key(), m_displayOptions, m_filterOptions,
+        Rendering::CTextRendering::KeyTreeItem::Settings::SimpleKey);
+    text.replace("#CHAPTERTITLE#", chapterTitle);
+    return text;
 }
 
 QString BtModuleTextModel::replaceColors(const QString& text) const {
@@ -268,14 +345,16 @@ QString BtModuleTextModel::indexToKeyName(int index) const {
     }
     else if (isLexicon()) {
         const CSwordLexiconModuleInfo *lexiconModule = qobject_cast<const CSwordLexiconModuleInfo*>(m_moduleInfoList.at(0));
-        keyName = lexiconModule->entries()[index];
+        keyName = lexiconModule->keyIndex().key(index);
     }
     return keyName;
 }
 
 void BtModuleTextModel::setHighlightWords(const QString& highlightWords) {
-    beginResetModel();
+    // The rendered rows stay valid, only the highlighting has to be redone:
     m_highlightWords = highlightWords;
-    endResetModel();
+    m_displayCache.clear();
+    if (m_maxEntries > 0)
+        emit dataChanged(index(0), index(m_maxEntries - 1));
 }
 
@@ -14,6 +14,7 @@
 #define BTMODULETEXTMODEL_H
 
 #include <QAbstractListModel>
+#include <QCache>
 #include <QColor>
 #include <QStringList>
 #include "btglobal.h"
@@ -22,6 +23,7 @@
 #include "backend/keys/cswordldkey.h"
 
 class CSwordModuleInfo;
+class QTimer;
 
 struct ModuleEntry {
     enum TextRoles {
@@ -37,6 +39,10 @@ struct ModuleEntry {
     used by a QML ListView and to view a small portion of the available text.
     It can be continuously scrolled to any location within the module.
 
+    Rendered rows are kept in a cache. While the view scrolls, the rows ahead in
+    the scroll direction are rendered in small batches from the event loop, so
+    that they are ready when the view asks for them.
+
     \note Currently Bible, Commentary, and Book modules are supported.
     \note Parallel Bible text not yet supported.
  */
@@ -78,12 +84,23 @@ public:
     static void setHighlightColor(const QColor& color);
     static void setJesusWordsColor(const QColor& color);
 
+private slots:
+
+    /** Renders the next few rows ahead of the last requested row. */
+    void prefetchRows();
+
 private:
 
-    /** returns text string for each model index */
-    QVariant bookData(const QModelIndex & index, int role = Qt::DisplayRole) const;
-    QVariant verseData(const QModelIndex & index, int role = Qt::DisplayRole) const;
-    QVariant lexiconData(const QModelIndex & index, int role = Qt::DisplayRole) const;
+    /** returns the rendered text of a row, before colors and highlighting */
+    QString bookText(int row) const;
+    QString verseText(int row) const;
+    QString lexiconText(int row) const;
+    QString rowText(int row) const;
+
+    /** returns the text of a row with colors and highlighted words */
+    QString displayText(int row) const;
+    void schedulePrefetch(int row) const;
+    void clearCaches();
 
     QString replaceColors(const QString& text) const;
 
@@ -94,6 +111,17 @@ private:
 
     int m_firstEntry;
     int m_maxEntries;
+
+    /** Rows as rendered by CEntryDisplay, independent of colors and highlighting. */
+    mutable QCache<int, QString> m_rowCache;
+    /** Rows with colors and highlighted words. */
+    mutable QCache<int, QString> m_displayCache;
+    mutable int m_colorGeneration;
+    mutable int m_lastRow;
+    mutable int m_prefetchRow;
+    mutable int m_prefetchDirection;
+    mutable int m_prefetchRemaining;
+    QTimer* m_prefetchTimer;
     DisplayOptions m_displayOptions;
     FilterOptions m_filterOptions;
 };
@@ -0,0 +1,121 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef RENDERINGBTRENDERSINK_H
+#define RENDERINGBTRENDERSINK_H
+
+#include <QByteArray>
+#include <QString>
+
+// Sword includes:
+#include <swbuf.h>
+
+
+namespace Rendering {
+
+/**
+  \brief Append-only UTF-8 output target of the text rendering classes.
+
+  The renderers write their markup into a sink instead of concatenating
+  QStrings, so that the UTF-8 output of the Sword filters can be passed through
+  without being converted for every entry and module.
+*/
+class BtRenderSink {
+
+    public: /* Methods: */
+
+        virtual inline ~BtRenderSink() {}
+
+        inline BtRenderSink & append(const char * utf8, int size) {
+            write(utf8, size);
+            return *this;
+        }
+
+        inline BtRenderSink & append(const char * utf8) {
+            write(utf8, qstrlen(utf8));
+            return *this;
+        }
+
+        inline BtRenderSink & append(char c) {
+            write(&c, 1);
+            return *this;
+        }
+
+        inline BtRenderSink & append(const QByteArray & utf8) {
+            write(utf8.constData(), utf8.size());
+            return *this;
+        }
+
+        inline BtRenderSink & append(const sword::SWBuf & utf8) {
+            write(utf8.c_str(), utf8.length());
+            return *this;
+        }
+
+        inline BtRenderSink & append(const QString & text) {
+            if (!text.isEmpty())
+                append(text.toUtf8());
+            return *this;
+        }
+
+    protected: /* Methods: */
+
+        /** Appends \a size bytes of UTF-8 data to the output. */
+        virtual void write(const char * utf8, int size) = 0;
+
+}; /* class BtRenderSink */
+
+/**
+  \brief Sink which collects the output in a single growing UTF-8 buffer.
+
+  The result is converted to a QString only once by \ref toString().
+*/
+class BtRenderBuffer: public BtRenderSink {
+
+    public: /* Methods: */
+
+        inline BtRenderBuffer(int reserveBytes = 0) {
+            if (reserveBytes > 0)
+                m_data.reserve(reserveBytes);
+        }
+
+        /**
+          \returns the number of bytes to reserve for \a entries rendered
+                   entries. It is capped, so that a whole book does not commit
+                   megabytes up front; beyond that the buffer grows by itself.
+        */
+        static inline int reserveHint(int entries) {
+            return qMin(entries, 64) * 1024;
+        }
+
+        inline const QByteArray & data() const { return m_data; }
+        inline int size() const { return m_data.size(); }
+        inline bool isEmpty() const { return m_data.isEmpty(); }
+        inline void clear() { m_data.clear(); }
+
+        inline QString toString() const {
+            return QString::fromUtf8(m_data.constData(), m_data.size());
+        }
+
+    protected: /* Methods: */
+
+        virtual inline void write(const char * utf8, int size) {
+            m_data.append(utf8, size);
+        }
+
+    private: /* Fields: */
+
+        QByteArray m_data;
+
+}; /* class BtRenderBuffer */
+
+} /* namespace Rendering */
+
+#endif
@@ -118,6 +118,23 @@ const QString Rendering::CBookDisplay::text(
     return renderedText;
 }
 
+const QString Rendering::CBookDisplay::entryText(
+        const QList<const CSwordModuleInfo*> &modules,
+        const QString &keyName,
+        const DisplayOptions &displayOptions,
+        const FilterOptions &filterOptions)
+{
+    DisplayOptions dOpts = displayOptions;
+    dOpts.lineBreaks = true; //books should render with blocks, not with inlined sections
+
+    CDisplayRendering render(dOpts, filterOptions);
+    CDisplayRendering::KeyTree tree;
+    CDisplayRendering::KeyTreeItem::Settings itemSettings;
+    itemSettings.highlight = true;
+    tree.append( new CDisplayRendering::KeyTreeItem( keyName, modules, itemSettings ) );
+    return render.renderKeyTree(tree);
+}
+
 void Rendering::CBookDisplay::setupRenderTree(CSwordTreeKey * swordTree, CTextRendering::KeyTree * renderTree, const QString& highlightKey) {
 
     const QString key = swordTree->key();
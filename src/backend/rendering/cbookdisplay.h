@@ -36,6 +36,15 @@ class CBookDisplay: public CEntryDisplay {
                                    const DisplayOptions &displayOptions,
                                    const FilterOptions &filterOptions);
 
+        /**
+          \returns the rendered entry \a key alone, without the entries which
+                   text() displays together with it.
+        */
+        const QString entryText(const QList<const CSwordModuleInfo*> &modules,
+                                const QString &key,
+                                const DisplayOptions &displayOptions,
+                                const FilterOptions &filterOptions);
+
     protected: /* Methods: */
 
         void setupRenderTree(CSwordTreeKey *swordTree,
@@ -19,6 +19,17 @@ const QString Rendering::CChapterDisplay::text(
         const QString &keyName,
         const DisplayOptions &displayOptions,
         const FilterOptions &filterOptions)
+{
+    return versesText(modules, keyName, 1, -1, displayOptions, filterOptions);
+}
+
+const QString Rendering::CChapterDisplay::versesText(
+        const QList<const CSwordModuleInfo*> &modules,
+        const QString &keyName,
+        int firstVerse,
+        int lastVerse,
+        const DisplayOptions &displayOptions,
+        const FilterOptions &filterOptions)
 {
     typedef CSwordBibleModuleInfo CSBMI;
 
@@ -51,17 +62,22 @@ const QString Rendering::CChapterDisplay::text(
         k1.setIntros(true);
         k1.setKey(keyName);
 
-        if (k1.getChapter() == 1)
-            k1.setChapter(0); // Chapter 1, start with 0:0, otherwise X:0
+        if (firstVerse <= 1) {
+            if (k1.getChapter() == 1)
+                k1.setChapter(0); // Chapter 1, start with 0:0, otherwise X:0
 
-        k1.setVerse(0);
+            k1.setVerse(0);
+        } else {
+            k1.setVerse(firstVerse);
+        }
 
         startKey = k1.key();
 
         if (k1.getChapter() == 0)
             k1.setChapter(1);
 
-        k1.setVerse(bible->verseCount(k1.book(), k1.getChapter()));
+        const int verseCount = static_cast<int>(bible->verseCount(k1.book(), k1.getChapter()));
+        k1.setVerse((lastVerse < 0 || lastVerse > verseCount) ? verseCount : lastVerse);
         endKey = k1.key();
     }
 
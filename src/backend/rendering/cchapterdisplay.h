@@ -32,6 +32,20 @@ class CChapterDisplay: public CEntryDisplay {
                                    const DisplayOptions &displayOptions,
                                    const FilterOptions &filterOptions);
 
+        /**
+          \returns the rendered verses \a firstVerse to \a lastVerse of the
+                   chapter of \a key. If \a firstVerse is 1 or less, the
+                   introduction of the chapter is included. If \a lastVerse is
+                   negative, the verses up to the end of the chapter are
+                   rendered.
+        */
+        const QString versesText(const QList<const CSwordModuleInfo*> &modules,
+                                 const QString &key,
+                                 int firstVerse,
+                                 int lastVerse,
+                                 const DisplayOptions &displayOptions,
+                                 const FilterOptions &filterOptions);
+
 }; /* class CChapterDisplay */
 
 } /* namespace Rendering */
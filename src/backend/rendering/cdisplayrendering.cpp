@@ -37,7 +37,7 @@ QString CDisplayRendering::entryLink(const KeyTreeItem &item,
     vk.setIntros(true);
 
     if (isBible) {
-        vk.setKey(item.key());
+        item.positionKey(&vk);
     }
 
     if (isBible && (vk.getVerse() == 0)) {
@@ -66,13 +66,13 @@ const QString CEntryDisplay::textKeyRendering(
                 k1.setChapter(0);
                 k1.setVerse(0);
                 if ( k1.rawText().length() > 0 ) {
-                    tree.append( new Rendering::CTextRendering::KeyTreeItem(k1.key(), modules, preverse_settings) );
+                    tree.append( new Rendering::CTextRendering::KeyTreeItem(k1, modules, preverse_settings) );
                 }
                 k1.setChapter(1);
             }
             k1.setVerse(0);
             if ( k1.rawText().length() > 0 ) {
-                tree.append( new Rendering::CTextRendering::KeyTreeItem(k1.key(), modules, preverse_settings) );
+                tree.append( new Rendering::CTextRendering::KeyTreeItem(k1, modules, preverse_settings) );
             }
         }
     }
@@ -56,38 +56,43 @@ CHTMLExportRendering::CHTMLExportRendering(
     // Intentionally empty
 }
 
-QString CHTMLExportRendering::renderEntry(const KeyTreeItem& i, CSwordKey* k) {
-
+void CHTMLExportRendering::renderEntry(BtRenderSink &out,
+                                       const KeyTreeItem& i,
+                                       CSwordKey* k)
+{
     if (i.hasAlternativeContent()) {
-        QString ret = i.settings().highlight
-                      ? "<div class=\"currententry\">"
-                      : "<div class=\"entry\">";
-        ret.append(i.getAlternativeContent());
+        const KeyTree & tree = *i.childList();
 
-        //   Q_ASSERT(i.hasChildItems());
+        out.append(i.settings().highlight
+                   ? "<div class=\"currententry\""
+                   : "<div class=\"entry\"");
 
-        if (!i.childList()->isEmpty()) {
-            const KeyTree & tree = *i.childList();
+        //   Q_ASSERT(i.hasChildItems());
 
+        if (!tree.isEmpty()) {
             const QList<const CSwordModuleInfo*> modules = collectModules(tree);
 
             if (modules.count() == 1) { //insert the direction into the surrounding div
-                ret.insert( 5, QString("dir=\"%1\" ").arg((modules.first()->textDirection() == CSwordModuleInfo::LeftToRight) ? "ltr" : "rtl" ));
+                out.append((modules.first()->textDirection() == CSwordModuleInfo::LeftToRight)
+                           ? " dir=\"ltr\""
+                           : " dir=\"rtl\"");
             }
+        }
 
-            Q_FOREACH (const KeyTreeItem * const item, tree) {
-                ret.append(renderEntry(*item));
-            }
+        out.append('>').append(i.getAlternativeContent());
+
+        Q_FOREACH (const KeyTreeItem * const item, tree) {
+            renderEntry(out, *item);
         }
 
-        ret.append("</div>");
-        return ret; //WARNING: Return already here!
+        out.append("</div>");
+        return; //WARNING: Return already here!
     }
 
 
     const QList<const CSwordModuleInfo*> &modules(i.modules());
     if (modules.isEmpty()) {
-        return ""; //no module present for rendering
+        return; //no module present for rendering
     }
 
     QSharedPointer<CSwordKey> scoped_key( !k ? CSwordKey::createInstance(modules.first()) : 0 );
@@ -100,126 +105,157 @@ QString CHTMLExportRendering::renderEntry(const KeyTreeItem& i, CSwordKey* k) {
         myVK->setIntros(true);
     }
 
-    QString renderedText( (modules.count() > 1) ? "\n\t\t<tr>\n" : "\n" );
     // Only insert the table stuff if we are displaying parallel.
+    const bool isParallel = (modules.count() > 1);
+    out.append(isParallel ? "\n\t\t<tr>\n" : "\n");
 
     //declarations out of the loop for optimization
-    QString entry;
     bool isRTL;
-    QString preverseHeading;
-    QString langAttr;
-    QString key_renderedText;
+    QByteArray langAttr;
 
     QList<const CSwordModuleInfo*>::const_iterator end_modItr = modules.end();
 
     for (QList<const CSwordModuleInfo*>::const_iterator mod_Itr(modules.begin()); mod_Itr != end_modItr; ++mod_Itr) {
-        key->setModule(*mod_Itr);
-        key->setKey(i.key());
-
         isRTL = ((*mod_Itr)->textDirection() == CSwordModuleInfo::RightToLeft);
-        entry = QString::null;
-
-        if ((*mod_Itr)->language()->isValid()) {
-            langAttr = QString("xml:lang=\"")
-                       .append((*mod_Itr)->language()->abbrev())
-                       .append("\" lang=\"")
-                       .append((*mod_Itr)->language()->abbrev())
-                       .append("\"");
+
+        {
+            const QByteArray lang((*mod_Itr)->language()->isValid()
+                                  ? (*mod_Itr)->language()->abbrev().toUtf8()
+                                  : QByteArray((*mod_Itr)->module()->getLanguage()));
+            langAttr = QByteArray("xml:lang=\"").append(lang)
+                       .append("\" lang=\"").append(lang).append('"');
+        }
+
+        if (isParallel) {
+            out.append("\t\t<td class=\"")
+               .append(i.settings().highlight ? "currententry" : "entry")
+               .append("\" ")
+               .append(langAttr)
+               .append(isRTL ? " dir=\"rtl\">\n\t\t\t" : " dir=\"ltr\">\n\t\t\t");
         }
         else {
-            langAttr = QString("xml:lang=\"")
-                       .append((*mod_Itr)->module()->getLanguage())
-                       .append("\" lang=\"")
-                       .append((*mod_Itr)->module()->getLanguage())
-                       .append("\"");
+            out.append("\t\t");
+        }
+
+        // Use the entry fetched by prefetchEntries() or render it now:
+        PrefetchedEntry renderedEntry;
+        const PrefetchedEntries::const_iterator prefetched =
+                m_prefetchedEntries.constFind(qMakePair(&i, *mod_Itr));
+        const PrefetchedEntry & entry = (prefetched != m_prefetchedEntries.constEnd())
+                                        ? *prefetched
+                                        : renderedEntry;
+        if (prefetched == m_prefetchedEntries.constEnd()) {
+            key->setModule(*mod_Itr);
+            i.positionKey(key);
+            renderText(key, renderedEntry);
         }
 
-        key_renderedText = key->renderedText();
-
-        if (m_filterOptions.headings) {
-
-            // only process EntryAttributes, do not render, this might destroy the EntryAttributes again
-            (*mod_Itr)->module()->renderText(0, -1, 0);
-
-            sword::AttributeValue::const_iterator it =
-                (*mod_Itr)->module()->getEntryAttributes()["Heading"]["Preverse"].begin();
-            const sword::AttributeValue::const_iterator end =
-                (*mod_Itr)->module()->getEntryAttributes()["Heading"]["Preverse"].end();
-
-            for (; it != end; ++it) {
-                QString unfiltered = QString::fromUtf8(it->second.c_str());
-
-                /// \todo This is only a preliminary workaround to strip the tags:
-                QRegExp filter("(.*)<title[^>]*>(.*)</title>(.*)");
-                while(filter.indexIn(unfiltered) >= 0) {
-                    unfiltered = filter.cap(1) + filter.cap(2) + filter.cap(3);
-                }
-                // Fiter out offending self-closing div tags, which are bad HTML
-                QRegExp ofilter("(.*)<div[^>]*/>(.*)");
-                while(ofilter.indexIn(unfiltered) >= 0) {
-                    unfiltered = ofilter.cap(1) + ofilter.cap(2);
-                }
-                preverseHeading = unfiltered;
-
-                /// \todo Take care of the heading type!
-                if (!preverseHeading.isEmpty()) {
-                    entry.append("<div ")
-                    .append(langAttr)
-                    .append(" class=\"sectiontitle\">")
-                    .append(preverseHeading)
-                    .append("</div>");
-                }
+        Q_FOREACH (const QByteArray & heading, entry.preverseHeadings) {
+            QString unfiltered = QString::fromUtf8(heading.constData(), heading.size());
+
+            /// \todo This is only a preliminary workaround to strip the tags:
+            QRegExp filter("(.*)<title[^>]*>(.*)</title>(.*)");
+            while(filter.indexIn(unfiltered) >= 0) {
+                unfiltered = filter.cap(1) + filter.cap(2) + filter.cap(3);
+            }
+            // Fiter out offending self-closing div tags, which are bad HTML
+            QRegExp ofilter("(.*)<div[^>]*/>(.*)");
+            while(ofilter.indexIn(unfiltered) >= 0) {
+                unfiltered = ofilter.cap(1) + ofilter.cap(2);
+            }
+
+            /// \todo Take care of the heading type!
+            if (!unfiltered.isEmpty()) {
+                out.append("<div ")
+                   .append(langAttr)
+                   .append(" class=\"sectiontitle\">")
+                   .append(unfiltered)
+                   .append("</div>");
             }
         }
 
-        entry.append(m_displayOptions.lineBreaks  ? "<div "  : "<div style=\"display: inline;\" ");
+        out.append(m_displayOptions.lineBreaks  ? "<div "  : "<div style=\"display: inline;\" ");
 
-        if (modules.count() == 1) { //insert only the class if we're not in a td
-            entry.append( i.settings().highlight  ? "class=\"currententry\" " : "class=\"entry\" " );
+        if (!isParallel) { //insert only the class if we're not in a td
+            out.append( i.settings().highlight  ? "class=\"currententry\" " : "class=\"entry\" " );
         }
 
-        entry.append(langAttr).append(isRTL ? " dir=\"rtl\">" : " dir=\"ltr\">");
+        out.append(langAttr).append(isRTL ? " dir=\"rtl\">" : " dir=\"ltr\">");
 
         //keys should normally be left-to-right, but this doesn't apply in all cases
-        entry.append("<span class=\"entryname\" dir=\"ltr\">").append(entryLink(i, *mod_Itr)).append("</span>");
+        out.append("<span class=\"entryname\" dir=\"ltr\">").append(entryLink(i, *mod_Itr)).append("</span>");
 
         if (m_addText) {
-            //entry.append( QString::fromLatin1("<span %1>%2</span>").arg(langAttr).arg(key_renderedText) );
-            entry.append( key_renderedText );
+            out.append(entry.text);
         }
 
-        if (!i.childList()->isEmpty()) {
-            KeyTree* tree(i.childList());
-
-            Q_FOREACH (const KeyTreeItem * const c, *tree) {
-                entry.append( renderEntry(*c) );
-            }
+        Q_FOREACH (const KeyTreeItem * const c, *i.childList()) {
+            renderEntry(out, *c);
         }
 
-        entry.append("</div>");
+        out.append("</div>\n");
 
-        if (modules.count() == 1) {
-            renderedText.append( "\t\t" ).append( entry ).append("\n");
+        if (isParallel) {
+            out.append("\t\t</td>\n");
         }
-        else {
-            renderedText.append("\t\t<td class=\"")
-            .append(i.settings().highlight ? "currententry" : "entry")
-            .append("\" ")
-            .append(langAttr)
-            .append(" dir=\"")
-            .append(isRTL ? "rtl" : "ltr")
-            .append("\">\n")
-            .append( "\t\t\t" ).append( entry ).append("\n")
-            .append("\t\t</td>\n");
+    }
+
+    if (isParallel) {
+        out.append("\t\t</tr>\n");
+    }
+}
+
+void CHTMLExportRendering::renderText(CSwordKey *key, PrefetchedEntry &entry) {
+    // Render the text and collect the entry attributes in a single pass:
+    BtRenderBuffer keyText;
+    if (m_filterOptions.headings) {
+        sword::AttributeTypeList attributes;
+        key->renderedText(keyText, attributes);
+
+        const sword::AttributeValue & preverse = attributes["Heading"]["Preverse"];
+        for (sword::AttributeValue::const_iterator it = preverse.begin(); it != preverse.end(); ++it)
+            entry.preverseHeadings.append(QByteArray(it->second.c_str(), it->second.length()));
+    }
+    else if (m_addText) {
+        key->renderedText(keyText);
+    }
+    entry.text = keyText.data();
+}
+
+void CHTMLExportRendering::prefetchItems(const KeyTree &tree,
+                                         const CSwordModuleInfo *module,
+                                         CSwordKey *key)
+{
+    Q_FOREACH (const KeyTreeItem * const item, tree) {
+        if (!item->hasAlternativeContent() && item->modules().contains(module)) {
+            item->positionKey(key);
+            renderText(key, m_prefetchedEntries[qMakePair(item, module)]);
         }
+        prefetchItems(*item->childList(), module, key);
     }
+}
 
-    if (modules.count() > 1) {
-        renderedText.append("\t\t</tr>\n");
+void CHTMLExportRendering::prefetchEntries(const KeyTree &tree,
+                                           const QList<const CSwordModuleInfo*> &modules)
+{
+    m_prefetchedEntries.clear();
+    if (!m_addText && !m_filterOptions.headings)
+        return;
+
+    /* Fetch all entries of one module before going on to the next one, so
+       that consecutive entries are read from the same compressed block: */
+    Q_FOREACH (const CSwordModuleInfo * const module, modules) {
+        QSharedPointer<CSwordKey> key(CSwordKey::createInstance(module));
+        CSwordVerseKey * const vk = dynamic_cast<CSwordVerseKey *>(key.data());
+        if (vk)
+            vk->setIntros(true);
+
+        prefetchItems(tree, module, key.data());
     }
+}
 
-    //  qDebug("CHTMLExportRendering: %s", renderedText.latin1());
-    return renderedText;
+void CHTMLExportRendering::clearPrefetchedEntries() {
+    m_prefetchedEntries.clear();
 }
 
 void CHTMLExportRendering::initRendering() {
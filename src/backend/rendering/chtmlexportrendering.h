@@ -14,6 +14,9 @@
 
 #include "backend/rendering/ctextrendering.h"
 
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
 #include "backend/config/btconfig.h"
 #include "backend/managers/cswordbackend.h"
 #include "btglobal.h"
@@ -40,11 +43,34 @@ class CHTMLExportRendering: public CTextRendering {
 
     protected: /* Methods: */
 
-        virtual QString renderEntry(const KeyTreeItem &item, CSwordKey * key = 0);
+        virtual void renderEntry(BtRenderSink &out,
+                                 const KeyTreeItem &item,
+                                 CSwordKey * key = 0);
         virtual QString finishText(const QString &text, const KeyTree &tree);
         virtual QString entryLink(const KeyTreeItem &item,
                                   const CSwordModuleInfo *module);
         virtual void initRendering();
+        virtual void prefetchEntries(const KeyTree &tree,
+                                     const QList<const CSwordModuleInfo*> &modules);
+        virtual void clearPrefetchedEntries();
+
+    private: /* Types: */
+
+        /** The rendered text of one item in one module. */
+        struct PrefetchedEntry {
+            QByteArray text;
+            QList<QByteArray> preverseHeadings;
+        };
+
+        typedef QHash<QPair<const KeyTreeItem *, const CSwordModuleInfo *>,
+                      PrefetchedEntry> PrefetchedEntries;
+
+    private: /* Methods: */
+
+        void renderText(CSwordKey *key, PrefetchedEntry &entry);
+        void prefetchItems(const KeyTree &tree,
+                           const CSwordModuleInfo *module,
+                           CSwordKey *key);
 
     protected: /* Fields: */
 
@@ -52,6 +78,10 @@ class CHTMLExportRendering: public CTextRendering {
         FilterOptions m_filterOptions;
         bool m_addText;
 
+    private: /* Fields: */
+
+        PrefetchedEntries m_prefetchedEntries;
+
 }; /* class CHTMLExportRendering */
 
 } /* namespace Rendering */
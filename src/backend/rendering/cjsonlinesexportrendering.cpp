@@ -0,0 +1,94 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "backend/rendering/cjsonlinesexportrendering.h"
+
+#include <QSharedPointer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordkey.h"
+
+
+namespace {
+
+/** Appends the UTF-8 data as a quoted and escaped JSON string to \a out. */
+void appendJsonString(Rendering::BtRenderSink &out, const QByteArray &utf8) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    out.append('"');
+    const char * begin = utf8.constData();
+    const char * const end = begin + utf8.size();
+    for (const char * p = begin; p < end; p++) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        out.append(begin, p - begin);
+        begin = p + 1;
+        switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00")
+                   .append(hexDigits[c >> 4])
+                   .append(hexDigits[c & 0xf]);
+                break;
+        }
+    }
+    out.append(begin, end - begin).append('"');
+}
+
+} // anonymous namespace
+
+namespace Rendering {
+
+CJsonLinesExportRendering::CJsonLinesExportRendering(
+        bool addText,
+        const DisplayOptions &displayOptions,
+        const FilterOptions &filterOptions)
+        : CPlainTextExportRendering(addText, displayOptions, filterOptions)
+{
+    // Intentionally empty
+}
+
+void CJsonLinesExportRendering::renderEntry(BtRenderSink &out,
+                                            const KeyTreeItem &i,
+                                            CSwordKey * k)
+{
+    Q_UNUSED(k);
+
+    const QList<const CSwordModuleInfo*> modules = i.modules();
+    if (modules.isEmpty())
+        return;
+
+    const QByteArray keyText = i.key().toUtf8();
+    QSharedPointer<CSwordKey> key(CSwordKey::createInstance(modules.first()));
+
+    Q_FOREACH(const CSwordModuleInfo * module, modules) {
+        out.append("{\"module\":");
+        appendJsonString(out, module->name().toUtf8());
+        out.append(",\"key\":");
+        appendJsonString(out, keyText);
+
+        if (m_addText) {
+            key->setModule(module);
+            i.positionKey(key.data());
+
+            BtRenderBuffer text;
+            key->strippedText(text);
+            out.append(",\"text\":");
+            appendJsonString(out, text.data().trimmed());
+        }
+        out.append("}\n");
+    }
+}
+
+}
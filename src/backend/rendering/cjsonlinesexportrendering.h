@@ -0,0 +1,45 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef RENDERINGCJSONLINESEXPORTRENDERING_H
+#define RENDERINGCJSONLINESEXPORTRENDERING_H
+
+#include "backend/rendering/cplaintextexportrendering.h"
+
+
+namespace Rendering {
+
+/**
+ * This implementation exports content as JSON lines, i.e. one JSON object
+ * per line and module with the members "module", "key" and, if text is
+ * added, "text" holding the plain text of the entry.
+ * @short Text rendering as JSON lines.
+ */
+class CJsonLinesExportRendering: public CPlainTextExportRendering {
+
+    public: /* Methods: */
+
+        CJsonLinesExportRendering(
+            bool addText,
+            const DisplayOptions &displayOptions = btConfig().getDisplayOptions(),
+            const FilterOptions &filterOptions = btConfig().getFilterOptions());
+
+    protected: /* Methods: */
+
+        virtual void renderEntry(BtRenderSink &out,
+                                 const KeyTreeItem &item,
+                                 CSwordKey * key = 0);
+
+}; /* class CJsonLinesExportRendering */
+
+} /* namespace Rendering */
+
+#endif
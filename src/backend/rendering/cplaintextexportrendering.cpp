@@ -24,30 +24,28 @@ CPlainTextExportRendering::CPlainTextExportRendering(
     // Intentionally empty
 }
 
-QString CPlainTextExportRendering::renderEntry(const KeyTreeItem &i,
-                                               CSwordKey * k)
+void CPlainTextExportRendering::renderEntry(BtRenderSink &out,
+                                            const KeyTreeItem &i,
+                                            CSwordKey * k)
 {
     Q_UNUSED(k);
 
-    if (!m_addText)
-        return QString(i.key()).append("\n");
+    if (!m_addText) {
+        out.append(i.key()).append('\n');
+        return;
+    }
 
     const QList<const CSwordModuleInfo*> modules = i.modules();
-    CSwordKey * key = CSwordKey::createInstance(modules.first());
-    QString renderedText = QString(i.key()).append(":\n");
+    QSharedPointer<CSwordKey> key(CSwordKey::createInstance(modules.first()));
+    out.append(i.key()).append(":\n");
 
-    QString entry;
     Q_FOREACH(const CSwordModuleInfo * module, modules) {
         key->setModule(module);
-        key->setKey(i.key());
+        i.positionKey(key.data());
 
-        /// \todo Check this code
-        entry.append(key->strippedText()).append("\n");
-        renderedText.append( entry );
+        key->strippedText(out);
+        out.append('\n');
     }
-
-    delete key;
-    return renderedText;
 }
 
 QString CPlainTextExportRendering::finishText(const QString &text, const KeyTree &tree) {
@@ -34,9 +34,19 @@ class CPlainTextExportRendering: public CHTMLExportRendering {
 
     protected: /* Methods: */
 
-        virtual QString renderEntry(const KeyTreeItem &item, CSwordKey * key = 0);
+        virtual void renderEntry(BtRenderSink &out,
+                                 const KeyTreeItem &item,
+                                 CSwordKey * key = 0);
         virtual QString finishText(const QString &text, const KeyTree &tree);
 
+        /** The stripped text is not fetched in advance. */
+        inline virtual void prefetchEntries(const KeyTree &tree,
+                                            const QList<const CSwordModuleInfo*> &modules)
+        {
+            Q_UNUSED(tree);
+            Q_UNUSED(modules);
+        }
+
 }; /* class CPlainTextExportRendering */
 
 } /* namespace Rendering */
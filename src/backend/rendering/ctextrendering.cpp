@@ -13,8 +13,10 @@
 
 #include <QRegExp>
 #include <QtAlgorithms>
+#include <cstring>
 
 #include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/btversificationmap.h"
 #include "backend/keys/cswordkey.h"
 #include "backend/keys/cswordversekey.h"
 #include "backend/managers/cdisplaytemplatemgr.h"
@@ -22,6 +24,7 @@
 
 // Sword includes:
 #include <swkey.h>
+#include <versekey.h>
 
 
 using namespace Rendering;
@@ -32,17 +35,48 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const QString &key,
         : m_settings(settings),
         m_moduleList(),
         m_key( key ),
+        m_versification(0),
+        m_verseIndex(-1),
         m_childList(),
         m_stopKey( QString::null ),
         m_alternativeContent( QString::null ) {
     m_moduleList.append( const_cast<CSwordModuleInfo*>(module) ); //BAD CODE
 }
 
+CTextRendering::KeyTreeItem::KeyTreeItem(const CSwordVerseKey &key,
+                                         const CSwordModuleInfo *module,
+                                         const Settings &settings)
+        : m_settings(settings),
+        m_moduleList(),
+        m_key(QString::null),
+        m_versification(key.getVersificationSystem()),
+        m_verseIndex(key.getIndex()),
+        m_childList(),
+        m_stopKey(QString::null),
+        m_alternativeContent(QString::null) {
+    m_moduleList.append(module);
+}
+
+CTextRendering::KeyTreeItem::KeyTreeItem(const CSwordVerseKey &key,
+                                         const QList<const CSwordModuleInfo*> &mods,
+                                         const Settings &settings)
+        : m_settings(settings),
+        m_moduleList(mods),
+        m_key(QString::null),
+        m_versification(key.getVersificationSystem()),
+        m_verseIndex(key.getIndex()),
+        m_childList(),
+        m_stopKey(QString::null),
+        m_alternativeContent(QString::null) {
+}
+
 CTextRendering::KeyTreeItem::KeyTreeItem(const QString &content,
                                          const Settings &settings)
         : m_settings( settings ),
         m_moduleList(),
         m_key( QString::null ),
+        m_versification(0),
+        m_verseIndex(-1),
         m_childList(),
         m_stopKey( QString::null ),
         m_alternativeContent( content ) {
@@ -54,6 +88,8 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const QString &key,
         : m_settings( settings ),
         m_moduleList( mods ),
         m_key( key ),
+        m_versification(0),
+        m_verseIndex(-1),
         m_childList(),
         m_stopKey( QString::null ),
         m_alternativeContent( QString::null ) {
@@ -63,6 +99,8 @@ CTextRendering::KeyTreeItem::KeyTreeItem()
         : m_settings(),
         m_moduleList(),
         m_key(QString::null),
+        m_versification(0),
+        m_verseIndex(-1),
         m_childList(),
         m_stopKey(QString::null),
         m_alternativeContent(QString::null) {
@@ -72,6 +110,8 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const KeyTreeItem& i)
         : m_settings( i.m_settings ),
         m_moduleList( i.m_moduleList ),
         m_key( i.m_key ),
+        m_versification( i.m_versification ),
+        m_verseIndex( i.m_verseIndex ),
         m_childList(),
         m_stopKey( i.m_stopKey ),
         m_alternativeContent( i.m_alternativeContent )
@@ -90,6 +130,8 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const QString &startKey,
         : m_settings( settings ),
         m_moduleList(),
         m_key( startKey ),
+        m_versification(0),
+        m_verseIndex(-1),
         m_childList(),
         m_stopKey( stopKey ),
         m_alternativeContent( QString::null ) {
@@ -110,7 +152,7 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const QString &startKey,
 
             while (ok && ((start < stop) || (start == stop)) ) { //range
                 m_childList.append(
-                    new KeyTreeItem(start.key(), module, KeyTreeItem::Settings(false, settings.keyRenderingFace))
+                    new KeyTreeItem(start, module, KeyTreeItem::Settings(false, settings.keyRenderingFace))
                 );
 
 
@@ -156,6 +198,42 @@ CTextRendering::KeyTreeItem::KeyTreeItem(const QString &startKey,
     m_alternativeContent.prepend("<div class=\"rangeheading\" dir=\"ltr\">").append("</div>"); //insert the right tags
 }
 
+void CTextRendering::KeyTreeItem::createKeyText() const {
+    Q_ASSERT(!m_moduleList.isEmpty());
+    const sword::VerseKey * const moduleKey =
+            dynamic_cast<const sword::VerseKey *>(m_moduleList.first()->module()->getKey());
+    Q_ASSERT(moduleKey);
+    if (!moduleKey)
+        return;
+
+    /* Copy the module key to get its locale. The index belongs to the
+       versification of the key the item was created from, which may differ
+       from the one of the first module: */
+    sword::VerseKey vk(*moduleKey);
+    vk.setVersificationSystem(m_versification);
+    vk.setIntros(true);
+    vk.setIndex(m_verseIndex);
+    m_key = QString::fromUtf8(vk.getText());
+}
+
+bool CTextRendering::KeyTreeItem::positionKey(CSwordKey *k) const {
+    Q_ASSERT(k);
+    if (m_verseIndex >= 0) {
+        CSwordVerseKey * const vk = dynamic_cast<CSwordVerseKey *>(k);
+        if (vk) {
+            long index = m_verseIndex;
+            if (std::strcmp(vk->getVersificationSystem(), m_versification))
+                index = BtVersificationMap::get(m_versification,
+                                                vk->getVersificationSystem()).map(index);
+            if (index >= 0) {
+                vk->setIndex(index);
+                return !vk->popError();
+            }
+        }
+    }
+    return k->setKey(key());
+}
+
 QList<const CSwordModuleInfo*> CTextRendering::collectModules(const KeyTree &tree) const {
     //collect all modules which are available and used by child items
     QList<const CSwordModuleInfo*> modules;
@@ -171,29 +249,49 @@ QList<const CSwordModuleInfo*> CTextRendering::collectModules(const KeyTree &tre
 }
 
 const QString CTextRendering::renderKeyTree(const KeyTree &tree) {
+    // All entries are collected as UTF-8 and converted to a QString only once:
+    BtRenderBuffer out(BtRenderBuffer::reserveHint(tree.count()));
+    renderEntries(out, tree);
+
+    return finishText(out.toString(), tree);
+}
+
+void CTextRendering::renderEntries(BtRenderSink &out, const KeyTree &tree) {
     initRendering();
 
     const QList<const CSwordModuleInfo*> modules = collectModules(tree);
-    QString t;
-
-    //optimization for entries with the same key
-    QSharedPointer<CSwordKey> key(
-        (modules.count() == 1) ? CSwordKey::createInstance(modules.first()) : 0
-    );
 
     if (modules.count() == 1) { //this optimizes the rendering, only one key created for all items
+        QSharedPointer<CSwordKey> key(CSwordKey::createInstance(modules.first()));
         Q_FOREACH (const KeyTreeItem * const c, tree) {
-            key->setKey(c->key());
-            t.append( renderEntry( *c, key.data()) );
+            c->positionKey(key.data());
+            renderEntry(out, *c, key.data());
         }
     }
     else {
+        prefetchEntries(tree, modules);
         Q_FOREACH (const KeyTreeItem * const c, tree) {
-            t.append( renderEntry( *c ) );
+            renderEntry(out, *c);
         }
+        clearPrefetchedEntries();
     }
+}
 
-    return finishText(t, tree);
+void CTextRendering::renderPageFrame(const KeyTree &tree,
+                                     QString &head,
+                                     QString &tail)
+{
+    static const QString placeholder("\x1f#ENTRIES#\x1f");
+
+    const QString page = finishText(placeholder, tree);
+    const int pos = page.indexOf(placeholder);
+    if (pos < 0) {
+        head = page;
+        tail.clear();
+    } else {
+        head = page.left(pos);
+        tail = page.mid(pos + placeholder.size());
+    }
 }
 
 const QString CTextRendering::renderKeyRange(
@@ -231,10 +329,19 @@ const QString CTextRendering::renderKeyRange(
         CSwordVerseKey* vk_stop = dynamic_cast<CSwordVerseKey*>(upperBound.data());
         Q_ASSERT(vk_stop);
 
+        // Parse the highlighted key once and compare the verse indices below:
+        long highlightIndex = -1;
+        if (!highlightKey.isEmpty()) {
+            CSwordVerseKey highlightVK(*vk_start);
+            highlightVK.setIntros(true);
+            if (highlightVK.setKey(highlightKey))
+                highlightIndex = highlightVK.getIndex();
+        }
+
         while ((*vk_start < *vk_stop) || (*vk_start == *vk_stop)) {
 
             //make sure the key given by highlightKey gets marked as current key
-            settings.highlight = (!highlightKey.isEmpty() ? (vk_start->key() == highlightKey) : false);
+            settings.highlight = (vk_start->getIndex() == highlightIndex);
 
             /**
                 \todo We need to take care of linked verses if we render one or
@@ -244,11 +351,11 @@ const QString CTextRendering::renderKeyRange(
 
             if (vk_start->getChapter() == 0) { // range was 0:0-1:x, render 0:0 first and jump to 1:0
                 vk_start->setVerse(0);
-                tree.append( new KeyTreeItem(vk_start->key(), modules, settings) );
+                tree.append( new KeyTreeItem(*vk_start, modules, settings) );
                 vk_start->setChapter(1);
                 vk_start->setVerse(0);
             }
-            tree.append( new KeyTreeItem(vk_start->key(), modules, settings) );
+            tree.append( new KeyTreeItem(*vk_start, modules, settings) );
             if (!vk_start->next(CSwordVerseKey::UseVerse)) {
                 /// \todo Notify the user about this failure.
                 break;
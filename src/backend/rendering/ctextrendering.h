@@ -15,10 +15,12 @@
 #include <QList>
 #include <QSharedPointer>
 #include <QString>
+#include "backend/rendering/btrendersink.h"
 
 
 class CSwordKey;
 class CSwordModuleInfo;
+class CSwordVerseKey;
 
 namespace Rendering {
 
@@ -81,6 +83,19 @@ class CTextRendering {
                             const QList<const CSwordModuleInfo*> &modules,
                             const Settings &settings);
 
+                /**
+                  Creates an item for the verse of \a key. Only the
+                  versification and the index of the verse are stored, the
+                  text of the key is created on demand by key().
+                */
+                KeyTreeItem(const CSwordVerseKey &key,
+                            const CSwordModuleInfo *module,
+                            const Settings &settings);
+
+                KeyTreeItem(const CSwordVerseKey &key,
+                            const QList<const CSwordModuleInfo*> &modules,
+                            const Settings &settings);
+
                 KeyTreeItem(const QString &startKey,
                             const QString &stopKey,
                             const CSwordModuleInfo *module,
@@ -107,9 +122,19 @@ class CTextRendering {
                 }
 
                 inline const QString& key() const {
+                    if (m_key.isNull() && m_verseIndex >= 0)
+                        createKeyText();
                     return m_key;
                 }
 
+                /**
+                  Sets \a k to the entry of this item. Verse keys with the
+                  versification of this item are set by index, other keys
+                  parse the text of key().
+                  \returns whether the key was set without error.
+                */
+                bool positionKey(CSwordKey *k) const;
+
                 inline const Settings& settings() const {
                     return m_settings;
                 }
@@ -122,11 +147,17 @@ class CTextRendering {
 
                 KeyTreeItem();
 
+            private: /* Methods: */
+
+                void createKeyText() const;
+
             private: /* Fields: */
 
                 Settings m_settings;
                 QList<const CSwordModuleInfo*> m_moduleList;
-                QString m_key;
+                mutable QString m_key;
+                const char *m_versification;
+                long m_verseIndex;
                 mutable KeyTree m_childList;
 
                 QString m_stopKey;
@@ -152,13 +183,47 @@ class CTextRendering {
                 const QList<const CSwordModuleInfo*> &modules,
                 const KeyTreeItem::Settings &settings = KeyTreeItem::Settings());
 
+        /**
+          Renders the entries of \a tree to \a out without the page which
+          renderKeyTree() puts around them. Together with renderPageFrame()
+          this allows to write large trees in several parts.
+        */
+        void renderEntries(BtRenderSink &out, const KeyTree &tree);
+
+        /**
+          Renders the page which renderKeyTree() would put around the
+          entries of \a tree into the parts before and after the entries.
+        */
+        void renderPageFrame(const KeyTree &tree, QString &head, QString &tail);
+
     protected: /* Methods: */
 
         QList<const CSwordModuleInfo*> collectModules(const KeyTree &tree) const;
-        virtual QString renderEntry(const KeyTreeItem &item, CSwordKey * key = 0) = 0;
+        /**
+          Renders the given item and appends the resulting markup to \a out.
+        */
+        virtual void renderEntry(BtRenderSink &out,
+                                 const KeyTreeItem &item,
+                                 CSwordKey * key = 0) = 0;
         virtual QString finishText(const QString &text, const KeyTree &tree) = 0;
         virtual void initRendering() = 0;
 
+        /**
+          Called by renderKeyTree() before the entries of a tree with more
+          than one module are rendered. Reimplementations may fetch the
+          entries module by module, which is friendlier to the block caches
+          of the Sword modules than fetching them verse by verse.
+        */
+        virtual void prefetchEntries(const KeyTree &tree,
+                                     const QList<const CSwordModuleInfo*> &modules)
+        {
+            Q_UNUSED(tree);
+            Q_UNUSED(modules);
+        }
+
+        /** Releases the entries fetched by prefetchEntries(). */
+        virtual void clearPrefetchedEntries() {}
+
 }; /* class CTextRendering */
 
 } /* namespace Rendering */
@@ -18,6 +18,8 @@
 #include <QMdiSubWindow>
 #include <QSplashScreen>
 #include <QSplitter>
+#include <QStatusBar>
+#include <QTimer>
 #include "backend/config/btconfig.h"
 #include "backend/drivers/cswordbiblemoduleinfo.h"
 #include "backend/drivers/cswordbookmoduleinfo.h"
@@ -26,8 +28,10 @@
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/keys/cswordldkey.h"
 #include "backend/keys/cswordversekey.h"
+#include "backend/managers/btlexiconcachewarmer.h"
 #include "bibletimeapp.h"
 #include "frontend/btaboutmoduledialog.h"
+#include "frontend/btlexiconcacheindicator.h"
 #include "frontend/cmdiarea.h"
 #include "frontend/display/btfindwidget.h"
 #include "frontend/displaywindow/btactioncollection.h"
@@ -37,6 +41,7 @@
 #include "frontend/keychooser/ckeychooser.h"
 #include "frontend/messagedialog.h"
 #include "frontend/searchdialog/csearchdialog.h"
+#include "util/btstartupprofiler.h"
 #include "util/cresmgr.h"
 #include "util/directory.h"
 #include "util/geticon.h"
@@ -46,6 +51,7 @@ BibleTime *BibleTime::m_instance = 0;
 
 BibleTime::BibleTime(QWidget *parent, Qt::WindowFlags flags)
     : QMainWindow(parent, flags)
+    , m_lexiconCacheWarmer(0)
 {
     namespace DU = util::directory;
 
@@ -79,28 +85,40 @@ BibleTime::BibleTime(QWidget *parent, Qt::WindowFlags flags)
         splash->show();
         qApp->processEvents();
     }
-    initBackends();
+    {
+        BtStartupProfiler::Phase phase("Backend");
+        initBackends();
+    }
 
     if (splash != 0) {
         splash->showMessage(splashHtml.arg(tr("Creating BibleTime's user interface...")),
                             Qt::AlignCenter);
         qApp->processEvents();
     }
-    initView();
+    {
+        BtStartupProfiler::Phase phase("View");
+        initView();
+    }
 
     if (splash != 0) {
         splash->showMessage(splashHtml.arg(tr("Initializing menu- and toolbars...")),
                             Qt::AlignCenter);
         qApp->processEvents();
     }
-    initActions();
-    initMenubar();
-    initToolbars();
-    initConnections();
+    {
+        BtStartupProfiler::Phase phase("Actions, menus and toolbars");
+        initActions();
+        initMenubar();
+        initToolbars();
+        initConnections();
+    }
 
     setWindowTitle("BibleTime " BT_VERSION);
     setWindowIcon(util::getIcon(CResMgr::mainWindow::icon));
     retranslateUi();
+
+    // Leave the startup some time before doing work in the background:
+    QTimer::singleShot(3000, this, SLOT(startLexiconCacheWarmUp()));
 }
 
 BibleTime::~BibleTime() {
@@ -182,9 +200,34 @@ void BibleTime::searchInModule(CSwordModuleInfo *module) {
     /// \todo Refactor this.
     QList<const CSwordModuleInfo *> modules;
     modules.append(module);
+    cancelLexiconCacheWarmUp();
     Search::CSearchDialog::openDialog(modules, QString::null);
 }
 
+void BibleTime::startLexiconCacheWarmUp() {
+    if (m_lexiconCacheWarmer == 0) {
+        m_lexiconCacheWarmer = new BtLexiconCacheWarmer(this);
+        connect(m_lexiconCacheWarmer, SIGNAL(finished()),
+                this,                 SLOT(slotLexiconCacheWarmUpFinished()));
+    }
+
+    if (m_lexiconCacheWarmer->isRunning() || !m_lexiconCacheWarmer->start())
+        return;
+
+    statusBar()->addPermanentWidget(new BtLexiconCacheIndicator(m_lexiconCacheWarmer,
+                                                                statusBar()));
+    statusBar()->show();
+}
+
+void BibleTime::slotLexiconCacheWarmUpFinished() {
+    statusBar()->hide();
+}
+
+void BibleTime::cancelLexiconCacheWarmUp() {
+    if (m_lexiconCacheWarmer != 0)
+        m_lexiconCacheWarmer->cancel();
+}
+
 bool BibleTime::moduleUnlock(CSwordModuleInfo *module, QWidget *parent) {
     /// \todo Write a proper unlocking dialog with integrated error messages.
     QString unlockKey;
@@ -266,8 +309,10 @@ void BibleTime::processCommandline(bool ignoreSession, const QString &bibleKey)
     }
 
     // Restore workspace if not not ignoring session data:
-    if (!ignoreSession)
+    if (!ignoreSession) {
+        BtStartupProfiler::Phase phase("Session restore");
         reloadProfile();
+    }
 
     if (btConfig().value<bool>("state/crashedLastTime", false)) {
         return;
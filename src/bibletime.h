@@ -29,6 +29,7 @@ class CInfoDisplay;
 class BtActionClass;
 class BtBookshelfDockWidget;
 class BtFindWidget;
+class BtLexiconCacheWarmer;
 class BtOpenWorkAction;
 class CBookmarkIndex;
 class CDisplayWindow;
@@ -506,6 +507,9 @@ public slots:
         CMDIArea* m_mdi;
         BtFindWidget* m_findWidget;
 
+        /** Creates the missing lexicon key caches after startup. */
+        BtLexiconCacheWarmer* m_lexiconCacheWarmer;
+
 
     protected: //DBUS interface implementation
         void closeAllModuleWindows();
@@ -531,6 +535,20 @@ public slots:
          */
         void showOrHideToolBars();
 
+        /**
+         * Stops creating the lexicon key caches in the background, e.g. when
+         * the user starts a search.
+         */
+        void cancelLexiconCacheWarmUp();
+
+    private slots:
+        /**
+         * Starts creating the missing lexicon key caches in the background
+         * and shows the progress in the status bar.
+         */
+        void startLexiconCacheWarmUp();
+        void slotLexiconCacheWarmUpFinished();
+
 #ifdef BT_DEBUG
         void deleteDebugWindow();
     private slots:
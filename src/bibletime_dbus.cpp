@@ -24,7 +24,7 @@ void BibleTime::syncAllModulesByType(const CSwordModuleInfo::ModuleType type, co
     Q_FOREACH (const QMdiSubWindow * const w, m_mdi->usableWindowList()) {
         CDisplayWindow * const d = dynamic_cast<CDisplayWindow*>(w->widget());
         if (d != 0 && !d->modules().isEmpty() && d->modules().first()->type() == type) {
-            d->lookupKey(key);
+            m_mdi->scheduleLookup(d, key);
         }
     }
 }
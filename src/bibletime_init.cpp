@@ -35,6 +35,7 @@
 #include "frontend/displaywindow/btmodulechooserbar.h"
 #include "frontend/bookmarks/cbookmarkindex.h"
 #include "frontend/settingsdialogs/btlanguagesettings.h"
+#include "util/btstartupprofiler.h"
 #include "util/cresmgr.h"
 #include "util/directory.h"
 #include "util/geticon.h"
@@ -60,12 +61,18 @@ void BibleTime::initView() {
 
     createCentralWidget();
 
-    m_bookshelfDock = new BtBookshelfDockWidget(this);
+    {
+        BtStartupProfiler::Phase phase("Bookshelf");
+        m_bookshelfDock = new BtBookshelfDockWidget(this);
+    }
     addDockWidget(Qt::LeftDockWidgetArea, m_bookshelfDock);
 
     m_bookmarksDock = new QDockWidget(this);
     m_bookmarksDock->setObjectName("BookmarksDock");
-    m_bookmarksPage = new CBookmarkIndex(0);
+    {
+        BtStartupProfiler::Phase phase("Bookmarks");
+        m_bookmarksPage = new CBookmarkIndex(0);
+    }
     m_bookmarksDock->setWidget(m_bookmarksPage);
     addDockWidget(Qt::LeftDockWidgetArea, m_bookmarksDock);
     tabifyDockWidget(m_bookmarksDock, m_bookshelfDock);
@@ -895,7 +902,11 @@ void BibleTime::initBackends() {
     CSwordBackend *backend = CSwordBackend::createInstance();
     backend->booknameLanguage(btConfig().value<QString>("language", QLocale::system().name()));
 
-    const CSwordBackend::LoadError errorCode = CSwordBackend::instance()->initModules(CSwordBackend::OtherChange);
+    CSwordBackend::LoadError errorCode;
+    {
+        BtStartupProfiler::Phase phase("Module initialization");
+        errorCode = CSwordBackend::instance()->initModules(CSwordBackend::OtherChange);
+    }
 
     if (errorCode != CSwordBackend::NoError) {
         //show error message that initBackend failed
@@ -936,6 +947,7 @@ void BibleTime::initBackends() {
     // This function will
     // - delete all orphaned indexes (no module present) if autoDeleteOrphanedIndices is true
     // - delete all indices of modules where hasIndex() returns false
+    BtStartupProfiler::Phase phase("Orphaned index cleanup");
     backend->deleteOrphanedIndices();
 
 }
@@ -70,6 +70,7 @@ void BibleTime::slotSettingsChanged() {
 //         ++it;
 //     }
 
+    m_infoDisplay->clearCache();
     refreshBibleTimeAccel();
     refreshDisplayWindows();
     refreshProfileMenus();
@@ -78,6 +79,8 @@ void BibleTime::slotSettingsChanged() {
 
 /** Opens the sword setup dialog of BibleTime. */
 void BibleTime::slotSwordSetupDialog() {
+    cancelLexiconCacheWarmUp();
+
     BtModuleManagerDialog *dlg = BtModuleManagerDialog::getInstance(this);
 
     dlg->showNormal();
@@ -290,6 +293,7 @@ void BibleTime::slotSearchModules() {
             modules << w->modules();
         }
     }
+    cancelLexiconCacheWarmUp();
     Search::CSearchDialog::openDialog(modules, QString::null);
 }
 
@@ -308,6 +312,7 @@ void BibleTime::slotSearchDefaultBible() {
     if (bible) {
         module.append(bible);
     }
+    cancelLexiconCacheWarmUp();
     Search::CSearchDialog::openDialog(module, QString::null);
 }
 
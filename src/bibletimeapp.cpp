@@ -18,10 +18,17 @@
 #include "util/geticon.h"
 
 
-BibleTimeApp::BibleTimeApp(int &argc, char **argv)
+BibleTimeApp::BibleTimeApp(int &argc, char **argv, bool guiEnabled)
+#if QT_VERSION < 0x050000
+    : QApplication(argc, argv, guiEnabled)
+#else
     : QApplication(argc, argv)
+#endif
     , m_init(false)
 {
+#if QT_VERSION >= 0x050000
+    Q_UNUSED(guiEnabled);
+#endif
     setApplicationName("bibletime");
     setApplicationVersion(BT_VERSION);
 }
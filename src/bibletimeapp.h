@@ -25,7 +25,12 @@ class BibleTimeApp : public QApplication {
 
     public: /* Methods: */
 
-        BibleTimeApp(int &argc, char **argv);
+        /**
+          \param guiEnabled Whether to connect to the window system. Only
+                            respected by Qt 4, tools without a GUI have to
+                            select a headless platform plugin with Qt 5.
+        */
+        BibleTimeApp(int &argc, char **argv, bool guiEnabled = true);
         ~BibleTimeApp();
 
         inline void startInit() { m_init = true; }
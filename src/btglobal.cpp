@@ -21,3 +21,19 @@ FilterOptions::FilterOptions()
       textualVariants(0), redLetterWords(0), scriptureReferences(0),
       morphSegmentation(0) {
 }
+
+quint32 FilterOptions::toBitmask() const {
+    return (footnotes           ? 0x0001u : 0u)
+         | (strongNumbers       ? 0x0002u : 0u)
+         | (headings            ? 0x0004u : 0u)
+         | (morphTags           ? 0x0008u : 0u)
+         | (lemmas              ? 0x0010u : 0u)
+         | (hebrewPoints        ? 0x0020u : 0u)
+         | (hebrewCantillation  ? 0x0040u : 0u)
+         | (greekAccents        ? 0x0080u : 0u)
+         | (redLetterWords      ? 0x0100u : 0u)
+         | (scriptureReferences ? 0x0200u : 0u)
+         | (morphSegmentation   ? 0x0400u : 0u)
+         | (static_cast<quint32>(textualVariants == 0 ? 0
+                                 : textualVariants == 1 ? 1 : 2) << 11);
+}
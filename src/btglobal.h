@@ -36,6 +36,12 @@ struct FilterOptions {
     int scriptureReferences; /**< 0 for disabled, 1 for enabled */
     int morphSegmentation; /**< 0 for disabled, 1 for enabled */
     FilterOptions();
+
+    /**
+      \returns the options as a bitmask, one bit per option and two bits for
+               the textual variants. Equal bitmasks give equal filter states.
+    */
+    quint32 toBitmask() const;
 };
 Q_DECLARE_METATYPE(FilterOptions)
 
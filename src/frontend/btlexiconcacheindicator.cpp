@@ -0,0 +1,58 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License
+* version 2.0.
+*
+**********/
+
+#include "frontend/btlexiconcacheindicator.h"
+
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QProgressBar>
+#include <QToolButton>
+#include "backend/managers/btlexiconcachewarmer.h"
+
+
+BtLexiconCacheIndicator::BtLexiconCacheIndicator(BtLexiconCacheWarmer * warmer,
+                                                 QWidget * parent)
+    : QWidget(parent)
+{
+    Q_ASSERT(warmer);
+
+    QHBoxLayout * const layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    m_label = new QLabel(tr("Preparing dictionaries..."), this);
+    layout->addWidget(m_label);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 0);
+    m_progressBar->setMaximumWidth(120);
+    layout->addWidget(m_progressBar);
+
+    m_cancelButton = new QToolButton(this);
+    m_cancelButton->setAutoRaise(true);
+    m_cancelButton->setText(tr("Cancel"));
+    m_cancelButton->setToolTip(tr("Stop preparing the dictionaries, they will be prepared when they are opened"));
+    layout->addWidget(m_cancelButton);
+
+    connect(m_cancelButton, SIGNAL(clicked()),
+            warmer,         SLOT(cancel()));
+    connect(warmer, SIGNAL(progress(const QString &, int, int)),
+            this,   SLOT(slotProgress(const QString &, int, int)));
+    connect(warmer, SIGNAL(finished()),
+            this,   SLOT(deleteLater()));
+}
+
+void BtLexiconCacheIndicator::slotProgress(const QString & module,
+                                           int done,
+                                           int total)
+{
+    m_label->setText(tr("Preparing dictionary %1...").arg(module));
+    m_progressBar->setRange(0, total);
+    m_progressBar->setValue(done);
+}
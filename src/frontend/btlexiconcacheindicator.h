@@ -0,0 +1,50 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License
+* version 2.0.
+*
+**********/
+
+#ifndef BTLEXICONCACHEINDICATOR_H
+#define BTLEXICONCACHEINDICATOR_H
+
+#include <QWidget>
+
+
+class BtLexiconCacheWarmer;
+class QLabel;
+class QProgressBar;
+class QToolButton;
+
+/**
+  \brief Status bar widget showing the progress of a BtLexiconCacheWarmer.
+
+  The widget deletes itself once the warmer finished or was canceled.
+*/
+class BtLexiconCacheIndicator: public QWidget {
+
+    Q_OBJECT
+
+public: /* Methods: */
+
+    BtLexiconCacheIndicator(BtLexiconCacheWarmer * warmer,
+                            QWidget * parent = 0);
+
+private slots:
+
+    void slotProgress(const QString & module, int done, int total);
+
+private: /* Fields: */
+
+    QLabel * m_label;
+    QProgressBar * m_progressBar;
+    QToolButton * m_cancelButton;
+
+};
+
+#endif
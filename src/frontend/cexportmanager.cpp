@@ -11,9 +11,13 @@
 
 #include <QApplication>
 #include <QClipboard>
+#include <QFile>
 #include <QFileDialog>
 #include <QList>
+#include <QMessageBox>
 #include <QProgressDialog>
+#include <QSharedPointer>
+#include <QTextCodec>
 #include <QTextStream>
 #include "backend/drivers/cswordmoduleinfo.h"
 #include "backend/keys/cswordkey.h"
@@ -22,9 +26,9 @@
 #include "backend/managers/cdisplaytemplatemgr.h"
 #include "backend/rendering/centrydisplay.h"
 #include "backend/rendering/chtmlexportrendering.h"
+#include "backend/rendering/cjsonlinesexportrendering.h"
 #include "backend/rendering/cplaintextexportrendering.h"
 #include "frontend/cprinter.h"
-#include "util/tool.h"
 
 // Sword includes:
 #include <swkey.h>
@@ -34,6 +38,151 @@
 using namespace Rendering;
 using namespace Printing;
 
+namespace {
+
+/** Number of entries rendered and written at once by ChunkedExportFile. */
+const int EXPORT_CHUNK_SIZE = 100;
+
+inline QTextCodec * exportCodec(const CExportManager::Format format) {
+    return (format == CExportManager::Text)
+           ? QTextCodec::codecForLocale()
+           : QTextCodec::codecForName("UTF-8");
+}
+
+/**
+  Renders the added entries in chunks and writes each chunk to the file right
+  away, so only a small part of a large export is kept in memory.
+*/
+class ChunkedExportFile {
+
+    public: /* Methods: */
+
+        ChunkedExportFile(CTextRendering * renderer,
+                          const QString & filename,
+                          QTextCodec * codec)
+            : m_renderer(renderer)
+            , m_file(filename)
+            , m_codec(codec)
+            , m_isUtf8(codec->mibEnum() == 106)
+            , m_started(false)
+        {}
+
+        bool open() {
+            if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                return true;
+
+            QMessageBox::critical(0, QObject::tr("Error"),
+                                  QString::fromLatin1("<qt>%1<br/><b>%2</b></qt>")
+                                      .arg(QObject::tr("The file couldn't be opened for saving."))
+                                      .arg(QObject::tr("Please check permissions etc.")));
+            return false;
+        }
+
+        /**
+          Adds an item to the current chunk and writes the chunk if it is
+          full. \returns false on write errors.
+        */
+        bool append(CTextRendering::KeyTreeItem * item) {
+            m_chunk.append(CTextRendering::KeyTreeSharedPointer(item));
+            return (m_chunk.count() < EXPORT_CHUNK_SIZE) || writeChunk();
+        }
+
+        /** Writes the remaining entries and closes the file. */
+        bool finish() {
+            if (!writeChunk() || !write(m_tail))
+                return false;
+
+            m_file.close();
+            if (m_file.error() == QFile::NoError)
+                return true;
+
+            showWriteError();
+            return false;
+        }
+
+        /**
+          Bases the page around the entries on \a modules instead of the
+          modules of the first chunk. Has to be called before the first entry
+          is added.
+        */
+        void setPageModules(const QList<const CSwordModuleInfo *> & modules) {
+            Q_ASSERT(!m_started);
+            CTextRendering::KeyTreeItem::Settings settings;
+            settings.highlight = false;
+            m_frame.clear();
+            Q_FOREACH (const CSwordModuleInfo * module, modules)
+                m_frame.append(CTextRendering::KeyTreeSharedPointer(
+                        new CTextRendering::KeyTreeItem(QString::null, module, settings)));
+        }
+
+        /** Closes and removes the incomplete file, e.g. after cancelling. */
+        void abort() {
+            m_chunk.clear();
+            m_file.close();
+            m_file.remove();
+        }
+
+    private: /* Methods: */
+
+        bool writeChunk() {
+            if (!m_started) {
+                /* The page around the entries is based on the page modules
+                   if they are given, otherwise on the first chunk: */
+                QString head;
+                m_renderer->renderPageFrame(m_frame.isEmpty() ? m_chunk : m_frame,
+                                            head,
+                                            m_tail);
+                m_started = true;
+                if (!write(head))
+                    return false;
+            }
+            if (m_chunk.isEmpty())
+                return true;
+
+            BtRenderBuffer out(BtRenderBuffer::reserveHint(m_chunk.count()));
+            m_renderer->renderEntries(out, m_chunk);
+            m_chunk.clear();
+
+            if (m_isUtf8)
+                return write(out.data());
+            return write(out.toString());
+        }
+
+        inline bool write(const QString & text) {
+            return text.isEmpty() || write(m_codec->fromUnicode(text));
+        }
+
+        bool write(const QByteArray & data) {
+            if (m_file.write(data) == data.size())
+                return true;
+
+            showWriteError();
+            abort();
+            return false;
+        }
+
+        static void showWriteError() {
+            QMessageBox::critical(0, QObject::tr("Error"),
+                                  QString::fromLatin1("<qt>%1<br/><b>%2</b></qt>")
+                                      .arg(QObject::tr("Error while writing to file."))
+                                      .arg(QObject::tr("Please check that enough disk space is available.")));
+        }
+
+    private: /* Fields: */
+
+        CTextRendering * const m_renderer;
+        QFile m_file;
+        QTextCodec * const m_codec;
+        const bool m_isUtf8;
+        bool m_started;
+        CTextRendering::KeyTree m_chunk;
+        CTextRendering::KeyTree m_frame;
+        QString m_tail;
+
+};
+
+} // anonymous namespace
+
 CExportManager::CExportManager(const bool showProgress,
                                const QString &progressLabel,
                                const FilterOptions &filterOptions,
@@ -55,7 +204,7 @@ CExportManager::~CExportManager() {
     delete m_progressDialog;
 }
 
-bool CExportManager::saveKey(CSwordKey* key, const Format format, const bool addText) {
+bool CExportManager::saveKey(CSwordKey* key, Format format, const bool addText) {
     if (!key) {
         return false;
     }
@@ -67,26 +216,53 @@ bool CExportManager::saveKey(CSwordKey* key, const Format format, const bool add
         return false;
     }
 
-    CTextRendering * render = newRenderer(format, addText);
-
-    QString text;
+    QSharedPointer<CTextRendering> render(newRenderer(format, addText));
+    ChunkedExportFile file(render.data(), filename, exportCodec(format));
+    if (!file.open())
+        return false;
 
-    QList<const CSwordModuleInfo*> modules;
-    modules.append(key->module());
+    const CSwordModuleInfo * const module = key->module();
+    CTextRendering::KeyTreeItem::Settings itemSettings;
+    itemSettings.highlight = false;
 
     CSwordVerseKey *vk = dynamic_cast<CSwordVerseKey*>(key);
     if (vk && vk->isBoundSet()) {
-        text = render->renderKeyRange( QString::fromUtf8(vk->getLowerBound()), QString::fromUtf8(vk->getUpperBound()), modules );
+        // Write the range verse by verse instead of rendering it at once:
+        CSwordVerseKey current(module);
+        current.setKey(QString::fromUtf8(vk->getLowerBound()));
+        CSwordVerseKey stop(module);
+        stop.setKey(QString::fromUtf8(vk->getUpperBound()));
+
+        setProgressRange(static_cast<int>(qMax(1L, stop.getIndex() - current.getIndex() + 1)));
+        while (current < stop || current == stop) {
+            if (current.getChapter() == 0) { // range was 0:0-1:x, write 0:0 first and jump to 1:0
+                current.setVerse(0);
+                if (!file.append(new CTextRendering::KeyTreeItem(current, module, itemSettings)))
+                    return false;
+                current.setChapter(1);
+                current.setVerse(0);
+            }
+            if (!file.append(new CTextRendering::KeyTreeItem(current, module, itemSettings)))
+                return false;
+
+            incProgress();
+            updateProgress();
+            if (progressWasCancelled()) {
+                file.abort();
+                return false;
+            }
+            if (!current.next(CSwordVerseKey::UseVerse))
+                break;
+        }
     }
     else { //no range supported
-        text = render->renderSingleKey(key->key(), modules);
+        if (!file.append(new CTextRendering::KeyTreeItem(key->key(), module, itemSettings)))
+            return false;
     }
-    delete render;
 
-    util::tool::savePlainFile(filename, text, false,
-                              (format == HTML)
-                              ? QTextCodec::codecForName("UTF-8")
-                              : QTextCodec::codecForLocale());
+    if (!file.finish())
+        return false;
+    closeProgressDialog();
     return true;
 }
 
@@ -103,7 +279,10 @@ bool CExportManager::saveKeyList(const sword::ListKey & l,
         return false;
     }
 
-    CTextRendering::KeyTree tree; /// \todo Verify that items in tree are properly freed.
+    QSharedPointer<CTextRendering> render(newRenderer(format, addText));
+    ChunkedExportFile file(render.data(), filename, exportCodec(format));
+    if (!file.open())
+        return false;
 
     setProgressRange(l.getCount());
     CTextRendering::KeyTreeItem::Settings itemSettings;
@@ -111,23 +290,23 @@ bool CExportManager::saveKeyList(const sword::ListKey & l,
 
     sword::ListKey list(l);
     list.setPosition(sword::TOP);
-    while (!list.popError() && !progressWasCancelled()) {
-        tree.append( new CTextRendering::KeyTreeItem(QString::fromLocal8Bit((const char*)list) , module, itemSettings) );
+    while (!list.popError()) {
+        if (!file.append(new CTextRendering::KeyTreeItem(QString::fromLocal8Bit((const char*)list) , module, itemSettings)))
+            return false;
         incProgress();
+        updateProgress();
+        if (progressWasCancelled()) {
+            file.abort();
+            return false;
+        }
 
         list.increment();
     }
 
-    CTextRendering * render = newRenderer(format, addText);
-    const QString text = render->renderKeyTree(tree);
-    delete render;
-
-    if (!progressWasCancelled()) {
-        util::tool::savePlainFile(filename, text, false, (format == HTML) ? QTextCodec::codecForName("UTF-8") : QTextCodec::codecForLocale() );
-        closeProgressDialog();
-        return true;
-    }
-    return false;
+    if (!file.finish())
+        return false;
+    closeProgressDialog();
+    return true;
 }
 
 bool CExportManager::saveKeyList(const QList<CSwordKey*> &list,
@@ -142,29 +321,41 @@ bool CExportManager::saveKeyList(const QList<CSwordKey*> &list,
         return false;
     }
 
-    CTextRendering::KeyTree tree; /// \todo Verify that items in tree are properly freed.
+    QSharedPointer<CTextRendering> render(newRenderer(format, addText));
+    ChunkedExportFile file(render.data(), filename, exportCodec(format));
+    if (!file.open())
+        return false;
+
+    /* The chunks only hold a part of the keys, so the page has to be based
+       on the works of all keys, e.g. for the columns of parallel works: */
+    QList<const CSwordModuleInfo *> modules;
+    Q_FOREACH (const CSwordKey * k, list) {
+        if (!modules.contains(k->module()))
+            modules.append(k->module());
+    }
+    file.setPageModules(modules);
 
     setProgressRange(list.count());
     CTextRendering::KeyTreeItem::Settings itemSettings;
     itemSettings.highlight = false;
 
     QListIterator<CSwordKey*> it(list);
-    while (it.hasNext() && !progressWasCancelled()) {
+    while (it.hasNext()) {
         CSwordKey* k = it.next();
-        tree.append( new CTextRendering::KeyTreeItem(k->key(), k->module(), itemSettings) );
+        if (!file.append(new CTextRendering::KeyTreeItem(k->key(), k->module(), itemSettings)))
+            return false;
         incProgress();
+        updateProgress();
+        if (progressWasCancelled()) {
+            file.abort();
+            return false;
+        }
     };
 
-    CTextRendering * render = newRenderer(format, addText);
-    const QString text = render->renderKeyTree(tree);
-    delete render;
-
-    if (!progressWasCancelled()) {
-        util::tool::savePlainFile(filename, text, false, (format == HTML) ? QTextCodec::codecForName("UTF-8") : QTextCodec::codecForLocale() );
-        closeProgressDialog();
-        return true;
-    }
-    return false;
+    if (!file.finish())
+        return false;
+    closeProgressDialog();
+    return true;
 }
 
 bool CExportManager::copyKey(CSwordKey* key, const Format format, const bool addText) {
@@ -433,15 +624,24 @@ const QString CExportManager::filterString( const Format format ) {
         case HTML:
             return QObject::tr("HTML files") + QString(" (*.html *.htm);;") + QObject::tr("All files") + QString(" (*.*)");
         case Text:
-            return QObject::tr("Text files") + QString(" (*.txt);;") + QObject::tr("All files") + QString(" (*.*)");
+            return QObject::tr("Text files") + QString(" (*.txt);;") + QObject::tr("JSON lines files") + QString(" (*.jsonl);;") + QObject::tr("All files") + QString(" (*.*)");
+        case JSONLines:
+            return QObject::tr("JSON lines files") + QString(" (*.jsonl);;") + QObject::tr("All files") + QString(" (*.*)");
         default:
             return QObject::tr("All files") + QString(" (*.*)");
     }
 }
 
 /** Returns a filename to save a file. */
-const QString CExportManager::getSaveFileName(const Format format) {
-    return QFileDialog::getSaveFileName(0, QObject::tr("Save file"), "", filterString(format), 0);
+const QString CExportManager::getSaveFileName(Format &format) {
+    QString selectedFilter;
+    const QString filename = QFileDialog::getSaveFileName(0, QObject::tr("Save file"), "", filterString(format), &selectedFilter);
+
+    if (format == Text
+        && (selectedFilter.contains("*.jsonl")
+            || filename.endsWith(".jsonl", Qt::CaseInsensitive)))
+        format = JSONLines;
+    return filename;
 }
 
 CTextRendering * CExportManager::newRenderer(const Format format, bool addText) {
@@ -455,6 +655,8 @@ CTextRendering * CExportManager::newRenderer(const Format format, bool addText)
 
     if (format == HTML) {
         return new CHTMLExportRendering(addText, m_displayOptions, filterOptions);
+    } else if (format == JSONLines) {
+        return new CJsonLinesExportRendering(addText, m_displayOptions, filterOptions);
     } else {
         Q_ASSERT(format == Text);
         return new CPlainTextExportRendering(addText, m_displayOptions, filterOptions);
@@ -486,6 +688,12 @@ bool CExportManager::progressWasCancelled() {
     return false;
 }
 
+void CExportManager::updateProgress() {
+    // Handling the events after every entry would slow the export down:
+    if (m_progressDialog && m_progressDialog->value() % 16 == 0)
+        qApp->processEvents(); //do not lock the GUI!
+}
+
 /** Closes the progress dialog immediatly. */
 void CExportManager::closeProgressDialog() {
     if (m_progressDialog) {
@@ -34,7 +34,8 @@ class CExportManager {
         */
         enum Format {
             HTML,
-            Text
+            Text,
+            JSONLines
         };
 
         CExportManager(const bool showProgress = true,
@@ -43,7 +44,7 @@ class CExportManager {
                        const DisplayOptions &displayOptions = btConfig().getDisplayOptions());
         ~CExportManager();
 
-        bool saveKey(CSwordKey* key, const Format format, const bool addText);
+        bool saveKey(CSwordKey* key, Format format, const bool addText);
 
         bool saveKeyList(const sword::ListKey &list,
                          const CSwordModuleInfo *module,
@@ -98,9 +99,10 @@ class CExportManager {
         */
         const QString filterString( const Format format );
         /**
-        * Returns a filename to save a file.
+        * Returns a filename to save a file. When saving as text, the user may
+        * choose to save as JSON lines instead, which updates \a format.
         */
-        const QString getSaveFileName(const Format format);
+        const QString getSaveFileName(Format &format);
 
     private: /* Methods: */
 
@@ -119,6 +121,12 @@ class CExportManager {
 
         bool progressWasCancelled();
 
+        /**
+        * Processes pending events to keep the GUI responsive and to notice
+        * the cancel button of the progress dialog during long exports.
+        */
+        void updateProgress();
+
         /**
         * Closes the progress dialog immediately.
         */
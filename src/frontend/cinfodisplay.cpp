@@ -15,13 +15,15 @@
 #include <QLabel>
 #include <QLayout>
 #include <QRegExp>
+#include <QSet>
 #include <QSize>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QtAlgorithms>
 #include <QMenu>
 
 #include "backend/config/btconfig.h"
-#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/drivers/cswordlexiconmoduleinfo.h"
 #include "backend/keys/cswordkey.h"
 #include "backend/keys/cswordversekey.h"
 #include "backend/managers/referencemanager.h"
@@ -38,11 +40,50 @@
 using namespace Rendering;
 using namespace sword;
 
+namespace {
+
+/** Number of Strong's entries rendered per step by prefetchStrongs(). */
+const int STRONGS_PREFETCH_BATCH = 4;
+
+/** Maximum number of Strong's entries prefetched for a single page. */
+const int STRONGS_PREFETCH_MAX = 300;
+
+/** Milliseconds without hover requests before the next prefetch step. */
+const int STRONGS_PREFETCH_IDLE = 300;
+
+inline QString infoCacheKey(const InfoDisplay::CInfoDisplay::InfoType type,
+                            const CSwordModuleInfo * const module,
+                            const QString & data)
+{
+    return QString::number(type)
+           .append('\x1f').append(module ? module->name() : QString())
+           .append('\x1f').append(data);
+}
+
+/** \returns the cache data of a Strong's entry rendered with \a options. */
+inline QString strongsCacheData(const QString & strong,
+                                const FilterOptions & options)
+{
+    return QString(strong).append('\x1f').append(QString::number(options.toBitmask()));
+}
+
+inline const CSwordModuleInfo * strongsModule(const QString & strong) {
+    return btConfig().getDefaultSwordModuleByType(strong.left(1) == QString("H")
+                                                  ? "standardHebrewStrongsLexicon"
+                                                  : "standardGreekStrongsLexicon");
+}
+
+} // anonymous namespace
+
 namespace InfoDisplay {
 
 CInfoDisplay::CInfoDisplay(BibleTime * parent)
         : QWidget(parent)
         , m_mainWindow(parent)
+        , m_infoCache(500)
+        , m_shownFilterOptions(0u)
+        , m_infoTimer(new QTimer(this))
+        , m_prefetchTimer(new QTimer(this))
 {
     QVBoxLayout * const layout = new QVBoxLayout(this);
     layout->setContentsMargins(2, 2, 2, 2); // Leave small border
@@ -73,6 +114,21 @@ CInfoDisplay::CInfoDisplay(BibleTime * parent)
 
     layout->addWidget(m_htmlPart->view());
 
+    // Only the last of several hover requests arriving in a row is rendered:
+    m_infoTimer->setSingleShot(true);
+    m_infoTimer->setInterval(50);
+    QObject::connect(m_infoTimer, SIGNAL(timeout()),
+                     this,        SLOT(showPendingInfo()));
+
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(STRONGS_PREFETCH_IDLE);
+    QObject::connect(m_prefetchTimer, SIGNAL(timeout()),
+                     this,            SLOT(prefetchPendingStrongs()));
+
+    QObject::connect(CSwordBackend::instance(),
+                     SIGNAL(sigSwordSetupChanged(CSwordBackend::SetupChangedReason)),
+                     this, SLOT(clearCache()));
+
     unsetInfo();
 }
 
@@ -85,6 +141,10 @@ void CInfoDisplay::unsetInfo() {
 }
 
 void CInfoDisplay::setInfo(const QString & renderedData, const QString & lang) {
+    m_infoTimer->stop();
+    m_pendingInfo.clear();
+    m_shownInfo.clear();
+
     CDisplayTemplateMgr * const mgr = CDisplayTemplateMgr::instance();
     Q_ASSERT(mgr != 0);
 
@@ -126,11 +186,37 @@ void CInfoDisplay::setInfo(const InfoType type, const QString & data) {
 
 
 void CInfoDisplay::setInfo(const ListInfoData & list) {
+    setInfo(list, btConfig().getFilterOptions());
+}
+
+void CInfoDisplay::setInfo(const ListInfoData & list,
+                           const FilterOptions & filterOptions)
+{
     // If the widget is hidden it would be inefficient to render and display the data
     if (!isVisible())
         return;
 
+    m_pendingInfo = list;
+    m_pendingFilterOptions = filterOptions;
+    m_infoTimer->start();
+
+    // The prefetching waits until the user stops hovering:
+    if (m_prefetchTimer->isActive())
+        m_prefetchTimer->start();
+}
+
+void CInfoDisplay::showPendingInfo() {
+    const ListInfoData list = m_pendingInfo;
+    const FilterOptions filterOptions = m_pendingFilterOptions;
+    m_pendingInfo.clear();
+
+    // Don't render the info again when hovering over the same item:
+    if (list == m_shownInfo && !list.isEmpty()
+        && filterOptions.toBitmask() == m_shownFilterOptions)
+        return;
+
     if (list.isEmpty()) {
+        m_shownInfo.clear();
         m_htmlPart->setText("<html></html>");
         return;
     }
@@ -141,7 +227,7 @@ void CInfoDisplay::setInfo(const ListInfoData & list) {
     for (ListInfoData::const_iterator it = list.begin(); it != end; ++it) {
         switch ((*it).first) {
             case Lemma:
-                renderedText.append(decodeStrongs((*it).second));
+                renderedText.append(decodeStrongs((*it).second, filterOptions));
                 continue;
             case Morph:
                 renderedText.append(decodeMorph((*it).second));
@@ -169,6 +255,81 @@ void CInfoDisplay::setInfo(const ListInfoData & list) {
         };
     }
     setInfo(renderedText);
+    m_shownInfo = list;
+    m_shownFilterOptions = filterOptions.toBitmask();
+}
+
+void CInfoDisplay::prefetchStrongs(const QString & html,
+                                   const FilterOptions & filterOptions)
+{
+    m_pendingStrongs.clear();
+    m_prefetchTimer->stop();
+    if (!isVisible())
+        return;
+
+    m_prefetchFilterOptions = filterOptions;
+
+    QSet<QString> seen;
+    QRegExp re("lemma=\"([^\"]+)\"");
+    for (int pos = re.indexIn(html);
+         pos != -1 && m_pendingStrongs.size() < STRONGS_PREFETCH_MAX;
+         pos = re.indexIn(html, pos + re.matchedLength()))
+    {
+        Q_FOREACH (const QString & strong, re.cap(1).split('|')) {
+            if (strong.isEmpty() || seen.contains(strong))
+                continue;
+            seen.insert(strong);
+            if (cachedInfo(Lemma, strongsModule(strong),
+                           strongsCacheData(strong, filterOptions)).isNull())
+                m_pendingStrongs.append(strong);
+        }
+    }
+
+    if (!m_pendingStrongs.isEmpty())
+        m_prefetchTimer->start();
+}
+
+void CInfoDisplay::prefetchPendingStrongs() {
+    // A hover request is handled first:
+    if (m_infoTimer->isActive()) {
+        m_prefetchTimer->start();
+        return;
+    }
+
+    /* Sword is not thread-safe, so the entries are rendered in small batches
+       from the event loop while the user doesn't hover over anything: */
+    for (int i = 0; i < STRONGS_PREFETCH_BATCH && !m_pendingStrongs.isEmpty(); i++)
+        decodeStrong(m_pendingStrongs.takeFirst(), m_prefetchFilterOptions);
+
+    if (!m_pendingStrongs.isEmpty())
+        m_prefetchTimer->start();
+}
+
+QString CInfoDisplay::cachedInfo(const InfoType type,
+                                 const CSwordModuleInfo * const module,
+                                 const QString & data) const
+{
+    const QString * const text = m_infoCache.object(infoCacheKey(type, module, data));
+    return text ? *text : QString::null;
+}
+
+QString CInfoDisplay::cacheInfo(const InfoType type,
+                                const CSwordModuleInfo * const module,
+                                const QString & data,
+                                const QString & renderedText)
+{
+    QString * const text = new QString(renderedText);
+    // Store null results as empty strings to distinguish them from misses:
+    if (text->isNull())
+        *text = "";
+    m_infoCache.insert(infoCacheKey(type, module, data), text);
+    return renderedText;
+}
+
+void CInfoDisplay::clearCache() {
+    m_infoCache.clear();
+    m_pendingStrongs.clear();
+    m_shownInfo.clear();
 }
 
 void CInfoDisplay::setInfo(CSwordModuleInfo * const module) {
@@ -234,6 +395,10 @@ const QString CInfoDisplay::decodeCrossReference(const QString & data) {
     }
 
     // Q_ASSERT(module); // why? the existense of the module is tested later
+    const QString cached = cachedInfo(CrossReference, module, data);
+    if (!cached.isNull())
+        return cached;
+
     CTextRendering::KeyTreeItem::Settings settings(
         false,
         CTextRendering::KeyTreeItem::Settings::CompleteShort
@@ -278,11 +443,12 @@ const QString CInfoDisplay::decodeCrossReference(const QString & data) {
     if (module)
         lang = module->language()->abbrev();
 
-    return QString("<div class=\"crossrefinfo\" lang=\"%1\"><h3>%2</h3><div class=\"para\" dir=\"%3\">%4</div></div>")
+    return cacheInfo(CrossReference, module, data,
+        QString("<div class=\"crossrefinfo\" lang=\"%1\"><h3>%2</h3><div class=\"para\" dir=\"%3\">%4</div></div>")
            .arg(lang)
            .arg(tr("Cross references"))
            .arg(module ? ((module->textDirection() == CSwordModuleInfo::LeftToRight) ? "ltr" : "rtl") : "")
-           .arg(renderer.renderKeyTree(tree));
+           .arg(renderer.renderKeyTree(tree)));
 }
 
 /*!
@@ -294,6 +460,11 @@ const QString CInfoDisplay::decodeFootnote(const QString & data) {
     if (!list.count())
         return QString::null;
 
+    // The data contains the module name and the key of the footnote:
+    const QString cached = cachedInfo(Footnote, 0, data);
+    if (!cached.isNull())
+        return cached;
+
     FilterOptions filterOpts;
     filterOpts.footnotes   = true;
     CSwordBackend::instance()->setFilterOptions(filterOpts);
@@ -312,11 +483,10 @@ const QString CInfoDisplay::decodeFootnote(const QString & data) {
 
     QSharedPointer<CSwordKey> key(CSwordKey::createInstance(module));
     key->setKey(keyname);
-    key->renderedText(CSwordKey::ProcessEntryAttributesOnly); // force entryAttributes
+    sword::AttributeTypeList attributes(key->entryAttributes());
 
     const char * const note =
-        module->module()->getEntryAttributes()
-        ["Footnote"][swordFootnote.toLatin1().data()]["body"].c_str();
+        attributes["Footnote"][swordFootnote.toLatin1().data()]["body"].c_str();
 
     QString text = module->isUnicode() ? QString::fromUtf8(note) : QString(note);
     text = QString::fromUtf8(module->module()->renderText(
@@ -324,46 +494,69 @@ const QString CInfoDisplay::decodeFootnote(const QString & data) {
                                  ? static_cast<const char *>(text.toUtf8())
                                  : static_cast<const char *>(text.toLatin1())));
 
-    return QString("<div class=\"footnoteinfo\" lang=\"%1\"><h3>%2</h3><p>%3</p></div>")
+    return cacheInfo(Footnote, 0, data,
+        QString("<div class=\"footnoteinfo\" lang=\"%1\"><h3>%2</h3><p>%3</p></div>")
            .arg(module->language()->abbrev())
            .arg(tr("Footnote"))
-           .arg(text);
+           .arg(text));
 }
 
-const QString CInfoDisplay::decodeStrongs(const QString & data) {
+const QString CInfoDisplay::decodeStrongs(const QString & data,
+                                          const FilterOptions & filterOptions)
+{
     QStringList strongs = data.split("|");
     QString ret;
 
     QStringList::const_iterator end = strongs.end();
-    for (QStringList::const_iterator it = strongs.begin(); it != end; ++it) {
-        CSwordModuleInfo * const module = btConfig().getDefaultSwordModuleByType
-                                         (
-                                             ((*it).left(1) == QString("H")) ?
-                                             "standardHebrewStrongsLexicon" :
-                                             "standardGreekStrongsLexicon"
-                                         );
+    for (QStringList::const_iterator it = strongs.begin(); it != end; ++it)
+        ret.append(decodeStrong(*it, filterOptions));
 
-        QString text;
-        if (module) {
-            QSharedPointer<CSwordKey> key(CSwordKey::createInstance(module));
-            key->setKey((*it).mid(1)); // skip H or G (language sign), will have to change later if we have better modules
-            text = key->renderedText();
+    return ret;
+}
+
+const QString CInfoDisplay::decodeStrong(const QString & strong,
+                                         const FilterOptions & filterOptions)
+{
+    const CSwordModuleInfo * const module = strongsModule(strong);
+
+    const QString cacheData = strongsCacheData(strong, filterOptions);
+    const QString cached = cachedInfo(Lemma, module, cacheData);
+    if (!cached.isNull())
+        return cached;
+
+    QString text;
+    if (module) {
+        // Skip H or G (language sign), will have to change later if we have better modules:
+        QString keyName(strong.mid(1));
+
+        /* Look plain numbers up in the Strong's table of the lexicon. Numbers
+           which aren't in the table are looked up as before: */
+        bool isNumber;
+        const int number = keyName.toInt(&isNumber);
+        const CSwordLexiconModuleInfo * const lexicon =
+                qobject_cast<const CSwordLexiconModuleInfo *>(module);
+        if (isNumber && lexicon) {
+            const QString strongsKey = lexicon->strongsKey(number);
+            if (!strongsKey.isNull())
+                keyName = strongsKey;
         }
-        //if the module could not be found just display an empty lemma info
 
-        QString lang = "en";  // default english
-        if (module)
-            lang = module->language()->abbrev();
-        ret.append(
-            QString("<div class=\"strongsinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
-            .arg(lang)
-            .arg(tr("Strongs"))
-            .arg(*it)
-            .arg(text)
-        );
+        QSharedPointer<CSwordKey> key(CSwordKey::createInstance(module));
+        key->setKey(keyName);
+        CSwordBackend::instance()->setFilterOptions(filterOptions);
+        text = key->renderedText();
     }
+    //if the module could not be found just display an empty lemma info
 
-    return ret;
+    QString lang = "en";  // default english
+    if (module)
+        lang = module->language()->abbrev();
+    return cacheInfo(Lemma, module, cacheData,
+        QString("<div class=\"strongsinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
+        .arg(lang)
+        .arg(tr("Strongs"))
+        .arg(strong)
+        .arg(text));
 }
 
 const QString CInfoDisplay::decodeMorph(const QString & data) {
@@ -372,6 +565,12 @@ const QString CInfoDisplay::decodeMorph(const QString & data) {
 
     Q_FOREACH (QString morph, morphs) {
         //qDebug() << "CInfoDisplay::decodeMorph, morph: " << morph;
+        const QString cached = cachedInfo(Morph, 0, morph);
+        if (!cached.isNull()) {
+            ret.append(cached);
+            continue;
+        }
+
         CSwordModuleInfo * module = 0;
         bool skipFirstChar = false;
         QString value = "";
@@ -432,12 +631,13 @@ const QString CInfoDisplay::decodeMorph(const QString & data) {
         QString lang = "en";  // default to english
         if (module)
             lang = module->language()->abbrev();
-        ret.append(QString("<div class=\"morphinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
+        ret.append(cacheInfo(Morph, 0, morph,
+                   QString("<div class=\"morphinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
                     .arg(lang)
                     .arg(tr("Morphology"))
                     .arg(value)
                     .arg(text)
-                  );
+                  ));
     }
 
     return ret;
@@ -448,16 +648,21 @@ const QString CInfoDisplay::getWordTranslation(const QString & data) {
     if (!module)
         return QString::null;
 
+    const QString cached = cachedInfo(WordTranslation, module, data);
+    if (!cached.isNull())
+        return cached;
+
     QSharedPointer<CSwordKey> key(CSwordKey::createInstance(module));
     key->setKey(data);
     if (key->key().toUpper() != data.toUpper()) //key not present in the lexicon
-        return QString::null;
+        return cacheInfo(WordTranslation, module, data, QString::null);
 
-    return QString("<div class=\"translationinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
+    return cacheInfo(WordTranslation, module, data,
+           QString("<div class=\"translationinfo\" lang=\"%1\"><h3>%2: %3</h3><p>%4</p></div>")
                   .arg(module->language()->abbrev())
                   .arg(tr("Word lookup"))
                   .arg(data)
-                  .arg(key->renderedText());
+                  .arg(key->renderedText()));
 }
 
 QSize CInfoDisplay::sizeHint() const {
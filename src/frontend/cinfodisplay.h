@@ -14,14 +14,18 @@
 
 #include <QWidget>
 
+#include <QCache>
 #include <QList>
 #include <QPair>
+#include <QStringList>
 #include "backend/rendering/ctextrendering.h"
+#include "btglobal.h"
 
 
 class CReadDisplay;
 class QAction;
 class QSize;
+class QTimer;
 class BibleTime;
 
 
@@ -56,31 +60,80 @@ public: /* Methods: */
                  const QString & lang = QString());
     void setInfo(const InfoType, const QString & data);
     void setInfo(const ListInfoData &);
+
+    /**
+      Shows the given infos after a short delay. Strong's entries are rendered
+      with \a filterOptions, which should be the options of the display the
+      infos come from.
+    */
+    void setInfo(const ListInfoData & list, const FilterOptions & filterOptions);
+
     QSize sizeHint() const;
 
+    /**
+      Renders the Strong's entries of all lemma attributes found in the given
+      HTML with \a filterOptions while the user doesn't hover over anything,
+      so hovering over the words is fast later on.
+    */
+    void prefetchStrongs(const QString & html, const FilterOptions & filterOptions);
+
 public slots:
 
     void setInfo(CSwordModuleInfo * module);
 
+    /** Drops all cached renderings, e.g. after the default modules changed. */
+    void clearCache();
+
 private: /* Methods: */
 
     const QString decodeAbbreviation(const QString & data);
     const QString decodeCrossReference(const QString & data);
     const QString decodeFootnote(const QString & data);
-    const QString decodeStrongs(const QString & data);
+    const QString decodeStrongs(const QString & data,
+                                const FilterOptions & filterOptions);
+    const QString decodeStrong(const QString & strong,
+                               const FilterOptions & filterOptions);
     const QString decodeMorph(const QString & data);
     const QString getWordTranslation(const QString & data);
 
+    /**
+      \returns the cached rendering of the given info or a null string if it
+               is not in the cache.
+    */
+    QString cachedInfo(InfoType type,
+                       const CSwordModuleInfo * module,
+                       const QString & data) const;
+    QString cacheInfo(InfoType type,
+                      const CSwordModuleInfo * module,
+                      const QString & data,
+                      const QString & renderedText);
+
 private slots:
 
     void lookupInfo(const QString &, const QString &);
     void selectAll();
+    void showPendingInfo();
+    void prefetchPendingStrongs();
 
 private: /* Fields: */
 
     CReadDisplay * m_htmlPart;
     BibleTime * m_mainWindow;
 
+    /** The rendered infos keyed by type, module name and data. */
+    QCache<QString, QString> m_infoCache;
+
+    /** Hover requests are collected here and shown by showPendingInfo(). */
+    ListInfoData m_pendingInfo;
+    FilterOptions m_pendingFilterOptions;
+    ListInfoData m_shownInfo;
+    quint32 m_shownFilterOptions;
+    QTimer * m_infoTimer;
+
+    QStringList m_pendingStrongs;
+    FilterOptions m_prefetchFilterOptions;
+    QTimer * m_prefetchTimer;
+
 };
 
 } //end of InfoDisplay namespace
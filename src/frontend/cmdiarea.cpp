@@ -28,6 +28,13 @@ inline CDisplayWindow * getDisplayWindow(const QMdiSubWindow * const mdiWindow)
     return qobject_cast<CDisplayWindow *>(mdiWindow->widget());
 }
 
+/** \returns whether nothing of the subwindow can be seen at the moment. */
+inline bool isWindowHidden(const QMdiSubWindow * const mdiWindow) {
+    return mdiWindow->isHidden()
+           || mdiWindow->isMinimized()
+           || mdiWindow->visibleRegion().isEmpty();
+}
+
 inline QWebView * getWebViewFromDisplayWindow(const CDisplayWindow * const displayWindow) {
     if (!displayWindow)
         return NULL;
@@ -45,9 +52,23 @@ CMDIArea::CMDIArea(BibleTime *parent)
         , m_mdiArrangementMode(ArrangementModeManual)
         , m_activeWindow(0)
         , m_bibleTime(parent)
+        , m_lookupTimer(new QTimer(this))
+        , m_deferredLookupTimer(new QTimer(this))
 {
     Q_ASSERT(parent != 0);
 
+    // Coalesce the key changes of synchronized windows:
+    m_lookupTimer->setSingleShot(true);
+    m_lookupTimer->setInterval(40);
+    bool ok = connect(m_lookupTimer, SIGNAL(timeout()),
+                      this, SLOT(processVisibleLookups()));
+    Q_ASSERT(ok);
+    m_deferredLookupTimer->setSingleShot(true);
+    m_deferredLookupTimer->setInterval(500);
+    ok = connect(m_deferredLookupTimer, SIGNAL(timeout()),
+                 this, SLOT(processDeferredLookups()));
+    Q_ASSERT(ok);
+
     #if QT_VERSION >= 0x040500
     // Set document-style tabs (for Mac):
     setDocumentMode(true);
@@ -300,6 +321,65 @@ QList<QMdiSubWindow*> CMDIArea::usableWindowList() const {
     return ret;
 }
 
+void CMDIArea::scheduleLookup(CDisplayWindow *window, const QString &key) {
+    Q_ASSERT(window != 0);
+    if (!m_scheduledLookups.contains(window))
+        connect(window, SIGNAL(destroyed(QObject*)),
+                this,   SLOT(slotScheduledWindowDestroyed(QObject*)),
+                Qt::UniqueConnection);
+    m_scheduledLookups.insert(window, key);
+    m_deferredLookupTimer->stop();
+    m_lookupTimer->start();
+}
+
+void CMDIArea::processVisibleLookups() {
+    /* Only windows which are still in the list of subwindows are looked up,
+       requests for windows closed in the meantime are dropped below. */
+    Q_FOREACH (QMdiSubWindow * const w, subWindowList()) {
+        if (m_scheduledLookups.isEmpty())
+            break;
+        if (isWindowHidden(w))
+            continue;
+
+        CDisplayWindow * const d = getDisplayWindow(w);
+        const QHash<CDisplayWindow*, QString>::iterator it = m_scheduledLookups.find(d);
+        if (it == m_scheduledLookups.end())
+            continue;
+
+        const QString key = it.value();
+        m_scheduledLookups.erase(it);
+        if (d->key() == 0 || d->key()->key() != key)
+            d->lookupKey(key);
+    }
+
+    if (!m_scheduledLookups.isEmpty())
+        m_deferredLookupTimer->start();
+}
+
+void CMDIArea::processDeferredLookups() {
+    Q_FOREACH (QMdiSubWindow * const w, subWindowList()) {
+        if (m_scheduledLookups.isEmpty())
+            break;
+
+        CDisplayWindow * const d = getDisplayWindow(w);
+        const QHash<CDisplayWindow*, QString>::iterator it = m_scheduledLookups.find(d);
+        if (it == m_scheduledLookups.end())
+            continue;
+
+        const QString key = it.value();
+        m_scheduledLookups.erase(it);
+        if (d->key() == 0 || d->key()->key() != key)
+            d->lookupKey(key);
+    }
+    m_scheduledLookups.clear();
+}
+
+void CMDIArea::slotScheduledWindowDestroyed(QObject *window) {
+    /* The window is only used as the key of the hash here, another window
+       created at the same address must not get its lookup: */
+    m_scheduledLookups.remove(static_cast<CDisplayWindow*>(window));
+}
+
 QWebView* CMDIArea::getActiveWebView()
 {
     QMdiSubWindow* activeMdiWindow = activeSubWindow();
@@ -400,6 +480,10 @@ bool CMDIArea::eventFilter(QObject *o, QEvent *e) {
             // Check if subwindow was minimized or de-minimized:
             if ((newState ^ oldState) & Qt::WindowMinimized) {
                 triggerWindowUpdate();
+
+                // A restored window should not wait for its deferred lookup:
+                if (m_scheduledLookups.contains(getDisplayWindow(w)))
+                    m_lookupTimer->start();
             }
             break;
         }
@@ -14,12 +14,14 @@
 
 #include <QMdiArea>
 
+#include <QHash>
 #include <QList>
 
 
 class BibleTime;
 class CSwordModuleInfo;
 class CDisplayWindow;
+class QTimer;
 class QWebView;
 
 /**
@@ -92,6 +94,14 @@ class CMDIArea: public QMdiArea {
         */
         void enableWindowMinMaxFlags(bool enable);
 
+        /**
+          Looks up \a key in \a window after a short delay. Requests which
+          arrive in the meantime are coalesced, so each window only looks up
+          the last key it was given. Visible windows are served first, while
+          minimized or covered windows are updated later.
+        */
+        void scheduleLookup(CDisplayWindow *window, const QString &key);
+
     public slots:
 
         /**
@@ -174,6 +184,15 @@ class CMDIArea: public QMdiArea {
         */
         void closeTab(int i);
 
+        /** Performs the lookups of the visible windows scheduled by scheduleLookup(). */
+        void processVisibleLookups();
+
+        /** Performs all remaining lookups scheduled by scheduleLookup(). */
+        void processDeferredLookups();
+
+        /** Drops the lookup scheduled for a display window which is destroyed. */
+        void slotScheduledWindowDestroyed(QObject *window);
+
     protected: /* Fields: */
 
         MDIArrangementMode m_mdiArrangementMode;
@@ -183,6 +202,10 @@ class CMDIArea: public QMdiArea {
         CDisplayWindow* m_activeWindow;
         BibleTime* m_bibleTime;
 
+        QHash<CDisplayWindow*, QString> m_scheduledLookups;
+        QTimer* m_lookupTimer;
+        QTimer* m_deferredLookupTimer;
+
 }; /* class CMDIArea */
 
 #endif
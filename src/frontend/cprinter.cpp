@@ -59,7 +59,7 @@ QString CPrinter::entryLink(const KeyTreeItem &item,
     Q_ASSERT(module);
     if (module->type() == CSwordModuleInfo::Bible) {
         CSwordVerseKey vk(module);
-        vk.setKey(item.key());
+        item.positionKey(&vk);
         switch (item.settings().keyRenderingFace) {
             case KeyTreeItem::Settings::CompleteShort:
                 return QString::fromUtf8(vk.getShortText());
@@ -78,27 +78,28 @@ QString CPrinter::entryLink(const KeyTreeItem &item,
     return item.key();
 }
 
-QString CPrinter::renderEntry(const KeyTreeItem &i, CSwordKey * key) {
+void CPrinter::renderEntry(Rendering::BtRenderSink &out,
+                           const KeyTreeItem &i,
+                           CSwordKey * key)
+{
     Q_UNUSED(key);
 
     const CPrinter::KeyTreeItem* printItem = dynamic_cast<const CPrinter::KeyTreeItem*>(&i);
     Q_ASSERT(printItem);
 
     if (printItem && printItem->hasAlternativeContent()) {
-        QString ret = QString::fromLatin1("<div class=\"entry\"><div class=\"rangeheading\">%1</div>").arg(printItem->getAlternativeContent());
-
-        if (!i.childList()->isEmpty()) {
-            KeyTree const * tree = i.childList();
+        out.append("<div class=\"entry\"><div class=\"rangeheading\">")
+           .append(printItem->getAlternativeContent())
+           .append("</div>");
 
-            Q_FOREACH (const KeyTreeItem * const c, *tree) {
-                ret.append( CDisplayRendering::renderEntry( *c ) );
-            }
+        Q_FOREACH (const KeyTreeItem * const c, *i.childList()) {
+            CDisplayRendering::renderEntry(out, *c);
         }
 
-        ret.append("</div>");
-        return ret;
+        out.append("</div>");
+        return;
     }
-    return CDisplayRendering::renderEntry(i);
+    CDisplayRendering::renderEntry(out, i);
 }
 
 QString CPrinter::finishText(const QString &text, const KeyTree &tree) {
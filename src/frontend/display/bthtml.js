@@ -14,11 +14,24 @@ var eventType = "";
 var prevNode = 0;
 var currentNode = 0;
 var timeOutId = -1;
+var chunksEnabled = false;
+var chunkRequestPending = false;
+var atFirstChunk = false;
+var atLastChunk = false;
+var pageChunkKey = "";
+var lastScrollOffset = 0;
 
 // Scroll window to html anchor
 function gotoAnchor(anchor)
 {
     document.location=document.location + "#" + anchor;
+    scrolledByPage();
+}
+
+// Remembers a scroll position which was not set by the user
+function scrolledByPage()
+{
+    lastScrollOffset = window.pageYOffset;
 }
 
 // Mouse button clicked handler
@@ -119,12 +132,221 @@ function timerEvent()
     }
 }
 
+// Wraps the displayed content into the first chunk of a continuously scrolled view
+function setupChunks(key, options)
+{
+    var content = document.getElementById("content");
+    if (!content || chunksEnabled)
+        return;
+
+    var chunk = document.createElement("div");
+    chunk.className = "chunk";
+    chunk.setAttribute("chunkkey", key);
+    chunk.setAttribute("chunkoptions", options);
+    pageChunkKey = key;
+    while (content.firstChild)
+        chunk.appendChild(content.firstChild);
+    content.appendChild(chunk);
+
+    // Only scrolling by the user loads further chunks, loading the page doesn't
+    chunksEnabled = true;
+    scrolledByPage();
+    window.addEventListener ('scroll', function (eve) { userScrollHandler (); }, false);
+    document.addEventListener ('mousewheel', function (eve) { scrollHandler (eve.wheelDelta < 0); }, false);
+}
+
+// Handles scroll events, but ignores the ones for positions set by the page itself
+function userScrollHandler()
+{
+    var offset = window.pageYOffset;
+    if (offset == lastScrollOffset)
+        return;
+
+    var forward = offset > lastScrollOffset;
+    lastScrollOffset = offset;
+    scrollHandler(forward);
+}
+
+// Requests the adjacent chunk in the scrolling direction if less than one screen of content is left there
+function scrollHandler(forward)
+{
+    if (!chunksEnabled || chunkRequestPending)
+        return;
+
+    var content = document.getElementById("content");
+    var viewHeight = window.innerHeight;
+    var top = window.pageYOffset;
+    if (forward)
+    {
+        if (!atLastChunk && document.body.scrollHeight - (top + viewHeight) < viewHeight)
+        {
+            chunkRequestPending = true;
+            btHtmlJsObject.requestChunk(content.lastChild.getAttribute("chunkkey"), true);
+        }
+    }
+    else if (!atFirstChunk && top < viewHeight)
+    {
+        chunkRequestPending = true;
+        btHtmlJsObject.requestChunk(content.firstChild.getAttribute("chunkkey"), false);
+    }
+}
+
+// Inserts a chunk and unloads the chunks far away from the visible area
+function insertChunk(key, html, forward, options)
+{
+    chunkRequestPending = false;
+    var content = document.getElementById("content");
+    if (!chunksEnabled || !content)
+        return;
+
+    if (!key || key.length == 0)
+    {
+        if (forward)
+            atLastChunk = true;
+        else
+            atFirstChunk = true;
+        return;
+    }
+
+    var chunk = document.createElement("div");
+    chunk.className = "chunk";
+    chunk.setAttribute("chunkkey", key);
+    chunk.setAttribute("chunkoptions", options);
+    chunk.innerHTML = html;
+
+    var viewHeight = window.innerHeight;
+    if (forward)
+    {
+        content.appendChild(chunk);
+        while (content.childNodes.length > 1
+               && content.firstChild.offsetTop + content.firstChild.offsetHeight < window.pageYOffset - 3 * viewHeight)
+        {
+            var height = content.firstChild.offsetHeight;
+            content.removeChild(content.firstChild);
+            window.scrollBy(0, -height);
+            atFirstChunk = false;
+        }
+    }
+    else
+    {
+        content.insertBefore(chunk, content.firstChild);
+        window.scrollBy(0, chunk.offsetHeight);
+        while (content.childNodes.length > 1
+               && content.lastChild.offsetTop > window.pageYOffset + 4 * viewHeight)
+        {
+            content.removeChild(content.lastChild);
+            atLastChunk = false;
+        }
+    }
+    // Keeping the visible content in place is no scrolling by the user:
+    scrolledByPage();
+    scrollHandler(forward);
+}
+
+// Returns the element holding the entries of the loaded page, or null if they
+// were unloaded while scrolling
+function pageEntries()
+{
+    var content = document.getElementById("content");
+    if (!content || !chunksEnabled)
+        return content;
+
+    for (var chunk = content.firstChild; chunk; chunk = chunk.nextSibling)
+    {
+        if (chunk.getAttribute("chunkkey") == pageChunkKey)
+            return chunk;
+    }
+    return null;
+}
+
+// Number of chunks in the view, 1 without continuous scrolling
+function loadedChunkCount()
+{
+    var content = document.getElementById("content");
+    if (!content || !chunksEnabled)
+        return 1;
+    return content.children.length;
+}
+
+// Records the options the entries of the loaded page are rendered with now
+function setPageOptions(options)
+{
+    var entries = pageEntries();
+    if (entries && chunksEnabled)
+        entries.setAttribute("chunkoptions", options);
+}
+
+// Number of top level entries of the loaded page, -1 if they are not available
+function entryCount()
+{
+    var entries = pageEntries();
+    return entries ? entries.children.length : -1;
+}
+
+// Replaces a single top level entry of the loaded page
+function replaceEntry(index, html)
+{
+    var entries = pageEntries();
+    if (!entries || index >= entries.children.length)
+        return false;
+    entries.children[index].outerHTML = html;
+    return true;
+}
+
+// Returns whether the loaded page still holds the entry with the given anchor
+function hasEntry(anchor)
+{
+    var entries = pageEntries();
+    if (!entries || entryCount() <= 0)
+        return false;
+
+    var anchors = document.getElementsByName(anchor);
+    for (var i = 0; i < anchors.length; i++)
+    {
+        if (entries.contains(anchors[i]))
+            return true;
+    }
+    return false;
+}
+
+// Moves the highlighting of the current entry to the entry with the given anchor
+// Returns false without changes if the entry is not loaded or its chunk was
+// rendered with other options
+function setCurrentEntry(anchor, options)
+{
+    if (!hasEntry(anchor))
+        return false;
+    if (chunksEnabled && pageEntries().getAttribute("chunkoptions") != options)
+        return false;
+
+    var current = document.querySelectorAll(".currententry");
+    for (var i = 0; i < current.length; i++)
+        current[i].className = current[i].className.replace(/\bcurrententry\b/, "entry");
+
+    var content = document.getElementById("content");
+    var anchors = document.getElementsByName(anchor);
+    for (var i = 0; i < anchors.length; i++)
+    {
+        for (var node = anchors[i].parentNode; node && node != content; node = node.parentNode)
+        {
+            if (/\bentry\b/.test(node.className))
+            {
+                node.className = node.className.replace(/\bentry\b/, "currententry");
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 document.getElementsByTagName("body")[0].addEventListener ('mousedown', function (eve) { mouseDownHandler (eve); }, true);
 document.getElementsByTagName("body")[0].addEventListener ('mousemove', function (eve) { mouseMoveHandler (eve); }, true);
 document.getElementsByTagName("body")[0].addEventListener ('click',     function (eve) { mouseClickHandler (eve); }, true);
 
 btHtmlJsObject.startTimer.connect(this, this.startTimer);
 btHtmlJsObject.gotoAnchor.connect(this, this.gotoAnchor);
+btHtmlJsObject.setupChunks.connect(this, this.setupChunks);
+btHtmlJsObject.insertChunk.connect(this, this.insertChunk);
 
 ;
 
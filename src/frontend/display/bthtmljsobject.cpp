@@ -18,6 +18,7 @@
 #include "frontend/cdragdrop.h"
 #include "frontend/cinfodisplay.h"
 #include "frontend/display/bthtmlreaddisplay.h"
+#include "frontend/displaywindow/cdisplaywindow.h"
 #include "bibletime.h"
 
 
@@ -40,6 +41,28 @@ void BtHtmlJsObject::moveToAnchor(const QString& anchor) {
     emit gotoAnchor(anchor);
 }
 
+// Make the displayed content the first chunk of a continuously scrolled view
+void BtHtmlJsObject::startChunks(const QString& key, const QString& optionsId) {
+    // Call setupChunks in Javascript
+    emit setupChunks(key, optionsId);
+}
+
+// Called from javascript scrollHandler() in bthtml.js when the view reaches
+// the first or last loaded chunk
+void BtHtmlJsObject::requestChunk(const QString& key, bool forward) {
+    /* Render the chunk outside of the javascript call. If the page is reloaded
+       before that, this object is deleted and the request is dropped. */
+    QMetaObject::invokeMethod(this, "loadChunk", Qt::QueuedConnection,
+                              Q_ARG(QString, key), Q_ARG(bool, forward));
+}
+
+void BtHtmlJsObject::loadChunk(const QString& key, bool forward) {
+    QString chunkKey;
+    QString optionsId;
+    const QString html = m_display->adjacentChunk(key, forward, chunkKey, optionsId);
+    emit insertChunk(chunkKey, html, forward, optionsId);
+}
+
 void BtHtmlJsObject::mouseDownLeft(const QString& url, const int& x, const int& y) {
     m_dndData.mousePressed = true;
     m_dndData.isDragging = false;
@@ -137,8 +160,15 @@ void BtHtmlJsObject::timeOutEvent(const QString & attributes) {
         }
     }
     // Update the mag if valid attributes were found
-    if (!(infoList.isEmpty()))
-        BibleTime::instance()->infoDisplay()->setInfo(infoList);
+    if (!(infoList.isEmpty())) {
+        CDisplayWindow * const window = m_display->parentWindow();
+        if (window != 0) {
+            BibleTime::instance()->infoDisplay()->setInfo(infoList,
+                                                          window->filterOptions());
+        } else {
+            BibleTime::instance()->infoDisplay()->setInfo(infoList);
+        }
+    }
 }
 
 // clearing the previous attribute effectively stops any time out event
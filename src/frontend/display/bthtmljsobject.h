@@ -27,6 +27,7 @@ class BtHtmlJsObject: public QObject {
 
         void moveToAnchor(const QString& anchor);
         void clearPrevAttribute();
+        void startChunks(const QString& key, const QString& optionsId);
 
     public slots:
         void mouseMoveEvent(const QString& attributes, const int& x, const int& y, const bool& shiftKey);
@@ -34,11 +35,18 @@ class BtHtmlJsObject: public QObject {
         void mouseDownLeft(const QString& url, const int& X, const int& Y);
         void mouseDownRight(const QString& url, const QString& lemma);
         void timeOutEvent(const QString& attributes);
+        void requestChunk(const QString& key, bool forward);
+
+    private slots:
+        void loadChunk(const QString& key, bool forward);
 
     signals:
         void startTimer(int time);
         void mouseMoveAttribute(const QString& attrName, const QString& attrValue);
         void gotoAnchor(const QString& anchor);
+        void setupChunks(const QString& key, const QString& optionsId);
+        void insertChunk(const QString& key, const QString& html, bool forward,
+                         const QString& optionsId);
         void selectAll();
 
     private:
@@ -12,6 +12,8 @@
 #include <QSharedPointer>
 #include <QMenu>
 #include <QString>
+#include <QStringList>
+#include <QVariant>
 #include "backend/keys/cswordkey.h"
 #include "backend/managers/referencemanager.h"
 #include "bibletime.h"
@@ -29,8 +31,111 @@ using namespace InfoDisplay;
 
 static QString javascript; // Initialized from file bthtml.js
 
+namespace {
+
+/**
+  Finds the content of the <div id="content"> element of a page which was
+  filled from a display template.
+  \returns whether the content was found in [begin, end).
+*/
+bool findPageContent(const QString & page, int & begin, int & end) {
+    begin = page.indexOf("<div id=\"content\"");
+    if (begin < 0)
+        return false;
+    begin = page.indexOf('>', begin) + 1;
+    end = page.lastIndexOf("</div>", page.lastIndexOf("</body>"));
+    return begin > 0 && end >= begin;
+}
+
+QString pageContent(const QString & page) {
+    int begin;
+    int end;
+    if (!findPageContent(page, begin, end))
+        return QString::null;
+    return page.mid(begin, end - begin);
+}
+
+/**
+  Splits the content of a page into its top level <div> elements.
+  \returns an empty list if there is anything else than <div> elements and
+           whitespace on the top level.
+*/
+QStringList topLevelEntries(const QString & content) {
+    QStringList entries;
+    int depth = 0;
+    int entryBegin = 0;
+    int pos = 0;
+    while (pos < content.size()) {
+        const int tag = content.indexOf('<', pos);
+        if (depth == 0
+            && !content.mid(pos, (tag < 0 ? content.size() : tag) - pos).trimmed().isEmpty())
+            return QStringList();
+        if (tag < 0)
+            break;
+
+        const int tagEnd = content.indexOf('>', tag);
+        if (tagEnd < 0)
+            return QStringList();
+
+        if (content.midRef(tag, 5) == QLatin1String("</div")) {
+            if (--depth < 0)
+                return QStringList();
+            if (depth == 0)
+                entries.append(content.mid(entryBegin, tagEnd + 1 - entryBegin));
+        }
+        else if (content.midRef(tag, 4) == QLatin1String("<div")
+                 && (content.at(tag + 4) == ' ' || tag + 4 == tagEnd))
+        {
+            if (content.at(tagEnd - 1) != '/') {
+                if (depth == 0)
+                    entryBegin = tag;
+                ++depth;
+            }
+        }
+        else if (depth == 0) {
+            return QStringList();
+        }
+        pos = tagEnd + 1;
+    }
+    return depth == 0 ? entries : QStringList();
+}
+
+/** Adds the script of bthtml.js to the end of the page body. */
+QString withJavascript(const QString & page) {
+    QString jsText = page;
+    jsText.replace(
+        QString("</body>"),
+        QString("<script  type=\"text/javascript\">").append(javascript).append("</script></body>")
+    );
+    return jsText;
+}
+
+/** Quotes a string for use as a javascript string literal. */
+QString javascriptString(const QString & text) {
+    QString quoted;
+    quoted.reserve(text.size() + text.size() / 8 + 2);
+    quoted.append('"');
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        switch (c.unicode()) {
+            case '\\': quoted.append("\\\\"); break;
+            case '"': quoted.append("\\\""); break;
+            case '\n': quoted.append("\\n"); break;
+            case '\r': quoted.append("\\r"); break;
+            case 0x2028: quoted.append("\\u2028"); break;
+            case 0x2029: quoted.append("\\u2029"); break;
+            default: quoted.append(c); break;
+        }
+    }
+    quoted.append('"');
+    return quoted;
+}
+
+} // anonymous namespace
+
 BtHtmlReadDisplay::BtHtmlReadDisplay(CReadWindow* readWindow, QWidget* parentWidget)
-        : QWebPage(parentWidget), CReadDisplay(readWindow), m_magTimerId(0), m_view(0), m_jsObject(0)
+        : QWebPage(parentWidget), CReadDisplay(readWindow), m_magTimerId(0), m_view(0), m_jsObject(0),
+          m_loaded(false)
 
 {
     settings()->setAttribute(QWebSettings::JavascriptEnabled, true);
@@ -188,13 +293,12 @@ const QString BtHtmlReadDisplay::text( const CDisplay::TextType format, const CD
 
 // Puts html text and javascript into QWebView
 void BtHtmlReadDisplay::setText( const QString& newText ) {
+    m_pageText = newText;
+    m_pageId = QString::null;
+    m_optionsId = QString::null;
+    m_loaded = false;
 
-    QString jsText = newText;
-
-    jsText.replace(
-        QString("</body>"),
-        QString("<script  type=\"text/javascript\">").append(javascript).append("</script></body>")
-    );
+    const QString jsText = withJavascript(newText);
 
     // Disconnect any previous connections and connect to slot that loads the javascript object
     QWebFrame* frame = mainFrame();
@@ -234,6 +338,8 @@ void BtHtmlReadDisplay::selectAll() {
 void BtHtmlReadDisplay::moveToAnchor( const QString& anchor ) {
 #if QT_VERSION >= 0x040700
     mainFrame()->scrollToAnchor(anchor);
+    // Scrolling to the anchor must not load adjacent chunks like scrolling by the user:
+    mainFrame()->evaluateJavaScript("scrolledByPage()");
 #else
     slotGoToAnchor(anchor);
 #endif
@@ -255,8 +361,99 @@ void BtHtmlReadDisplay::openFindTextDialog() {
     bibleTime->openFindWidget();
 }
 
+QString BtHtmlReadDisplay::adjacentChunk(const QString& key, bool forward,
+                                         QString& chunkKey, QString& optionsId)
+{
+    chunkKey = QString::null;
+    optionsId = QString::null;
+    CReadWindow* const window = dynamic_cast<CReadWindow*>(parentWindow());
+    if (window == 0)
+        return QString::null;
+
+    const QString newKey = window->adjacentChunkKey(key, forward);
+    if (newKey.isNull())
+        return QString::null;
+
+    QString content = pageContent(window->chunkText(newKey));
+    if (!content.isNull()) {
+        // Only the entry of the current key is highlighted, not the ones around:
+        content.replace("\"currententry\"", "\"entry\"");
+        chunkKey = newKey;
+        optionsId = window->optionsId();
+    }
+    return content;
+}
+
+void BtHtmlReadDisplay::setPageId(const QString& pageId, const QString& optionsId) {
+    m_pageId = pageId;
+    m_optionsId = optionsId;
+    if (m_loaded)
+        mainFrame()->evaluateJavaScript(
+                QString("setPageOptions(%1)").arg(javascriptString(optionsId)));
+}
+
+bool BtHtmlReadDisplay::setCurrentEntry(const QString& anchor, const QString& optionsId) {
+    if (!m_loaded)
+        return false;
+    return mainFrame()->evaluateJavaScript(
+            QString("setCurrentEntry(%1, %2)").arg(javascriptString(anchor))
+                                              .arg(javascriptString(optionsId))).toBool();
+}
+
+bool BtHtmlReadDisplay::updateEntries(const QString& newText) {
+    if (!m_loaded)
+        return false;
+
+    int oldBegin, oldEnd, newBegin, newEnd;
+    if (!findPageContent(m_pageText, oldBegin, oldEnd)
+        || !findPageContent(newText, newBegin, newEnd))
+        return false;
+
+    // Everything around the entries, e.g. the style sheets, must be unchanged:
+    if (m_pageText.leftRef(oldBegin) != newText.leftRef(newBegin)
+        || m_pageText.midRef(oldEnd) != newText.midRef(newEnd))
+        return false;
+
+    const QStringList oldEntries = topLevelEntries(m_pageText.mid(oldBegin, oldEnd - oldBegin));
+    const QStringList newEntries = topLevelEntries(newText.mid(newBegin, newEnd - newBegin));
+    if (oldEntries.isEmpty() || oldEntries.count() != newEntries.count())
+        return false;
+
+    // Only the chunk of the page is patched, the page is loaded again if there are more:
+    if (mainFrame()->evaluateJavaScript("loadedChunkCount()").toInt() != 1
+        || mainFrame()->evaluateJavaScript("entryCount()").toInt() != oldEntries.count())
+        return false;
+
+    for (int i = 0; i < newEntries.count(); ++i) {
+        if (oldEntries.at(i) == newEntries.at(i))
+            continue;
+
+        const QVariant replaced = mainFrame()->evaluateJavaScript(
+                QString("replaceEntry(%1, %2)").arg(i).arg(javascriptString(newEntries.at(i))));
+        if (!replaced.toBool())
+            return false;
+    }
+
+    m_pageText = newText;
+    currentSource = withJavascript(newText);
+    return true;
+}
+
 // Send "completed" signal when the text is finished loading into the viewer
 void BtHtmlReadDisplay::slotLoadFinished(bool) {
+    m_loaded = true;
+    // Let the javascript load the adjacent entries while the user scrolls:
+    CReadWindow* const window = dynamic_cast<CReadWindow*>(parentWindow());
+    if (window != 0 && window->key() != 0 && CReadWindow::continuousScrolling()) {
+        const QString key = window->key()->key();
+        if (!window->adjacentChunkKey(key, true).isNull()
+            || !window->adjacentChunkKey(key, false).isNull())
+            m_jsObject->startChunks(key, m_optionsId);
+    }
+    // Render the Strong's entries of the words for the mag in advance:
+    if (window != 0 && getMouseTracking())
+        BibleTime::instance()->infoDisplay()->prefetchStrongs(m_pageText,
+                                                              window->filterOptions());
     emit completed();
 }
 
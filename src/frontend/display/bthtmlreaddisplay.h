@@ -61,6 +61,50 @@ class BtHtmlReadDisplay : public QWebPage, public CReadDisplay {
         QWidget* view();
         void setLemma(const QString& lemma);
 
+        /**
+          Renders the content next to the chunk with the key \a key for
+          continuous scrolling.
+          \param[out] chunkKey the key of the new chunk, or QString::null if
+                               there is no further content.
+          \param[out] optionsId the id of the options the chunk is rendered with.
+          \returns the HTML content of the new chunk without the page around.
+        */
+        QString adjacentChunk(const QString& key, bool forward,
+                              QString& chunkKey, QString& optionsId);
+
+        /**
+          Identifies the loaded page by the content it was rendered for and by
+          the options it was rendered with. Both are cleared by setText(). With
+          continuous scrolling, the options are also recorded for the chunk of
+          the page, the other chunks keep the options they were loaded with.
+        */
+        void setPageId(const QString& pageId, const QString& optionsId);
+        /** \returns the id of the loaded page, or QString::null while loading. */
+        inline QString pageId() const {
+            return m_loaded ? m_pageId : QString::null;
+        }
+        inline const QString& optionsId() const {
+            return m_optionsId;
+        }
+
+        /**
+          Highlights the entry with the given anchor instead of the current one.
+          \returns false without changing anything if the entry is not on the
+                   loaded page anymore, e.g. because continuous scrolling
+                   unloaded its chunk, or if its chunk was not rendered with
+                   the options \a optionsId.
+        */
+        bool setCurrentEntry(const QString& anchor, const QString& optionsId);
+
+        /**
+          Replaces only the changed entries of the loaded page with the ones of
+          \a newText, which must be a rendering of the same page.
+          \returns false if the page can't be updated this way and has to be
+                   loaded with setText(), e.g. because continuous scrolling
+                   loaded further chunks, which would keep the old options.
+        */
+        bool updateEntries(const QString& newText);
+
     public slots:
         void loadJSObject();
         void slotLoadFinished(bool);
@@ -99,6 +143,10 @@ class BtHtmlReadDisplay : public QWebPage, public CReadDisplay {
         BtHtmlReadDisplayView* m_view;
         BtHtmlJsObject* m_jsObject;
         QString m_currentAnchorCache;
+        QString m_pageText;
+        QString m_pageId;
+        QString m_optionsId;
+        bool m_loaded;
 
 };
 
@@ -9,15 +9,19 @@
 
 #include "frontend/displaywindow/cbiblereadwindow.h"
 
+#include <cstring>
 #include <QAction>
 #include <QApplication>
 #include <QEvent>
 #include <QMdiSubWindow>
 #include <QMenu>
+#include <QSharedPointer>
 #include <QTimer>
 #include <QWidget>
 #include "backend/drivers/cswordbiblemoduleinfo.h"
+#include "backend/keys/btversificationmap.h"
 #include "backend/keys/cswordversekey.h"
+#include "backend/rendering/cchapterdisplay.h"
 #include "frontend/cexportmanager.h"
 #include "frontend/cmdiarea.h"
 #include "frontend/display/creaddisplay.h"
@@ -30,6 +34,34 @@
 #include "util/tool.h"
 
 
+namespace {
+
+/** The maximal number of verses which are rendered at once with continuous scrolling. */
+const int CHUNK_VERSES = 30;
+
+/**
+  Moves \a key to the first verse of the chunk which contains it. The verses
+  of a chapter are split into chunks of about the same size, the introduction
+  of a book belongs to the first chunk of chapter 1.
+  \param[out] lastVerse the last verse of the chunk.
+*/
+void toChunkStart(CSwordVerseKey & key, int & lastVerse) {
+    if (key.getChapter() == 0) {
+        key.setChapter(1);
+        key.setVerse(1);
+    }
+
+    const int verses = qMax(key.getVerseMax(), 1);
+    const int chunks = (verses + CHUNK_VERSES - 1) / CHUNK_VERSES;
+    const int size = (verses + chunks - 1) / chunks;
+    const int chunk = qMax(key.getVerse() - 1, 0) / size;
+    key.setVerse(chunk * size + 1);
+    lastVerse = qMin((chunk + 1) * size, verses);
+}
+
+} // anonymous namespace
+
+
 void CBibleReadWindow::applyProfileSettings(const QString & windowGroup) {
     CLexiconReadWindow::applyProfileSettings(windowGroup);
 
@@ -356,6 +388,73 @@ CSwordVerseKey* CBibleReadWindow::verseKey() {
     return k;
 }
 
+QString CBibleReadWindow::pageKey(const QString & key) {
+    CSwordVerseKey vk(*verseKey());
+    if (!vk.setKey(key))
+        return QString::null;
+
+    if (continuousScrolling()) {
+        // Only the chunk of the chapter with the key is on the page:
+        int lastVerse;
+        toChunkStart(vk, lastVerse);
+        return QString("%1 %2:%3").arg(vk.book()).arg(vk.getChapter()).arg(vk.getVerse());
+    }
+
+    // The introduction of a book is displayed together with chapter 1:
+    return QString("%1 %2").arg(vk.book()).arg(qMax(vk.getChapter(), 1));
+}
+
+QString CBibleReadWindow::adjacentChunkKey(const QString & key, bool forward) {
+    CSwordVerseKey vk(*verseKey());
+    if (!vk.setKey(key))
+        return QString::null;
+
+    int lastVerse;
+    toChunkStart(vk, lastVerse);
+    if (forward) {
+        if (lastVerse < vk.getVerseMax()) {
+            vk.setVerse(lastVerse + 1);
+            return vk.key();
+        }
+        if (!vk.next(CSwordVerseKey::UseChapter))
+            return QString::null;
+        toChunkStart(vk, lastVerse);
+        return vk.key();
+    }
+
+    if (vk.getVerse() > 1) {
+        vk.setVerse(vk.getVerse() - 1);
+    } else if (vk.getChapter() > 1) {
+        if (!vk.previous(CSwordVerseKey::UseChapter))
+            return QString::null;
+        vk.setVerse(vk.getVerseMax());
+    } else {
+        // The introduction of the book is in the first chunk already:
+        if (!vk.previous(CSwordVerseKey::UseBook))
+            return QString::null;
+        vk.setChapter(vk.getChapterMax());
+        vk.setVerse(vk.getVerseMax());
+    }
+    toChunkStart(vk, lastVerse);
+    return vk.key();
+}
+
+QString CBibleReadWindow::chunkText(const QString & key) {
+    if (!continuousScrolling() || !isReady() || modules().empty())
+        return CLexiconReadWindow::chunkText(key);
+
+    Rendering::CChapterDisplay * const display =
+            dynamic_cast<Rendering::CChapterDisplay *>(modules().first()->getDisplay());
+    CSwordVerseKey vk(*verseKey());
+    if (display == 0 || !vk.setKey(key))
+        return CLexiconReadWindow::chunkText(key);
+
+    int lastVerse;
+    toChunkStart(vk, lastVerse);
+    return display->versesText(modules(), key, vk.getVerse(), lastVerse,
+                               displayOptions(), filterOptions());
+}
+
 /** Copies the current chapter into the clipboard. */
 void CBibleReadWindow::copyDisplayedText() {
     CSwordVerseKey dummy(*verseKey());
@@ -452,10 +551,23 @@ void CBibleReadWindow::lookupSwordKey( CSwordKey* newKey ) {
 }
 
 void CBibleReadWindow::syncWindows() {
+    const QString currentKey = key()->key();
     foreach (QMdiSubWindow* subWindow, mdi()->subWindowList()) {
         CDisplayWindow* w = dynamic_cast<CDisplayWindow*>(subWindow->widget());
         if (w && w->syncAllowed()) {
-            w->lookupKey( key()->key() );
+            /* Windows of another versification are given the corresponding
+               verse from the precomputed verse map instead of our key text: */
+            const CSwordVerseKey * const vk = dynamic_cast<CSwordVerseKey *>(w->key());
+            if (vk && std::strcmp(vk->getVersificationSystem(),
+                                  verseKey()->getVersificationSystem()))
+            {
+                QSharedPointer<CSwordVerseKey> k(static_cast<CSwordVerseKey *>(vk->copy()));
+                if (BtVersificationMap::position(*k, *verseKey())) {
+                    mdi()->scheduleLookup(w, k->key());
+                    continue;
+                }
+            }
+            mdi()->scheduleLookup(w, currentKey);
         }
     }
 }
@@ -37,6 +37,18 @@ class CBibleReadWindow: public CLexiconReadWindow  {
         virtual void applyProfileSettings(const QString & windowGroup);
         static void insertKeyboardActions( BtActionCollection* const a );
 
+        /**
+          Reimplementation. Continuous scrolling goes through the chapters in
+          chunks of a limited number of verses.
+        */
+        virtual QString adjacentChunkKey(const QString & key, bool forward);
+
+        /**
+          Reimplementation. With continuous scrolling, only the chunk of the
+          chapter which contains \a key is rendered.
+        */
+        virtual QString chunkText(const QString & key);
+
     protected: /* Methods: */
 
         virtual void initActions();
@@ -45,6 +57,11 @@ class CBibleReadWindow: public CLexiconReadWindow  {
         virtual void initView();
         /** Called to add actions to mainWindow toolbars */
         virtual void setupMainWindowToolBars();
+        /**
+          Reimplementation. All verses of a chapter, or of a chunk of it with
+          continuous scrolling, are on the same page.
+        */
+        virtual QString pageKey(const QString & key);
         /**
         * Reimplementation.
         */
@@ -15,6 +15,7 @@
 #include <QToolBar>
 #include "bibletime.h"
 #include "backend/keys/cswordtreekey.h"
+#include "backend/rendering/cbookdisplay.h"
 #include "frontend/display/bthtmlreaddisplay.h"
 #include "frontend/displaywindow/bttoolbarpopupaction.h"
 #include "frontend/displaywindow/btactioncollection.h"
@@ -25,6 +26,48 @@
 #include "util/tool.h"
 
 
+namespace {
+
+inline bool isRoot(const CSwordTreeKey & key) {
+    return key.key().isEmpty() || key.key() == "/";
+}
+
+/** Moves \a key to the next entry in the order of the book. */
+bool nextEntry(CSwordTreeKey & key) {
+    if (key.firstChild())
+        return true;
+
+    const unsigned long offset = key.getOffset();
+    do {
+        if (key.nextSibling())
+            return true;
+    } while (key.sword::TreeKeyIdx::parent() && !isRoot(key));
+
+    key.setOffset(offset);
+    return false;
+}
+
+/** Moves \a key to the previous entry in the order of the book. */
+bool previousEntry(CSwordTreeKey & key) {
+    if (key.previousSibling()) {
+        // Go to the last entry of the subtree before:
+        while (key.firstChild())
+            while (key.nextSibling())
+                ;
+        return true;
+    }
+
+    const unsigned long offset = key.getOffset();
+    if (key.sword::TreeKeyIdx::parent() && !isRoot(key))
+        return true;
+
+    key.setOffset(offset);
+    return false;
+}
+
+} // anonymous namespace
+
+
 void CBookReadWindow::applyProfileSettings(const QString & windowGroup) {
     CLexiconReadWindow::applyProfileSettings(windowGroup);
 
@@ -179,3 +222,29 @@ void CBookReadWindow::setupPopupMenu() {
 void CBookReadWindow::reload(CSwordBackend::SetupChangedReason reason) {
     CLexiconReadWindow::reload(reason);
 }
+
+QString CBookReadWindow::adjacentChunkKey(const QString & key, bool forward) {
+    CSwordTreeKey * const current = dynamic_cast<CSwordTreeKey *>(CDisplayWindow::key());
+    if (current == 0)
+        return QString::null;
+
+    CSwordTreeKey treeKey(*current);
+    if (!treeKey.setKey(key))
+        return QString::null;
+
+    const bool ok = forward ? nextEntry(treeKey) : previousEntry(treeKey);
+    return ok ? treeKey.key() : QString::null;
+}
+
+QString CBookReadWindow::chunkText(const QString & key) {
+    if (!continuousScrolling() || !isReady() || modules().empty())
+        return CLexiconReadWindow::chunkText(key);
+
+    Rendering::CBookDisplay * const display =
+            dynamic_cast<Rendering::CBookDisplay *>(modules().first()->getDisplay());
+    if (display == 0)
+        return CLexiconReadWindow::chunkText(key);
+
+    // The entries which are displayed together are loaded while scrolling instead:
+    return display->entryText(modules(), key, displayOptions(), filterOptions());
+}
@@ -32,6 +32,18 @@ class CBookReadWindow: public CLexiconReadWindow {
         virtual void applyProfileSettings(const QString & windowGroup);
         static void insertKeyboardActions(BtActionCollection * const a);
 
+        /**
+          Reimplementation. Continuous scrolling goes through the entries in
+          the order of the book.
+        */
+        virtual QString adjacentChunkKey(const QString & key, bool forward);
+
+        /**
+          Reimplementation. With continuous scrolling, only the entry \a key
+          is rendered instead of all entries of its display level.
+        */
+        virtual QString chunkText(const QString & key);
+
     public slots:
 
         /**
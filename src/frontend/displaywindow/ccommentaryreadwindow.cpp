@@ -197,6 +197,17 @@ void CCommentaryReadWindow::previousVerse() {
         keyChooser()->setKey(key());
 }
 
+QString CCommentaryReadWindow::adjacentChunkKey(const QString & key, bool forward) {
+    CSwordVerseKey vk(*verseKey());
+    if (!vk.setKey(key))
+        return QString::null;
+
+    const bool ok = forward
+                    ? vk.next(CSwordVerseKey::UseVerse)
+                    : vk.previous(CSwordVerseKey::UseVerse);
+    return ok ? vk.key() : QString::null;
+}
+
 bool CCommentaryReadWindow::syncAllowed() const {
     return m_syncButton->isChecked();
 }
@@ -36,6 +36,8 @@ class CCommentaryReadWindow : public CLexiconReadWindow  {
         virtual void storeProfileSettings(const QString & windowGroup);
         virtual void applyProfileSettings(const QString & windowGroup);
         virtual bool syncAllowed() const;
+        /** Reimplementation. Continuous scrolling goes verse by verse. */
+        virtual QString adjacentChunkKey(const QString & key, bool forward);
 
     public slots: // Public slots
         void nextBook();
@@ -11,6 +11,7 @@
 
 #include <QMdiSubWindow>
 #include <QResizeEvent>
+#include "backend/config/btconfig.h"
 #include "backend/keys/cswordkey.h"
 #include "backend/keys/cswordversekey.h"
 #include "backend/rendering/cdisplayrendering.h"
@@ -20,6 +21,7 @@
 #include "frontend/display/bthtmlreaddisplay.h"
 #include "frontend/displaywindow/btactioncollection.h"
 #include "frontend/searchdialog/csearchdialog.h"
+#include "util/btstartupprofiler.h"
 
 
 CReadWindow::CReadWindow(QList<CSwordModuleInfo*> modules, CMDIArea* parent)
@@ -82,18 +84,48 @@ void CReadWindow::lookupSwordKey( CSwordKey* newKey ) {
         key()->setKey(newKey->key());
     }
 
+    // Identify the page by its key and modules, and by the options it's rendered with:
+    QString pageId = pageKey(newKey->key());
+    if (!pageId.isNull()) {
+        Q_FOREACH (const CSwordModuleInfo * const module, modules())
+            pageId.append('\n').append(module->name());
+    }
+    const QString optionsId = this->optionsId();
+
+    BtHtmlReadDisplay * const htmlDisplay = dynamic_cast<BtHtmlReadDisplay*>(m_readDisplayWidget);
+    const bool samePage = htmlDisplay != 0 && !pageId.isNull() && htmlDisplay->pageId() == pageId;
+
+    if (samePage && htmlDisplay->optionsId() == optionsId
+        && htmlDisplay->setCurrentEntry(CDisplayRendering::keyToHTMLAnchor(key()->key()),
+                                        optionsId))
+    {
+        // The key is on the loaded page, there is no need to render it again:
+        setWindowTitle(windowCaption());
+        slotMoveToAnchor();
+        return;
+    }
+
     /// \todo next-TODO how about options?
     Q_ASSERT(modules().first()->getDisplay());
-    CEntryDisplay* display = modules().first()->getDisplay();
-    if (display) { //do we have a display object?
-        displayWidget()->setText(
-            display->text(
-                modules(),
-                newKey->key(),
-                displayOptions(),
-                filterOptions()
-            )
-        );
+    if (modules().first()->getDisplay()) { //do we have a display object?
+        const QString text = chunkText(newKey->key());
+
+        /* Patch the changed entries of the loaded page if possible. With the
+           same options, the entry wasn't loaded anymore and the page has to be
+           loaded again. */
+        if (samePage && htmlDisplay->optionsId() != optionsId
+            && htmlDisplay->updateEntries(text))
+        {
+            htmlDisplay->setPageId(pageId, optionsId);
+            setWindowTitle(windowCaption());
+            slotMoveToAnchor();
+            return;
+        }
+
+        displayWidget()->setText(text);
+        if (htmlDisplay != 0)
+            htmlDisplay->setPageId(pageId, optionsId);
+        BtStartupProfiler::firstWindowRendered();
     }
 
     setWindowTitle(windowCaption());
@@ -101,6 +133,45 @@ void CReadWindow::lookupSwordKey( CSwordKey* newKey ) {
     // moving to anchor happens in slotMoveToAnchor which catches the completed() signal from KHTMLPart
 }
 
+QString CReadWindow::pageKey(const QString & key) {
+    return key;
+}
+
+void CReadWindow::reload(CSwordBackend::SetupChangedReason reason) {
+    // Make sure the next lookup renders and loads the page again:
+    BtHtmlReadDisplay * const htmlDisplay = dynamic_cast<BtHtmlReadDisplay*>(m_readDisplayWidget);
+    if (htmlDisplay != 0)
+        htmlDisplay->setPageId(QString::null, QString::null);
+
+    CDisplayWindow::reload(reason);
+}
+
+QString CReadWindow::adjacentChunkKey(const QString &, bool) {
+    return QString::null;
+}
+
+QString CReadWindow::chunkText(const QString & key) {
+    if (!isReady() || modules().empty() || !modules().first())
+        return QString::null;
+
+    Rendering::CEntryDisplay * const display = modules().first()->getDisplay();
+    if (!display)
+        return QString::null;
+
+    return display->text(modules(), key, displayOptions(), filterOptions());
+}
+
+bool CReadWindow::continuousScrolling() {
+    return btConfig().value<bool>("GUI/continuousScrolling", true);
+}
+
+QString CReadWindow::optionsId() const {
+    return QString("%1 %2 %3")
+           .arg(displayOptions().lineBreaks)
+           .arg(displayOptions().verseNumbers)
+           .arg(filterOptions().toBitmask());
+}
+
 void CReadWindow::slotMoveToAnchor() {
     ((CReadDisplay*)displayWidget())->moveToAnchor( Rendering::CDisplayRendering::keyToHTMLAnchor(key()->key()) );
 }
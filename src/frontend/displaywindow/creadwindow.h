@@ -33,6 +33,37 @@ class CReadWindow: public CDisplayWindow {
 
         CReadWindow(QList<CSwordModuleInfo*> modules, CMDIArea* parent);
 
+        /**
+          Used for continuous scrolling of the display.
+          \returns the key of the entry which is displayed before or after the
+                   entry \a key, or QString::null if there is none. The
+                   default implementation does not support continuous
+                   scrolling and always returns QString::null.
+        */
+        virtual QString adjacentChunkKey(const QString & key, bool forward);
+
+        /**
+          \returns the page which the display of this window shows for
+                   \a key, rendered with the options of this window. With
+                   continuous scrolling, subclasses may render only a part of
+                   the entries around \a key, the rest is loaded as adjacent
+                   chunks while scrolling.
+        */
+        virtual QString chunkText(const QString & key);
+
+        /** \returns whether read windows load adjacent entries while scrolling. */
+        static bool continuousScrolling();
+
+        /**
+          \returns an id of the options the entries of this window are
+                   rendered with. Renderings with equal ids are equal.
+        */
+        QString optionsId() const;
+
+    public slots:
+        /** Reimplementation to render the page again after the setup changed. */
+        virtual void reload(CSwordBackend::SetupChangedReason reason);
+
     protected:
         /**
         * Sets the display widget of this display window.
@@ -46,6 +77,13 @@ class CReadWindow: public CDisplayWindow {
         /** Called to add actions to mainWindow toolbars.*/
         virtual void setupMainWindowToolBars() = 0;
 
+        /**
+          \returns a key for the page which is displayed for \a key. Keys on
+                   the same page only move the highlighting instead of loading
+                   the page again. By default each key has its own page.
+        */
+        virtual QString pageKey(const QString & key);
+
     protected slots:
         /**
         * Load the text using the key
@@ -9,6 +9,7 @@
 
 #include "frontend/keychooser/ckeychooserwidget.h"
 
+#include <QAbstractItemModel>
 #include <QComboBox>
 #include <QFocusEvent>
 #include <QHBoxLayout>
@@ -179,6 +180,37 @@ void CKeyChooserWidget::reset(const QStringList * list, int index, bool do_emit)
     //  qWarning("inserted");
 }
 
+void CKeyChooserWidget::reset(QAbstractItemModel * model, int index, bool do_emit) {
+    Q_ASSERT(model);
+    if (m_isResetting)
+        return;
+
+    m_isResetting = true;
+
+    m_oldKey = QString::null;
+
+    //DON'T REMOVE THE HIDE: Otherwise QComboBox's sizeHint() function won't work properly
+    m_comboBox->hide();
+    if (m_comboBox->model() != model)
+        m_comboBox->setModel(model);
+
+    if (model->rowCount() > 0) {
+        setEnabled(true);
+        m_comboBox->setCurrentIndex(index);
+    } else {
+        setEnabled(false);
+    }
+
+    if (do_emit)
+        emit changed(m_comboBox->currentIndex());
+
+    m_comboBox->sizeHint(); //without this function call the combo box won't be properly sized!
+    //DON'T REMOVE OR MOVE THE show()! Otherwise QComboBox's sizeHint() function won't work properly!
+    m_comboBox->show();
+
+    m_isResetting = false;
+}
+
 /** Initializes this widget. We need this function because we have more than one constructor. */
 void CKeyChooserWidget::init() {
     m_oldKey = QString::null;
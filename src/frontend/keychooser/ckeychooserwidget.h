@@ -19,6 +19,7 @@
 
 class CLexiconKeyChooser;
 class CScrollerWidgetSet;
+class QAbstractItemModel;
 class QWheelEvent;
 class QHBoxLayout;
 class QWidget;
@@ -86,6 +87,12 @@ public: /* Methods: */
 
     void reset(const QStringList * list, int index, bool do_emit);
 
+    /**
+    * Like the other reset functions, but lets the combobox show the given
+    * model instead of copying items into it. The model is not owned.
+    */
+    void reset(QAbstractItemModel * model, int index, bool do_emit);
+
     /**
     * Initializes this widget. We need this function because
     * we have more than one constructor.
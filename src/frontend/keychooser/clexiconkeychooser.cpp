@@ -9,10 +9,11 @@
 
 #include "frontend/keychooser/clexiconkeychooser.h"
 
-#include <algorithm>
 #include <QHBoxLayout>
+#include <QListView>
 #include "backend/drivers/cswordlexiconmoduleinfo.h"
 #include "backend/keys/cswordldkey.h"
+#include "backend/models/btlexiconkeymodel.h"
 #include "frontend/keychooser/bthistory.h"
 #include "frontend/keychooser/ckeychooserwidget.h"
 #include "frontend/keychooser/cscrollbutton.h"
@@ -24,6 +25,7 @@ CLexiconKeyChooser::CLexiconKeyChooser(const QList<const CSwordModuleInfo *> & m
                                        CSwordKey * key,
                                        QWidget * parent)
     : CKeyChooser(modules, historyPtr, parent)
+    , m_model(0)
     , m_key(dynamic_cast<CSwordLDKey *>(key))
 {
     setModules(modules, false);
@@ -42,6 +44,15 @@ CLexiconKeyChooser::CLexiconKeyChooser(const QList<const CSwordModuleInfo *> & m
     //to aid users with smaller screen resolutions
     m_widget->comboBox().setMaximumWidth(200);
 
+    /* Lexicons have tens of thousands of entries, so don't let the combobox
+       measure all of them to calculate its size: */
+    m_widget->comboBox().setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLength);
+    m_widget->comboBox().setMinimumContentsLength(20);
+    if (QListView * const view = qobject_cast<QListView *>(m_widget->comboBox().view()))
+        view->setUniformItemSizes(true);
+
+    m_model = new BtLexiconKeyModel(this);
+
     m_widget->setToolTips(
         tr("Entries of the current work"),
         tr("Next entry"),
@@ -70,8 +81,7 @@ void CLexiconKeyChooser::updateKey(CSwordKey* key) {
         return;
     }
 
-    QString newKey = m_key->key();
-    const int index = m_widget->comboBox().findText(newKey);
+    const int index = m_model->indexOf(m_key->key());
     m_widget->comboBox().setCurrentIndex(index);
 }
 
@@ -98,55 +108,10 @@ void CLexiconKeyChooser::activated(int index) {
     //  qWarning("activated end");
 }
 
-inline bool my_cmpEntries(const QString& a, const QString& b) {
-    return a < b;
-}
-
 /** Reimplementation. */
 void CLexiconKeyChooser::refreshContent() {
-    if (m_modules.count() == 1) {
-        m_widget->reset(&m_modules.first()->entries(), 0, true);
-        //     qWarning("resetted");
-    }
-    else {
-        typedef std::multimap<unsigned int, const QStringList*> EntryMap;
-        EntryMap entryMap;
-
-        QListIterator<const CSwordLexiconModuleInfo*> mit(m_modules);
-        while (mit.hasNext()) {
-            const QStringList &entries = mit.next()->entries();
-            entryMap.insert( std::make_pair(entries.count(), &entries) );
-        }
-
-        QStringList goodEntries; //The string list which contains the entries which are available in all modules
-
-        EntryMap::iterator it = entryMap.begin(); //iterator to go thoigh all selected modules
-        QStringList refEntries = *(it->second); //copy the items for the first time
-        const QStringList *cmpEntries = (++it)->second; //list for comparision, starts with the second module in the map
-
-        // Testing for refEntries being empty is not needed for the set union
-        // of all keys, but is a good idea since it is being updated in the
-        // loop.  It is necessary for set intersection and prevents a crash.
-        while (it != entryMap.end() && (refEntries.begin() != refEntries.end())) {
-            std::set_union(
-                refEntries.begin(), --(refEntries.end()), //--end() is the last valid entry
-                cmpEntries->begin(), --(cmpEntries->end()),
-                std::back_inserter(goodEntries), //append valid entries to the end of goodEntries
-                my_cmpEntries  //ci_cmpEntries is the comparision function
-            );
-
-            cmpEntries = ( ++it )->second; //this is a pointer to the string list of a new module
-
-            /*
-            * use the good entries for next comparision,
-            * because the final list can only have the entries of goodEntries as maxiumum
-            */
-            refEntries = goodEntries;
-        };
-
-        m_widget->reset(goodEntries, 0, true); //write down the entries
-    } //end of ELSE
-
+    m_model->setModules(m_modules, BtLexiconKeyModel::Union);
+    m_widget->reset(m_model, 0, true);
 }
 
 void CLexiconKeyChooser::setModules(const QList<const CSwordModuleInfo*> &modules,
@@ -15,6 +15,7 @@
 #include "frontend/keychooser/ckeychooser.h"
 
 
+class BtLexiconKeyModel;
 class CKeyChooserWidget;
 class CSwordLDKey;
 class CSwordLexiconModuleInfo;
@@ -69,6 +70,7 @@ class CLexiconKeyChooser : public CKeyChooser {
 
     protected:
         CKeyChooserWidget *m_widget;
+        BtLexiconKeyModel *m_model;
         CSwordLDKey* m_key;
         QList<const CSwordLexiconModuleInfo*> m_modules;
         QHBoxLayout *m_layout;
@@ -15,7 +15,9 @@
 #endif
 #include <QFile>
 #include <QLocale>
+#include <QScopedPointer>
 #include <QTextCodec>
+#include <QTimer>
 #include <QTranslator>
 #include "backend/bookshelfmodel/btbookshelftreemodel.h"
 #include "backend/config/btconfig.h"
@@ -23,6 +25,7 @@
 #include "bibletime_dbus_adaptor.h"
 #include "bibletimeapp.h"
 #include "frontend/searchdialog/btsearchoptionsarea.h"
+#include "util/btstartupprofiler.h"
 #include "util/directory.h"
 
 
@@ -53,6 +56,14 @@ void printHelp(const QString &executable) {
         << qPrintable(QObject::tr("Open the default Bible with the "
                                   "reference <ref>"))
         << std::endl << std::endl
+        << "    --profile-startup" << std::endl << "        "
+        << qPrintable(QObject::tr("Print the time spent in the phases of "
+                                  "the startup"))
+        << std::endl << std::endl
+        << "    --quit-after-startup" << std::endl << "        "
+        << qPrintable(QObject::tr("Quit as soon as the startup is finished, "
+                                  "e.g. for benchmarks"))
+        << std::endl << std::endl
         << qPrintable(QObject::tr("For command-line arguments parsed by the"
                                   " Qt toolkit, see %1.")
                .arg("http://doc.qt.nokia.com/latest/qapplication.html"))
@@ -68,13 +79,14 @@ void printHelp(const QString &executable) {
   \param[out] showDebugMessages Whether --debug was specified.
   \param[out] ignoreSession Whether --ignore-session was specified.
   \param[out] openBibleKey Will be set to --open-default-bible if specified.
+  \param[out] quitAfterStartup Whether --quit-after-startup was specified.
   \retval -1 Parsing was successful, the application should exit with
              EXIT_SUCCESS.
   \retval 0 Parsing was successful.
   \retval 1 Parsing failed, the application should exit with EXIT_FAILURE.
 */
 int parseCommandLine(bool &showDebugMessages, bool &ignoreSession,
-                     QString &openBibleKey)
+                     QString &openBibleKey, bool &quitAfterStartup)
 {
     QStringList args = BibleTimeApp::arguments();
     for (int i = 1; i < args.size(); i++) {
@@ -95,6 +107,10 @@ int parseCommandLine(bool &showDebugMessages, bool &ignoreSession,
             showDebugMessages = true;
         } else if (arg == "--ignore-session") {
             ignoreSession = true;
+        } else if (arg == "--profile-startup") {
+            BtStartupProfiler::setReportEnabled(true);
+        } else if (arg == "--quit-after-startup") {
+            quitAfterStartup = true;
         } else if (arg == "--open-default-bible") {
             i++;
             if (i < args.size()) {
@@ -218,12 +234,18 @@ void registerMetaTypes() {
 int main(int argc, char* argv[]) {
     namespace DU = util::directory;
 
+    BtStartupProfiler::start();
+    QScopedPointer<BtStartupProfiler::Phase> appPhase(
+            new BtStartupProfiler::Phase("Application"));
     BibleTimeApp app(argc, argv); //for QApplication
+    appPhase.reset();
 
     // Parse command line arguments:
     bool ignoreSession = false;
     QString openBibleKey;
-    int r = parseCommandLine(showDebugMessages, ignoreSession, openBibleKey);
+    bool quitAfterStartup = false;
+    int r = parseCommandLine(showDebugMessages, ignoreSession, openBibleKey,
+                             quitAfterStartup);
     if (r != 0) {
         if (r < 0) return EXIT_SUCCESS;
         return EXIT_FAILURE;
@@ -268,14 +290,20 @@ int main(int argc, char* argv[]) {
 
     registerMetaTypes();
 
-    if (!DU::initDirectoryCache()) {
-        qFatal("Error initializing directory cache!");
-        return EXIT_FAILURE;
+    {
+        BtStartupProfiler::Phase phase("Directory cache");
+        if (!DU::initDirectoryCache()) {
+            qFatal("Error initializing directory cache!");
+            return EXIT_FAILURE;
+        }
     }
 
     app.startInit();
-    if (!app.initBtConfig()) {
-        return EXIT_FAILURE;
+    {
+        BtStartupProfiler::Phase phase("Configuration");
+        if (!app.initBtConfig()) {
+            return EXIT_FAILURE;
+        }
     }
 
 #ifdef Q_OS_WIN
@@ -295,6 +323,7 @@ int main(int argc, char* argv[]) {
 #endif
 
     //first install QT's own translations
+    appPhase.reset(new BtStartupProfiler::Phase("Translations"));
     QTranslator qtTranslator;
     qtTranslator.load("qt_" + QLocale::system().name());
     app.installTranslator(&qtTranslator);
@@ -302,17 +331,23 @@ int main(int argc, char* argv[]) {
     QTranslator BibleTimeTranslator;
     BibleTimeTranslator.load( QString("bibletime_ui_").append(QLocale::system().name()), DU::getLocaleDir().canonicalPath());
     app.installTranslator(&BibleTimeTranslator);
+    appPhase.reset();
 
     app.setProperty("--debug", QVariant(showDebugMessages));
 
     // Initialize display template manager:
-    if (!app.initDisplayTemplateManager()) {
-        qFatal("Error initializing display template manager!");
-        return EXIT_FAILURE;
+    {
+        BtStartupProfiler::Phase phase("Display templates");
+        if (!app.initDisplayTemplateManager()) {
+            qFatal("Error initializing display template manager!");
+            return EXIT_FAILURE;
+        }
     }
 
+    appPhase.reset(new BtStartupProfiler::Phase("Main window"));
     BibleTime *mainWindow = new BibleTime();
     mainWindow->setAttribute(Qt::WA_DeleteOnClose);
+    appPhase.reset();
 
     // a new BibleTime version was installed (maybe a completely new installation)
     if (btConfig().value<QString>("bibletimeVersion", BT_VERSION) != BT_VERSION) {
@@ -322,10 +357,14 @@ int main(int argc, char* argv[]) {
 
     // restore the workspace and process command line options
     //app.setMainWidget(bibletime_ptr); //no longer used in qt4 (QApplication)
+    appPhase.reset(new BtStartupProfiler::Phase("Show main window"));
     mainWindow->show();
+    appPhase.reset();
 
     // The following must be done after the bibletime window is visible:
+    appPhase.reset(new BtStartupProfiler::Phase("Session and command line"));
     mainWindow->processCommandline(ignoreSession, openBibleKey);
+    appPhase.reset();
 
 #ifndef NO_DBUS
     new BibleTimeDBusAdaptor(mainWindow);
@@ -334,8 +373,12 @@ int main(int argc, char* argv[]) {
     QDBusConnection::sessionBus().registerObject("/BibleTime", mainWindow);
 #endif
 
-    if (btConfig().value<bool>("GUI/showTipAtStartup", true))
+    BtStartupProfiler::finish();
+    if (quitAfterStartup) {
+        QTimer::singleShot(0, mainWindow, SLOT(close()));
+    } else if (btConfig().value<bool>("GUI/showTipAtStartup", true)) {
         mainWindow->slotOpenTipDialog();
+    }
 
     r = app.exec();
     return r;
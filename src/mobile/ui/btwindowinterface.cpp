@@ -138,7 +138,7 @@ int BtWindowInterface::getCurrentModelIndex() const {
             return key.getIndex()/4;
     }
     else if (moduleIsLexicon(module())){        const CSwordLexiconModuleInfo *li = qobject_cast<const CSwordLexiconModuleInfo*>(m_key->module());
-        int index = li->entries().indexOf(m_key->key());
+        int index = li->keyIndex().indexOf(m_key->key());
         return index;
     }
     return 0;
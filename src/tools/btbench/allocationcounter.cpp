@@ -0,0 +1,97 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  Counts the heap allocations of btbench. With glibc, malloc(), calloc() and
+  realloc() are replaced, which also covers operator new and the data of the
+  Qt containers. Elsewhere only operator new is replaced.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <new>
+#include <QAtomicInt>
+
+
+namespace {
+
+QAtomicInt allocations;
+
+} // anonymous namespace
+
+#ifdef __GLIBC__
+
+extern "C" {
+
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void __libc_free(void * ptr);
+
+void * malloc(size_t size) {
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size) {
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size) {
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void * ptr) {
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#else
+
+#if __cplusplus >= 201103L
+#define BTBENCH_THROW_BAD_ALLOC
+#define BTBENCH_NOTHROW noexcept
+#else
+#define BTBENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BTBENCH_NOTHROW throw()
+#endif
+
+void * operator new(std::size_t size) BTBENCH_THROW_BAD_ALLOC {
+    allocations.fetchAndAddRelaxed(1);
+    void * const ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new[](std::size_t size) BTBENCH_THROW_BAD_ALLOC {
+    return operator new(size);
+}
+
+void operator delete(void * ptr) BTBENCH_NOTHROW {
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr) BTBENCH_NOTHROW {
+    std::free(ptr);
+}
+
+#endif
+
+namespace BtBench {
+
+int allocationCount() {
+    return allocations.fetchAndAddRelaxed(0);
+}
+
+} // namespace BtBench
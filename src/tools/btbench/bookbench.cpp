@@ -0,0 +1,137 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The book benchmark. A whole book of a Bible is rendered by renderKeyTree()
+  like in a display window, once with the entries returned as QStrings and
+  appended to the page, as it was done before, and once with the entries
+  rendered into a single UTF-8 buffer. Both pages have to be equal. The heap
+  allocations of both renderings are counted.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordversekey.h"
+#include "backend/rendering/cdisplayrendering.h"
+#include "legacystringrendering.h"
+
+
+namespace {
+
+typedef Rendering::CTextRendering::KeyTree KeyTree;
+typedef Rendering::CTextRendering::KeyTreeItem KeyTreeItem;
+
+/**
+  Renders \a tree with the former or with the current rendering.
+  \param[out] page The rendered page.
+  \param[out] allocations The number of heap allocations.
+  \returns the time in milliseconds.
+*/
+qint64 measure(const KeyTree & tree,
+               bool legacy,
+               QString & page,
+               int & allocations)
+{
+    BtBench::LegacyStringRendering legacyRendering;
+    Rendering::CDisplayRendering currentRendering;
+
+    const int allocationsBefore = BtBench::allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    page = legacy
+           ? legacyRendering.renderKeyTreeToString(tree)
+           : currentRendering.renderKeyTree(tree);
+    const qint64 ms = qMax(timer.elapsed(), Q_INT64_C(1));
+    allocations = BtBench::allocationCount() - allocationsBefore;
+    return ms;
+}
+
+void printThroughput(const char * name, qint64 ms, double mib, int allocations) {
+    std::cout << name << ms << " ms (" << (mib * 1000.0 / ms) << " MiB/s, "
+              << allocations << " allocations)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int bookBenchmark(const QStringList & args) {
+    const int rounds = intArgument(args, "--rounds", 3);
+    if (rounds < 0)
+        return EXIT_FAILURE;
+
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+    if (modules.size() != 1
+        || modules.first()->type() != CSwordModuleInfo::Bible)
+    {
+        std::cerr << "Error: Give one Bible with --module. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const int i = args.indexOf("--book");
+    const QString book = (i >= 0 && i + 1 < args.size())
+                         ? args.at(i + 1)
+                         : QString("Genesis");
+    CSwordVerseKey start(modules.first());
+    if (!start.setKey(book + " 1:1")) {
+        std::cerr << "Error: Invalid book: " << qPrintable(book) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Build the tree of the book like renderKeyRange() does:
+    KeyTree tree;
+    KeyTreeItem::Settings settings;
+    CSwordVerseKey vk(start);
+    do {
+        tree.append(new KeyTreeItem(vk, modules, settings));
+    } while (vk.next(CSwordVerseKey::UseVerse)
+             && vk.getTestament() == start.getTestament()
+             && vk.getBook() == start.getBook());
+    const int verses = tree.size();
+
+    qint64 legacyTime = 0;
+    qint64 currentTime = 0;
+    int legacyAllocations = 0;
+    int currentAllocations = 0;
+    qint64 bytes = 0;
+    int failures = 0;
+    for (int round = 0; round < rounds; round++) {
+        QString legacyPage;
+        QString currentPage;
+        int allocations;
+        legacyTime += measure(tree, true, legacyPage, allocations);
+        legacyAllocations += allocations;
+        currentTime += measure(tree, false, currentPage, allocations);
+        currentAllocations += allocations;
+        bytes += currentPage.toUtf8().size();
+        if (currentPage != legacyPage && failures++ == 0) {
+            std::cerr << "FAILED: The pages differ." << std::endl
+                      << "  current: " << currentPage.size() << " characters" << std::endl
+                      << "  former:  " << legacyPage.size() << " characters" << std::endl;
+        }
+    }
+
+    const double mib = bytes / 1024.0 / 1024.0;
+    std::cout << "Verses: " << verses << " of " << qPrintable(book)
+              << ", MiB: " << mib << ", rounds: " << rounds << std::endl
+              << "Failed rounds: " << failures << std::endl;
+    printThroughput("Former QString rendering: ", legacyTime, mib, legacyAllocations);
+    printThroughput("Current sink rendering:   ", currentTime, mib, currentAllocations);
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
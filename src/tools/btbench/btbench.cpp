@@ -0,0 +1,204 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  btbench - checks the output of optimized parts of the backend of BibleTime
+  against their former implementations and measures both.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QLocale>
+#include "backend/config/btconfig.h"
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/managers/btstringmgr.h"
+#include "backend/managers/cdisplaytemplatemgr.h"
+#include "backend/managers/cswordbackend.h"
+#include "bibletimeapp.h"
+#include "util/directory.h"
+
+// Sword includes:
+#include <swlog.h>
+
+
+namespace {
+
+void printHelp(const QString &executable) {
+    std::cout << qPrintable(executable) << " <benchmark> [options]"
+        << std::endl << std::endl
+        << "    book --module <bible> [--book <name>] [--rounds <n>]" << std::endl << "        "
+        << "Render the whole book (Genesis by default) with the current UTF-8"
+        << std::endl << "        "
+        << "buffer and the former QString concatenation, compare the pages and"
+        << std::endl << "        "
+        << "measure both, counting their heap allocations"
+        << std::endl << std::endl
+        << "    filters [--module <name>]... [--rounds <n>]" << std::endl << "        "
+        << "Compare the Strong's markup of the ThML and GBF filters with the"
+        << std::endl << "        "
+        << "former implementation on sample entries and on all entries of the"
+        << std::endl << "        "
+        << "given works, and measure both"
+        << std::endl << std::endl
+        << "    osis --module <work>" << std::endl << "        "
+        << "Convert all entries of the OSIS work with all filter options on by"
+        << std::endl << "        "
+        << "the current and the former OSIS filter, compare the HTML and"
+        << std::endl << "        "
+        << "measure both"
+        << std::endl << std::endl
+        << "    parallel --module <bible>... [--chapter <key>] [--rounds <n>]"
+        << std::endl << "        "
+        << "Render the chapter (Genesis 1 by default) in at least two Bibles"
+        << std::endl << "        "
+        << "side by side verse-major like before and with the texts prefetched"
+        << std::endl << "        "
+        << "work by work, compare the pages and measure both"
+        << std::endl << std::endl
+        << "    range --module <bible>... [--start <key>] [--verses <n>] [--rounds <n>]"
+        << std::endl << "        "
+        << "Render n verses (1000 by default) from the start key on (Genesis"
+        << std::endl << "        "
+        << "1:1 by default) with the current and the former render tree items,"
+        << std::endl << "        "
+        << "compare the pages and measure both"
+        << std::endl << std::endl
+        << "    references --module <bible> [--count <n>] [--languages <locale,...>]"
+        << std::endl << "        "
+        << "Parse n generated references (10000 by default) in the given"
+        << std::endl << "        "
+        << "languages with the current and the former parser, compare the"
+        << std::endl << "        "
+        << "results and measure both"
+        << std::endl << std::endl
+        << "The exit code is non-zero if a check failed." << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+bool initBackend() {
+    namespace DU = util::directory;
+
+    qRegisterMetaType<FilterOptions>("FilterOptions");
+    qRegisterMetaType<DisplayOptions>("DisplayOptions");
+    qRegisterMetaType<BtConfig::StringMap>("StringMap");
+    qRegisterMetaTypeStreamOperators<BtConfig::StringMap>("StringMap");
+
+    if (!DU::initDirectoryCache()) {
+        std::cerr << "Error: Failed to initialize the directory cache." << std::endl;
+        return false;
+    }
+
+    bApp->startInit();
+    if (!bApp->initBtConfig())
+        return false;
+
+    QString errorMessage;
+    new CDisplayTemplateMgr(errorMessage);
+    if (!errorMessage.isNull()) {
+        std::cerr << "Error: " << qPrintable(errorMessage) << std::endl;
+        return false;
+    }
+
+    sword::StringMgr::setSystemStringMgr(new BtStringMgr());
+    sword::SWLog::getSystemLog()->setLogLevel(sword::SWLog::LOG_ERROR);
+
+    CSwordBackend * const backend = CSwordBackend::createInstance();
+    backend->booknameLanguage(btConfig().value<QString>("language", QLocale::system().name()));
+    if (backend->initModules(CSwordBackend::OtherChange) != CSwordBackend::NoError) {
+        std::cerr << "Error: Failed to load the installed works." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool findModules(const QStringList & args,
+                 QList<const CSwordModuleInfo *> & modules)
+{
+    for (int i = 0; i < args.size(); i++) {
+        if (args.at(i) != "--module" && args.at(i) != "-m")
+            continue;
+
+        if (++i >= args.size()) {
+            std::cerr << "Error: --module expects an argument." << std::endl;
+            return false;
+        }
+        const CSwordModuleInfo * const module =
+                CSwordBackend::instance()->findModuleByName(args.at(i));
+        if (module == 0) {
+            std::cerr << "Error: Work not found: " << qPrintable(args.at(i))
+                      << std::endl;
+            return false;
+        }
+        modules.append(module);
+    }
+    return true;
+}
+
+int intArgument(const QStringList & args, const QString & option, int defaultValue) {
+    const int i = args.indexOf(option);
+    if (i < 0)
+        return defaultValue;
+
+    bool ok = false;
+    const int value = (i + 1 < args.size()) ? args.at(i + 1).toInt(&ok) : 0;
+    if (!ok || value < 1) {
+        std::cerr << "Error: " << qPrintable(option)
+                  << " expects a positive number." << std::endl;
+        return -1;
+    }
+    return value;
+}
+
+} // namespace BtBench
+
+
+int main(int argc, char * argv[]) {
+#if QT_VERSION >= 0x050000
+    // No window system is needed:
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "minimal");
+#endif
+    BibleTimeApp app(argc, argv, false);
+
+    const QStringList args = BibleTimeApp::arguments();
+    if (args.size() < 2 || args.at(1) == "--help" || args.at(1) == "-h") {
+        printHelp(args.at(0));
+        return (args.size() < 2) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    const QString benchmark = args.at(1);
+    if (benchmark != "book" && benchmark != "filters" && benchmark != "osis"
+        && benchmark != "parallel" && benchmark != "range"
+        && benchmark != "references")
+    {
+        std::cerr << "Error: Unknown benchmark: " << qPrintable(benchmark)
+                  << ". See --help for details." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!BtBench::initBackend())
+        return EXIT_FAILURE;
+
+    if (benchmark == "book")
+        return BtBench::bookBenchmark(args.mid(2));
+    if (benchmark == "osis")
+        return BtBench::osisBenchmark(args.mid(2));
+    if (benchmark == "parallel")
+        return BtBench::parallelBenchmark(args.mid(2));
+    if (benchmark == "range")
+        return BtBench::rangeBenchmark(args.mid(2));
+    if (benchmark == "references")
+        return BtBench::referenceBenchmark(args.mid(2));
+    return BtBench::filterBenchmark(args.mid(2));
+}
@@ -0,0 +1,97 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTBENCH_H
+#define BTBENCH_H
+
+#include <QList>
+#include <QStringList>
+
+
+class CSwordModuleInfo;
+
+namespace BtBench {
+
+/**
+  Initializes the configuration and the backend with the installed works.
+  \returns whether the initialization was successful.
+*/
+bool initBackend();
+
+/**
+  Looks up the works named by the --module arguments in \a args.
+  \param[in] args The arguments of the benchmark.
+  \param[out] modules The works in the order of the arguments.
+  \returns whether all works were found.
+*/
+bool findModules(const QStringList & args,
+                 QList<const CSwordModuleInfo *> & modules);
+
+/**
+  \returns the number given after \a option in \a args, \a defaultValue if the
+           option is not given or -1 if the value is no positive number.
+*/
+int intArgument(const QStringList & args, const QString & option, int defaultValue);
+
+/**
+  \returns the number of heap allocations of btbench so far.
+*/
+int allocationCount();
+
+/**
+  Renders a whole book of a Bible with the entries rendered into a single UTF-8
+  buffer and with the former QString concatenation, compares the pages and
+  measures both, counting their heap allocations.
+  \returns the exit code of the application.
+*/
+int bookBenchmark(const QStringList & args);
+
+/**
+  Compares the Strong's post-processing of the ThML and GBF filters with the
+  former QRegExp implementation and measures the throughput of both.
+  \returns the exit code of the application.
+*/
+int filterBenchmark(const QStringList & args);
+
+/**
+  Compares ReferenceManager::parseVerseReference() with its former
+  implementation on generated references in several languages and measures
+  both.
+  \returns the exit code of the application.
+*/
+int referenceBenchmark(const QStringList & args);
+
+/**
+  Converts all entries of an OSIS work with all filter options switched on by
+  Filters::OsisToHtml and by its former implementation, compares the outputs
+  and measures both.
+  \returns the exit code of the application.
+*/
+int osisBenchmark(const QStringList & args);
+
+/**
+  Builds and renders a range of verses with the render tree items storing the
+  verse index and with items storing the text of their key as before, compares
+  the pages and measures both.
+  \returns the exit code of the application.
+*/
+int rangeBenchmark(const QStringList & args);
+
+/**
+  Renders a chapter in several Bibles side by side verse-major like before and
+  with the texts prefetched work by work, compares the pages and measures both.
+  \returns the exit code of the application.
+*/
+int parallelBenchmark(const QStringList & args);
+
+} // namespace BtBench
+
+#endif
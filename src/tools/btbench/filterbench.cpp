@@ -0,0 +1,305 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The filters benchmark. The entries are converted to HTML by the Sword base
+  filters with the token handling of BibleTime first. The Strong's
+  post-processing of the current and of the former implementation then runs
+  on copies of the same HTML, so only that part is measured and compared.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QSet>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/filters/gbftohtml.h"
+#include "backend/filters/thmltohtml.h"
+#include "legacyfilters.h"
+
+// Sword includes:
+#include <swbuf.h>
+#include <swmodule.h>
+
+
+namespace {
+
+/** Number of failed entries which are printed in full. */
+const int MAX_PRINTED_FAILURES = 10;
+
+/** The HTML of the base filters, before the Strong's post-processing. */
+const char * const THML_SAMPLES[] = {
+    "In the beginning<sync type=\"Strongs\" value=\"H07225\" /> God<sync type=\"Strongs\" value=\"H0430\" /> "
+    "created<sync type=\"Strongs\" value=\"H01254\" /><sync type=\"morph\" value=\"H8804\" /> "
+    "the heaven<sync type=\"Strongs\" value=\"H08064\" />.",
+    "In the beginning was the Word<sync class=\"Strongs\" type=\"Strongs\" value=\"G3056\" />.",
+    "<i>Jesus</i><sync type=\"Strongs\" value=\"G2424\" /> wept<sync type=\"Strongs\" value=\"G1145\" />.",
+    "And,<sync type=\"Strongs\" value=\"G2532\" /> <sync type=\"morph\" value=\"CONJ\" /> he said",
+    "<sync type=\"Strongs\" value=\"G2532\" /> lonely tags before the text",
+    "\xe1\xbc\x98\xce\xbd<sync type=\"Strongs\" value=\"G1722\" /> "
+    "\xe1\xbc\x80\xcf\x81\xcf\x87\xe1\xbf\x87<sync type=\"Strongs\" value=\"G746\" /> "
+    "\xe1\xbc\xa6\xce\xbd<sync type=\"Strongs\" value=\"G2258\" /><sync type=\"morph\" value=\"V-IXI-3S\" />",
+    "No markup at all."
+};
+
+const char * const GBF_SAMPLES[] = {
+    "Am Anfang<WH07225> schuf<WH01254><WTH8804> Gott<WH0430> Himmel<WH08064> und<WT> Erde<WH0776>.",
+    "<span class=\"italic\">Jesus</span><WG2424> wept<WG1145><WTV-AAI-3S>.",
+    "In<WG1722> the beginning<WG746> was<WG2258><WTV-IXI-3S> the Word<WG3056>.",
+    "And,<WG2532> <WTCONJ> he said",
+    "No markup at all."
+};
+
+struct Sample {
+    QString source;
+    bool isThml;
+    sword::SWBuf html;
+};
+
+/** A word with its Strong's numbers and morph codes. */
+struct WordSpan {
+    QString word;
+    QSet<QString> values;
+};
+
+void appendBuiltInSamples(QList<Sample> & samples) {
+    for (size_t i = 0; i < sizeof(THML_SAMPLES) / sizeof(THML_SAMPLES[0]); i++) {
+        Sample s;
+        s.source = QString("ThML sample %1").arg(i + 1);
+        s.isThml = true;
+        s.html = THML_SAMPLES[i];
+        samples.append(s);
+    }
+    for (size_t i = 0; i < sizeof(GBF_SAMPLES) / sizeof(GBF_SAMPLES[0]); i++) {
+        Sample s;
+        s.source = QString("GBF sample %1").arg(i + 1);
+        s.isThml = false;
+        s.html = GBF_SAMPLES[i];
+        samples.append(s);
+    }
+}
+
+/** Converts all entries of a ThML or GBF work with the base filters. */
+void appendModuleSamples(const CSwordModuleInfo * module, QList<Sample> & samples) {
+    sword::SWModule * const m = module->module();
+    const bool isThml = (m->getMarkup() == sword::FMT_THML);
+    if (!isThml && m->getMarkup() != sword::FMT_GBF) {
+        std::cerr << "Warning: " << qPrintable(module->name())
+                  << " is neither ThML nor GBF, skipped." << std::endl;
+        return;
+    }
+
+    Filters::ThmlToHtml thmlFilter;
+    Filters::GbfToHtml gbfFilter;
+
+    m->setSkipConsecutiveLinks(true);
+    m->setPosition(sword::TOP);
+    while (!m->popError()) {
+        Sample s;
+        s.source = QString("%1 %2").arg(module->name(),
+                                        QString::fromUtf8(m->getKeyText()));
+        s.isThml = isThml;
+
+        // The filters work on UTF-8, like the encoding filters of Sword make it:
+        const sword::SWBuf & raw = m->getRawEntryBuf();
+        s.html = (module->isUnicode() ? QString::fromUtf8(raw.c_str())
+                                      : QString::fromLatin1(raw.c_str())).toUtf8().constData();
+        if (isThml) {
+            thmlFilter.sword::ThMLHTML::processText(s.html, m->getKey(), m);
+        } else {
+            gbfFilter.sword::GBFHTML::processText(s.html, m->getKey(), m);
+        }
+        samples.append(s);
+
+        m->increment();
+    }
+}
+
+/**
+  Runs the current or the former post-processing \a rounds times over copies of
+  all samples.
+  \param[out] outputs The results of the first round.
+  \returns the time in milliseconds.
+*/
+qint64 measure(const QList<Sample> & samples,
+               int rounds,
+               bool legacy,
+               QList<sword::SWBuf> & outputs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; round++) {
+        Q_FOREACH (const Sample & s, samples) {
+            sword::SWBuf buf(s.html);
+            if (legacy && s.isThml) {
+                BtBench::legacyThmlWordSpans(buf);
+            } else if (legacy) {
+                BtBench::legacyGbfWordSpans(buf);
+            } else if (s.isThml) {
+                Filters::ThmlToHtml::addWordSpans(buf);
+            } else {
+                Filters::GbfToHtml::addWordSpans(buf);
+            }
+            if (round == 0)
+                outputs.append(buf);
+        }
+    }
+    return qMax(timer.elapsed(), Q_INT64_C(1));
+}
+
+/** \returns the text of \a html without the markup. */
+QString plainText(const sword::SWBuf & html) {
+    static const QRegExp markup("<[^>]*>");
+    return QString::fromUtf8(html.c_str()).remove(markup);
+}
+
+/** \returns the words wrapped in spans with lemma or morph attributes. */
+QList<WordSpan> wordSpans(const sword::SWBuf & html) {
+    QRegExp spanTag("<span ([^>]*(lemma|morph)=\"[^>]*)>");
+    QRegExp attribute("(lemma|morph)=\"([^\"]*)\"");
+    QRegExp spanBoundary("<span[ >]|</span>");
+    const QString t = QString::fromUtf8(html.c_str());
+
+    QList<WordSpan> spans;
+    int pos = 0;
+    while ((pos = spanTag.indexIn(t, pos)) != -1) {
+        WordSpan span;
+        const QString attributes = spanTag.cap(1);
+        for (int a = 0; (a = attribute.indexIn(attributes, a)) != -1;
+             a += attribute.matchedLength())
+        {
+            Q_FOREACH (const QString & value,
+                       attribute.cap(2).split('|', QString::SkipEmptyParts))
+                span.values.insert(value);
+        }
+
+        // Look for the matching end tag, the word may contain other spans:
+        const int start = pos + spanTag.matchedLength();
+        int end = start;
+        for (int depth = 1; depth > 0; end += spanBoundary.matchedLength()) {
+            end = spanBoundary.indexIn(t, end);
+            if (end == -1)
+                break;
+            depth += (spanBoundary.cap(0) == "</span>") ? -1 : 1;
+        }
+        if (end == -1)
+            end = t.length();
+        else
+            end -= 7; // the length of </span>
+
+        span.word = t.mid(start, end - start).remove(QRegExp("<[^>]*>")).trimmed();
+        spans.append(span);
+        pos = start;
+    }
+    return spans;
+}
+
+/**
+  \returns whether \a spans contains the spans of \a reference in the same
+           order. The spans may have more values than their reference
+           counterparts, since the current implementation doesn't drop values
+           any more.
+*/
+bool containsSpans(const QList<WordSpan> & spans, const QList<WordSpan> & reference) {
+    int i = 0;
+    Q_FOREACH (const WordSpan & r, reference) {
+        while (i < spans.size()
+               && !(spans.at(i).word == r.word && spans.at(i).values.contains(r.values)))
+            i++;
+        if (i == spans.size())
+            return false;
+        i++;
+    }
+    return true;
+}
+
+void printFailure(const QString & reason,
+                  const Sample & s,
+                  const sword::SWBuf & current,
+                  const sword::SWBuf & legacy)
+{
+    std::cerr << "FAILED (" << qPrintable(reason) << "): "
+              << qPrintable(s.source) << std::endl
+              << "  input:   " << s.html.c_str() << std::endl
+              << "  current: " << current.c_str() << std::endl
+              << "  former:  " << legacy.c_str() << std::endl;
+}
+
+void printThroughput(const char * name, qint64 ms, int entries, double mib) {
+    std::cout << name << ms << " ms (" << (entries * 1000.0 / ms)
+              << " entries/s, " << (mib * 1000.0 / ms) << " MiB/s)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int filterBenchmark(const QStringList & args) {
+    const int rounds = intArgument(args, "--rounds", 3);
+    if (rounds < 0)
+        return EXIT_FAILURE;
+
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+
+    QList<Sample> samples;
+    appendBuiltInSamples(samples);
+    Q_FOREACH (const CSwordModuleInfo * module, modules)
+        appendModuleSamples(module, samples);
+
+    qint64 bytes = 0;
+    Q_FOREACH (const Sample & s, samples)
+        bytes += s.html.length();
+    const double mib = bytes * rounds / 1024.0 / 1024.0;
+
+    QList<sword::SWBuf> legacyOutputs;
+    QList<sword::SWBuf> currentOutputs;
+    const qint64 legacyTime = measure(samples, rounds, true, legacyOutputs);
+    const qint64 currentTime = measure(samples, rounds, false, currentOutputs);
+
+    int failures = 0;
+    int legacyTextLosses = 0;
+    for (int i = 0; i < samples.size(); i++) {
+        const Sample & s = samples.at(i);
+        const QString input = plainText(s.html);
+
+        QString reason;
+        if (plainText(currentOutputs.at(i)) != input) {
+            reason = "text changed";
+        } else if (!containsSpans(wordSpans(currentOutputs.at(i)),
+                                  wordSpans(legacyOutputs.at(i))))
+        {
+            reason = "spans differ from the former implementation";
+        }
+
+        if (plainText(legacyOutputs.at(i)) != input)
+            legacyTextLosses++;
+
+        if (reason.isNull())
+            continue;
+        if (failures++ < MAX_PRINTED_FAILURES)
+            printFailure(reason, s, currentOutputs.at(i), legacyOutputs.at(i));
+    }
+
+    std::cout << "Entries: " << samples.size() << ", rounds: " << rounds
+              << ", MiB: " << mib << std::endl
+              << "Entries with text lost by the former implementation: "
+              << legacyTextLosses << std::endl
+              << "Failed entries: " << failures << std::endl;
+    printThroughput("Former implementation:  ", legacyTime, samples.size() * rounds, mib);
+    printThroughput("Current implementation: ", currentTime, samples.size() * rounds, mib);
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
@@ -0,0 +1,311 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The Strong's post-processing of ThmlToHtml and GbfToHtml as it was before it
+  was moved to Filters::WordSpanBuilder. It is kept unchanged as the reference
+  for the filters benchmark.
+*/
+
+#include "legacyfilters.h"
+
+#include <QRegExp>
+#include <QString>
+#include <QStringList>
+
+
+namespace BtBench {
+
+void legacyThmlWordSpans(sword::SWBuf &buf) {
+    QString result;
+
+    QString t = QString::fromUtf8(buf.c_str());
+    QRegExp tag("([.,;]?<sync[^>]+(type|value)=\"([^\"]+)\"[^>]+(type|value)=\"([^\"]+)\"([^<]*)>)+");
+
+    QStringList list;
+    int lastMatchEnd = 0;
+    int pos = tag.indexIn(t, 0);
+
+    if (pos == -1) { //no strong or morph code found in this text
+        return;
+    }
+
+    while (pos != -1) {
+        list.append(t.mid(lastMatchEnd, pos + tag.matchedLength() - lastMatchEnd));
+
+        lastMatchEnd = pos + tag.matchedLength();
+        pos = tag.indexIn(t, pos + tag.matchedLength());
+    }
+
+    if (!t.right(t.length() - lastMatchEnd).isEmpty()) {
+        list.append(t.right(t.length() - lastMatchEnd));
+    }
+
+    tag = QRegExp("<sync[^>]+(type|value|class)=\"([^\"]+)\"[^>]+(type|value|class)=\"([^\"]+)\"[^>]+((type|value|class)=\"([^\"]+)\")*([^<]*)>");
+
+    for (QStringList::iterator it = list.begin(); it != list.end(); ++it) {
+        QString e( *it );
+
+        const bool textPresent = (e.trimmed().remove(QRegExp("[.,;:]")).left(1) != "<");
+
+        if (!textPresent) {
+            continue;
+        }
+
+
+        bool hasLemmaAttr = false;
+        bool hasMorphAttr = false;
+
+        int pos = tag.indexIn(e, 0);
+        bool insertedTag = false;
+        QString value;
+        QString valueClass;
+
+        while (pos != -1) {
+            bool isMorph = false;
+            bool isStrongs = false;
+            value = QString::null;
+            valueClass = QString::null;
+
+            // check 3 attribute/value pairs
+
+            for (int i = 1; i < 6; i += 2) {
+                if (i > 4)
+                    i++;
+
+                if (tag.cap(i) == "type") {
+                    isMorph   = (tag.cap(i + 1) == "morph");
+                    isStrongs = (tag.cap(i + 1) == "Strongs");
+                }
+                else if (tag.cap(i) == "value") {
+                    value = tag.cap(i + 1);
+                }
+                else if (tag.cap(i) == "class") {
+                    valueClass = tag.cap(i + 1);
+                }
+            }
+
+            // prepend the class qualifier to the value
+            if (!valueClass.isEmpty()) {
+                value = valueClass + ":" + value;
+                //     value.append(":").append(value);
+            }
+
+            if (value.isEmpty()) {
+                break;
+            }
+
+            //insert the span
+            if (!insertedTag) {
+                e.replace(pos, tag.matchedLength(), "</span>");
+                pos += 7;
+
+                QString rep = QString("<span lemma=\"").append(value).append("\">");
+                int startPos = 0;
+                QChar c = e[startPos];
+
+                while ((startPos < pos) && (c.isSpace() || c.isPunct())) {
+                    ++startPos;
+                    c = e[startPos];
+                }
+
+                hasLemmaAttr = isStrongs;
+                hasMorphAttr = isMorph;
+
+                e.insert( startPos, rep );
+                pos += rep.length();
+            }
+            else { //add the attribute to the existing tag
+                e.remove(pos, tag.matchedLength());
+
+                if ((!isMorph && hasLemmaAttr) || (isMorph && hasMorphAttr)) { //we append another attribute value, e.g. 3000 gets 3000|5000
+                    //search the existing attribute start
+                    QRegExp attrRegExp( isMorph ? "morph=\".+(?=\")" : "lemma=\".+(?=\")" );
+                    attrRegExp.setMinimal(true);
+                    const int foundAttrPos = e.indexOf(attrRegExp, pos);
+
+                    if (foundAttrPos != -1) {
+                        e.insert(foundAttrPos + attrRegExp.matchedLength(), QString("|").append(value));
+                        pos += value.length() + 1;
+
+                        hasLemmaAttr = !isMorph;
+                        hasMorphAttr = isMorph;
+                    }
+                }
+                else { //attribute was not yet inserted
+                    const int attrPos = e.indexOf(QRegExp("morph=|lemma="), 0);
+
+                    if (attrPos >= 0) {
+                        QString attr;
+                        attr.append(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\" ");
+                        e.insert(attrPos, attr);
+
+                        hasMorphAttr = isMorph;
+                        hasLemmaAttr = !isMorph;
+
+                        pos += attr.length();
+                    }
+                }
+            }
+
+            insertedTag = true;
+            pos = tag.indexIn(e, pos);
+        }
+
+        result.append( e );
+    }
+
+    if (list.count()) {
+        buf = result.toUtf8().constData();
+    }
+}
+
+void legacyGbfWordSpans(sword::SWBuf &buf) {
+
+    //Am Anfang<WH07225> schuf<WH01254><WTH8804> Gott<WH0430> Himmel<WH08064> und<WT> Erde<WH0776>.
+    //A simple word<WT> means: No entry for this word "word"
+    QString result;
+
+    QString t = QString::fromUtf8(buf.c_str());
+
+    QRegExp tag("([.,;:]?<W[HGT][^>]*>\\s*)+");
+
+    QStringList list;
+
+    int lastMatchEnd = 0;
+
+    int pos = tag.indexIn(t, 0);
+
+    if (pos == -1) { //no strong or morph code found in this text
+        return;
+    }
+
+    //split the text into parts which end with the GBF tag marker for strongs/lemmas
+    while (pos != -1) {
+        list.append(t.mid(lastMatchEnd, pos + tag.matchedLength() - lastMatchEnd));
+
+        lastMatchEnd = pos + tag.matchedLength();
+        pos = tag.indexIn(t, pos + tag.matchedLength());
+    }
+
+    //append the trailing text to the list.
+    if (!t.right(t.length() - lastMatchEnd).isEmpty()) {
+        list.append(t.right(t.length() - lastMatchEnd));
+    }
+
+    //list is now a list of words with 1-n Strongs at the end, which belong to this word.
+
+    //now create the necessary HTML in list entries and concat them to the result
+    tag = QRegExp("<W([HGT])([^>]*)>");
+    tag.setMinimal(true);
+
+    for (QStringList::iterator it = list.begin(); it != list.end(); ++it) {
+        QString e = (*it); //current entry to process
+        //qWarning(e.latin1());
+
+        //check if there is a word to which the strongs info belongs to.
+        //If yes, wrap that word with the strongs info
+        //If not, leave out the strongs info, because it can't be tight to a text
+        //Comparing the first char with < is not enough, because the tokenReplace is done already
+        //so there might be html tags already.
+        const bool textPresent = (e.trimmed().remove(QRegExp("[.,;:]")).left(2) != "<W");
+
+        if (!textPresent) {
+            result += (*it);
+            continue;
+        }
+
+        int pos = tag.indexIn(e, 0); //try to find a strong number marker
+        bool insertedTag = false;
+        bool hasLemmaAttr = false;
+        bool hasMorphAttr = false;
+
+        QString value = QString::null;
+        int tagAttributeStart = -1;
+
+        while (pos != -1) { //work on all strong/lemma tags in this section, should be between 1-3 loops
+            const bool isMorph = (tag.cap(1) == "T");
+            value = isMorph ? tag.cap(2) : tag.cap(2).prepend( tag.cap(1) );
+
+            if (value.isEmpty()) {
+                break;
+            }
+
+            //insert the span
+            if (!insertedTag) { //we have to insert a new tag end and beginning, i.e. our first loop
+                e.replace(pos, tag.matchedLength(), "</span>");
+                pos += 7;
+
+                //skip blanks, commas, dots and stuff at the beginning, it doesn't belong to the morph code
+                QString rep("<span ");
+                rep.append(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\">");
+
+                hasMorphAttr = isMorph;
+                hasLemmaAttr = !isMorph;
+
+                int startPos = 0;
+                QChar c = e[startPos];
+
+                while ((startPos < pos) && (c.isSpace() || c.isPunct())) {
+                    ++startPos;
+
+                    c = e[startPos];
+                }
+
+                e.insert( startPos, rep );
+                tagAttributeStart = startPos + 6; //to point to the start of the attributes
+                pos += rep.length();
+            }
+            else { //add the attribute to the existing tag
+                e.remove(pos, tag.matchedLength());
+
+                if (tagAttributeStart == -1) {
+                    continue; //nothing valid found
+                }
+
+                if ((!isMorph && hasLemmaAttr) || (isMorph && hasMorphAttr)) { //we append another attribute value, e.g. 3000 gets 3000|5000
+                    //search the existing attribute start
+                    QRegExp attrRegExp( isMorph ? "morph=\".+(?=\")" : "lemma=\".+(?=\")" );
+                    attrRegExp.setMinimal(true);
+                    const int foundPos = e.indexOf(attrRegExp, tagAttributeStart);
+
+                    if (foundPos != -1) {
+                        e.insert(foundPos + attrRegExp.matchedLength(), QString("|").append(value));
+                        pos += value.length() + 1;
+
+                        hasLemmaAttr = !isMorph;
+                        hasMorphAttr = isMorph;
+                    }
+                }
+                else { //attribute was not yet inserted
+                    QString attr = QString(isMorph ? "morph" : "lemma").append("=\"").append(value).append("\" ");
+
+                    e.insert(tagAttributeStart, attr);
+                    pos += attr.length();
+
+                    hasMorphAttr = isMorph;
+                    hasLemmaAttr = !isMorph;
+                }
+
+                //tagAttributeStart remains the same
+            }
+
+            insertedTag = true;
+            pos = tag.indexIn(e, pos);
+        }
+
+        result += e;
+    }
+
+    if (list.count()) {
+        buf = result.toUtf8().constData();
+    }
+}
+
+} // namespace BtBench
@@ -0,0 +1,29 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTBENCH_LEGACYFILTERS_H
+#define BTBENCH_LEGACYFILTERS_H
+
+// Sword includes:
+#include <swbuf.h>
+
+
+namespace BtBench {
+
+/** The former QRegExp implementation of Filters::ThmlToHtml::addWordSpans(). */
+void legacyThmlWordSpans(sword::SWBuf &buf);
+
+/** The former QRegExp implementation of Filters::GbfToHtml::addWordSpans(). */
+void legacyGbfWordSpans(sword::SWBuf &buf);
+
+} // namespace BtBench
+
+#endif
@@ -0,0 +1,187 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  CHTMLExportRendering::renderEntry() as it was before the texts of parallel
+  works were prefetched. It is kept unchanged as the reference for the
+  parallel benchmark.
+*/
+
+#include "legacyparallelrendering.h"
+
+#include <QRegExp>
+#include <QSharedPointer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordkey.h"
+#include "backend/keys/cswordversekey.h"
+#include "backend/managers/clanguagemgr.h"
+
+
+namespace BtBench {
+
+void LegacyParallelRendering::prefetchEntries(const KeyTree &,
+                                              const QList<const CSwordModuleInfo*> &)
+{
+    // Intentionally empty
+}
+
+void LegacyParallelRendering::renderEntry(BtRenderSink &out,
+                                          const KeyTreeItem& i,
+                                          CSwordKey* k)
+{
+    if (i.hasAlternativeContent()) {
+        const KeyTree & tree = *i.childList();
+
+        out.append(i.settings().highlight
+                   ? "<div class=\"currententry\""
+                   : "<div class=\"entry\"");
+
+        //   Q_ASSERT(i.hasChildItems());
+
+        if (!tree.isEmpty()) {
+            const QList<const CSwordModuleInfo*> modules = collectModules(tree);
+
+            if (modules.count() == 1) { //insert the direction into the surrounding div
+                out.append((modules.first()->textDirection() == CSwordModuleInfo::LeftToRight)
+                           ? " dir=\"ltr\""
+                           : " dir=\"rtl\"");
+            }
+        }
+
+        out.append('>').append(i.getAlternativeContent());
+
+        Q_FOREACH (const KeyTreeItem * const item, tree) {
+            renderEntry(out, *item);
+        }
+
+        out.append("</div>");
+        return; //WARNING: Return already here!
+    }
+
+
+    const QList<const CSwordModuleInfo*> &modules(i.modules());
+    if (modules.isEmpty()) {
+        return; //no module present for rendering
+    }
+
+    QSharedPointer<CSwordKey> scoped_key( !k ? CSwordKey::createInstance(modules.first()) : 0 );
+    CSwordKey* key = k ? k : scoped_key.data();
+    Q_ASSERT(key);
+
+    CSwordVerseKey* myVK = dynamic_cast<CSwordVerseKey*>(key);
+
+    if (myVK) {
+        myVK->setIntros(true);
+    }
+
+    // Only insert the table stuff if we are displaying parallel.
+    const bool isParallel = (modules.count() > 1);
+    out.append(isParallel ? "\n\t\t<tr>\n" : "\n");
+
+    //declarations out of the loop for optimization
+    bool isRTL;
+    QByteArray langAttr;
+
+    QList<const CSwordModuleInfo*>::const_iterator end_modItr = modules.end();
+
+    for (QList<const CSwordModuleInfo*>::const_iterator mod_Itr(modules.begin()); mod_Itr != end_modItr; ++mod_Itr) {
+        key->setModule(*mod_Itr);
+        i.positionKey(key);
+
+        isRTL = ((*mod_Itr)->textDirection() == CSwordModuleInfo::RightToLeft);
+
+        {
+            const QByteArray lang((*mod_Itr)->language()->isValid()
+                                  ? (*mod_Itr)->language()->abbrev().toUtf8()
+                                  : QByteArray((*mod_Itr)->module()->getLanguage()));
+            langAttr = QByteArray("xml:lang=\"").append(lang)
+                       .append("\" lang=\"").append(lang).append('"');
+        }
+
+        if (isParallel) {
+            out.append("\t\t<td class=\"")
+               .append(i.settings().highlight ? "currententry" : "entry")
+               .append("\" ")
+               .append(langAttr)
+               .append(isRTL ? " dir=\"rtl\">\n\t\t\t" : " dir=\"ltr\">\n\t\t\t");
+        }
+        else {
+            out.append("\t\t");
+        }
+
+        // Render the text and collect the entry attributes in a single pass:
+        BtRenderBuffer keyText;
+        sword::AttributeTypeList attributes;
+        if (m_filterOptions.headings) {
+            key->renderedText(keyText, attributes);
+        }
+        else if (m_addText) {
+            key->renderedText(keyText);
+        }
+
+        if (m_filterOptions.headings) {
+            const sword::AttributeValue & preverse = attributes["Heading"]["Preverse"];
+
+            for (sword::AttributeValue::const_iterator it = preverse.begin(); it != preverse.end(); ++it) {
+                QString unfiltered = QString::fromUtf8(it->second.c_str());
+
+                /// \todo This is only a preliminary workaround to strip the tags:
+                QRegExp filter("(.*)<title[^>]*>(.*)</title>(.*)");
+                while(filter.indexIn(unfiltered) >= 0) {
+                    unfiltered = filter.cap(1) + filter.cap(2) + filter.cap(3);
+                }
+                // Fiter out offending self-closing div tags, which are bad HTML
+                QRegExp ofilter("(.*)<div[^>]*/>(.*)");
+                while(ofilter.indexIn(unfiltered) >= 0) {
+                    unfiltered = ofilter.cap(1) + ofilter.cap(2);
+                }
+
+                /// \todo Take care of the heading type!
+                if (!unfiltered.isEmpty()) {
+                    out.append("<div ")
+                       .append(langAttr)
+                       .append(" class=\"sectiontitle\">")
+                       .append(unfiltered)
+                       .append("</div>");
+                }
+            }
+        }
+
+        out.append(m_displayOptions.lineBreaks  ? "<div "  : "<div style=\"display: inline;\" ");
+
+        if (!isParallel) { //insert only the class if we're not in a td
+            out.append( i.settings().highlight  ? "class=\"currententry\" " : "class=\"entry\" " );
+        }
+
+        out.append(langAttr).append(isRTL ? " dir=\"rtl\">" : " dir=\"ltr\">");
+
+        //keys should normally be left-to-right, but this doesn't apply in all cases
+        out.append("<span class=\"entryname\" dir=\"ltr\">").append(entryLink(i, *mod_Itr)).append("</span>");
+
+        if (m_addText) {
+            out.append(keyText.data());
+        }
+
+        Q_FOREACH (const KeyTreeItem * const c, *i.childList()) {
+            renderEntry(out, *c);
+        }
+
+        out.append("</div>\n");
+
+        if (isParallel) {
+            out.append("\t\t</td>\n");
+        }
+    }
+
+    if (isParallel) {
+        out.append("\t\t</tr>\n");
+    }
+}
+
+} // namespace BtBench
@@ -0,0 +1,44 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTBENCH_LEGACYPARALLELRENDERING_H
+#define BTBENCH_LEGACYPARALLELRENDERING_H
+
+#include "backend/rendering/cdisplayrendering.h"
+
+
+namespace BtBench {
+
+/**
+  \brief Rendering::CDisplayRendering as it was before parallel texts were
+         prefetched per work.
+
+  Every item is rendered verse-major, moving one key through all works of the
+  item. It is kept unchanged as the reference for the parallel benchmark.
+*/
+class LegacyParallelRendering: public Rendering::CDisplayRendering {
+
+    protected: /* Methods: */
+
+        /** Reimplemented from Rendering::CHTMLExportRendering. */
+        virtual void renderEntry(BtRenderSink &out,
+                                 const KeyTreeItem &item,
+                                 CSwordKey * key = 0);
+
+        /** Reimplemented to prefetch nothing. */
+        virtual void prefetchEntries(const KeyTree &tree,
+                                     const QList<const CSwordModuleInfo*> &modules);
+
+}; /* class LegacyParallelRendering */
+
+} // namespace BtBench
+
+#endif
@@ -0,0 +1,112 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  ReferenceManager::parseVerseReference() as it was before the book name
+  tables and the cache were added. It is kept unchanged as the reference for
+  the references benchmark.
+*/
+
+#include "legacyreferences.h"
+
+#include <algorithm>
+#include <QDebug>
+#include "backend/keys/cswordversekey.h"
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/managers/cswordbackend.h"
+
+// Sword includes:
+#include <listkey.h>
+#include <localemgr.h>
+#include <versekey.h>
+
+
+namespace BtBench {
+
+QString legacyParseVerseReference(const QString& ref, const ReferenceManager::ParseOptions& options) {
+    CSwordModuleInfo* const mod = CSwordBackend::instance()->findModuleByName(options.refDestinationModule);
+    //Q_ASSERT(mod); tested later
+
+    if (!mod) {
+        //parsing of non-verse based references is not supported
+        return ref;
+    }
+
+    if ((mod->type() != CSwordModuleInfo::Bible) && (mod->type() != CSwordModuleInfo::Commentary)) {
+        qDebug() << "CReferenceManager: Only verse based modules are supported as ref destination module";
+        return QString::null;
+    }
+
+    QString sourceLanguage = options.sourceLanguage;
+    QString destinationLanguage = options.destinationLanguage;
+
+    sword::StringList locales = sword::LocaleMgr::getSystemLocaleMgr()->getAvailableLocales();
+    if (/*options.sourceLanguage == "en" ||*/ std::find(locales.begin(), locales.end(), sourceLanguage.toUtf8().constData()) == locales.end()) { //sourceLanguage not available
+        sourceLanguage = "en_US";
+    }
+
+    if (/*options.destinationLanguage == "en" ||*/ std::find(locales.begin(), locales.end(), sourceLanguage.toUtf8().constData()) == locales.end()) { //destination not available
+        destinationLanguage = "en_US";
+    }
+
+    QString ret;
+    QStringList refList = ref.split(";");
+
+    CSwordVerseKey baseKey(0);
+    baseKey.setLocale( sourceLanguage.toUtf8().constData() );
+    baseKey.setKey(options.refBase); //probably in the sourceLanguage
+    baseKey.setLocale( "en_US" ); //english works in all environments as base
+
+//     CSwordVerseKey dummy(0);
+    //HACK: We have to workaround a Sword bug, we have to set the default locale to the same as the sourceLanguage !
+    const QString oldLocaleName = CSwordBackend::instance()->booknameLanguage();
+    CSwordBackend::instance()->booknameLanguage(sourceLanguage);
+
+    sword::VerseKey dummy;
+    dummy.setLocale( sourceLanguage.toUtf8().constData() );
+    Q_ASSERT( !strcmp(dummy.getLocale(), sourceLanguage.toUtf8().constData()) );
+
+//     qDebug("Parsing '%s' in '%s' using '%s' as base, source lang '%s', dest lang '%s'", ref.latin1(), options.refDestinationModule.latin1(), baseKey.key().latin1(), sourceLanguage.latin1(), destinationLanguage.latin1());
+
+    for (QStringList::iterator it = refList.begin(); it != refList.end(); ++it) {
+        //The listkey may contain more than one item, because a ref lik "Gen 1:3,5" is parsed into two single refs
+        sword::ListKey lk = dummy.parseVerseList((*it).toUtf8().constData(), baseKey.key().toUtf8().constData(), true);
+        Q_ASSERT(!dummy.popError());
+
+        //Q_ASSERT(lk.Count());
+        if (!lk.getCount()) {
+            ret.append( *it ); //don't change the original
+            continue;
+        }
+
+        for (int i = 0; i < lk.getCount(); ++i) {
+            if (dynamic_cast<sword::VerseKey*>(lk.getElement(i))) { // a range
+                sword::VerseKey* k = dynamic_cast<sword::VerseKey*>(lk.getElement(i));
+                Q_ASSERT(k);
+                k->setLocale( destinationLanguage.toUtf8().constData() );
+
+                ret.append( QString::fromUtf8(k->getRangeText()) ).append("; ");
+            }
+            else { // a single ref
+                sword::VerseKey vk;
+                vk.setLocale( sourceLanguage.toUtf8().constData() );
+                vk = lk.getElement(i)->getText();
+                vk.setLocale( destinationLanguage.toUtf8().constData() );
+
+                ret.append( QString::fromUtf8(vk.getText()) ).append("; ");
+            }
+        }
+
+    }
+
+    CSwordBackend::instance()->booknameLanguage(oldLocaleName);
+    return ret;
+}
+
+} // namespace BtBench
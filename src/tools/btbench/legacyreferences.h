@@ -0,0 +1,29 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTBENCH_LEGACYREFERENCES_H
+#define BTBENCH_LEGACYREFERENCES_H
+
+#include <QString>
+#include "backend/managers/referencemanager.h"
+
+
+namespace BtBench {
+
+/**
+  The former implementation of ReferenceManager::parseVerseReference(), which
+  switched the global bookname language for every call.
+*/
+QString legacyParseVerseReference(const QString& ref, const ReferenceManager::ParseOptions& options);
+
+} // namespace BtBench
+
+#endif
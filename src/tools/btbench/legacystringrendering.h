@@ -0,0 +1,43 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTBENCH_LEGACYSTRINGRENDERING_H
+#define BTBENCH_LEGACYSTRINGRENDERING_H
+
+#include "backend/rendering/cdisplayrendering.h"
+
+
+namespace BtBench {
+
+/**
+  \brief Rendering::CDisplayRendering as it was before the entries were
+         rendered into a Rendering::BtRenderSink.
+
+  Every entry is returned as a QString and appended to the page. It is kept as
+  the reference for the book benchmark.
+*/
+class LegacyStringRendering: public Rendering::CDisplayRendering {
+
+    public: /* Methods: */
+
+        /** The former Rendering::CTextRendering::renderKeyTree(). */
+        QString renderKeyTreeToString(const KeyTree &tree);
+
+    private: /* Methods: */
+
+        /** The former Rendering::CHTMLExportRendering::renderEntry(). */
+        QString renderStringEntry(const KeyTreeItem &item, CSwordKey * key = 0);
+
+}; /* class LegacyStringRendering */
+
+} // namespace BtBench
+
+#endif
@@ -0,0 +1,143 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The OSIS benchmark. All filter options are switched on and every entry of an
+  OSIS work is run through the option filters of Sword once. The current and
+  the former Filters::OsisToHtml then convert copies of the same text, so only
+  the render filters are measured, and their outputs have to be equal.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/filters/osistohtml.h"
+#include "backend/managers/cswordbackend.h"
+#include "legacyosistohtml.h"
+
+// Sword includes:
+#include <swbuf.h>
+#include <swmodule.h>
+
+
+namespace {
+
+/** Number of mismatching entries which are printed in full. */
+const int MAX_PRINTED_FAILURES = 10;
+
+/** \returns the options with every filter switched on and all variants shown. */
+FilterOptions allFilterOptions() {
+    FilterOptions options;
+    options.footnotes = 1;
+    options.strongNumbers = 1;
+    options.headings = 1;
+    options.morphTags = 1;
+    options.lemmas = 1;
+    options.hebrewPoints = 1;
+    options.hebrewCantillation = 1;
+    options.greekAccents = 1;
+    options.textualVariants = 2;
+    options.redLetterWords = 1;
+    options.scriptureReferences = 1;
+    options.morphSegmentation = 1;
+    return options;
+}
+
+/** Converts \a text with \a filter and adds the time taken to \a nsecs. */
+sword::SWBuf convert(sword::SWFilter & filter,
+                     const sword::SWBuf & text,
+                     sword::SWModule * module,
+                     qint64 & nsecs)
+{
+    sword::SWBuf buf(text);
+    QElapsedTimer timer;
+    timer.start();
+    filter.processText(buf, module->getKey(), module);
+    nsecs += timer.nsecsElapsed();
+    return buf;
+}
+
+void printThroughput(const char * name, qint64 nsecs, int entries, double mib) {
+    const double ms = qMax(nsecs / 1000000.0, 1.0);
+    std::cout << name << ms << " ms (" << (entries * 1000.0 / ms)
+              << " entries/s, " << (mib * 1000.0 / ms) << " MiB/s)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int osisBenchmark(const QStringList & args) {
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+    if (modules.size() != 1
+        || modules.first()->module()->getMarkup() != sword::FMT_OSIS)
+    {
+        std::cerr << "Error: Give one OSIS work with --module. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const CSwordModuleInfo * const module = modules.first();
+    sword::SWModule * const m = module->module();
+
+    CSwordBackend::instance()->setFilterOptions(allFilterOptions());
+
+    Filters::OsisToHtml current;
+    BtBench::LegacyOsisToHtml legacy;
+
+    int entries = 0;
+    int failures = 0;
+    qint64 bytes = 0;
+    qint64 currentTime = 0;
+    qint64 legacyTime = 0;
+
+    m->setSkipConsecutiveLinks(true);
+    m->setPosition(sword::TOP);
+    while (!m->popError()) {
+        // The filters work on UTF-8, like the encoding filters of Sword make it:
+        const sword::SWBuf & raw = m->getRawEntryBuf();
+        sword::SWBuf text = (module->isUnicode()
+                             ? QString::fromUtf8(raw.c_str())
+                             : QString::fromLatin1(raw.c_str())).toUtf8().constData();
+
+        /* Rendering the entry first fills the entry attributes, e.g. the
+           footnote bodies, for this entry like in BibleTime: */
+        m->renderText();
+        m->optionFilter(text, m->getKey());
+        bytes += text.length();
+
+        const sword::SWBuf legacyHtml = convert(legacy, text, m, legacyTime);
+        const sword::SWBuf currentHtml = convert(current, text, m, currentTime);
+        entries++;
+
+        if (currentHtml != legacyHtml && failures++ < MAX_PRINTED_FAILURES) {
+            std::cerr << "FAILED: " << qPrintable(module->name()) << ' '
+                      << m->getKeyText() << std::endl
+                      << "  input:   " << text.c_str() << std::endl
+                      << "  current: " << currentHtml.c_str() << std::endl
+                      << "  former:  " << legacyHtml.c_str() << std::endl;
+        }
+
+        m->increment();
+    }
+
+    const double mib = bytes / 1024.0 / 1024.0;
+    std::cout << "Entries: " << entries << ", MiB: " << mib << std::endl
+              << "Failed entries: " << failures << std::endl;
+    printThroughput("Former implementation:  ", legacyTime, entries, mib);
+    printThroughput("Current implementation: ", currentTime, entries, mib);
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
@@ -0,0 +1,130 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The parallel benchmark. A chapter is rendered in several Bibles side by side
+  like in a display window, once verse-major through the former renderEntry()
+  which moves one key through all works for every verse, and once with the
+  texts prefetched work by work. Both pages have to be equal.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordversekey.h"
+#include "backend/rendering/cdisplayrendering.h"
+#include "legacyparallelrendering.h"
+
+
+namespace {
+
+typedef Rendering::CTextRendering::KeyTree KeyTree;
+typedef Rendering::CTextRendering::KeyTreeItem KeyTreeItem;
+
+/**
+  Renders \a tree with \a rendering.
+  \param[out] page The rendered page.
+  \returns the time in milliseconds.
+*/
+qint64 measure(Rendering::CTextRendering & rendering,
+               const KeyTree & tree,
+               QString & page)
+{
+    QElapsedTimer timer;
+    timer.start();
+    page = rendering.renderKeyTree(tree);
+    return qMax(timer.elapsed(), Q_INT64_C(1));
+}
+
+void printThroughput(const char * name, qint64 ms, int verses) {
+    std::cout << name << ms << " ms (" << (verses * 1000.0 / ms)
+              << " verses/s)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int parallelBenchmark(const QStringList & args) {
+    const int rounds = intArgument(args, "--rounds", 3);
+    if (rounds < 0)
+        return EXIT_FAILURE;
+
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+    if (modules.size() < 2) {
+        std::cerr << "Error: Give at least two Bibles with --module. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    Q_FOREACH (const CSwordModuleInfo * module, modules) {
+        if (module->type() != CSwordModuleInfo::Bible) {
+            std::cerr << "Error: " << qPrintable(module->name())
+                      << " is no Bible." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const int i = args.indexOf("--chapter");
+    const QString chapterKey = (i >= 0 && i + 1 < args.size())
+                               ? args.at(i + 1)
+                               : QString("Genesis 1");
+    CSwordVerseKey start(modules.first());
+    if (!start.setKey(chapterKey)) {
+        std::cerr << "Error: Invalid chapter: " << qPrintable(chapterKey)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    start.setVerse(1);
+
+    // Build the tree of the chapter like renderKeyRange() does:
+    KeyTree tree;
+    KeyTreeItem::Settings settings;
+    CSwordVerseKey vk(start);
+    do {
+        settings.highlight = (vk.getIndex() == start.getIndex());
+        tree.append(new KeyTreeItem(vk, modules, settings));
+    } while (vk.next(CSwordVerseKey::UseVerse)
+             && vk.getTestament() == start.getTestament()
+             && vk.getBook() == start.getBook()
+             && vk.getChapter() == start.getChapter());
+    const int verses = tree.size();
+
+    BtBench::LegacyParallelRendering legacy;
+    Rendering::CDisplayRendering current;
+
+    qint64 legacyTime = 0;
+    qint64 currentTime = 0;
+    int failures = 0;
+    for (int round = 0; round < rounds; round++) {
+        QString legacyPage;
+        QString currentPage;
+        legacyTime += measure(legacy, tree, legacyPage);
+        currentTime += measure(current, tree, currentPage);
+        if (currentPage != legacyPage && failures++ == 0) {
+            std::cerr << "FAILED: The pages differ." << std::endl
+                      << "  current: " << currentPage.size() << " characters" << std::endl
+                      << "  former:  " << legacyPage.size() << " characters" << std::endl;
+        }
+    }
+
+    std::cout << "Verses: " << verses << " from " << qPrintable(start.key())
+              << ", works: " << modules.size() << ", rounds: " << rounds << std::endl
+              << "Failed rounds: " << failures << std::endl;
+    printThroughput("Verse-major rendering: ", legacyTime, verses * rounds);
+    printThroughput("Prefetched rendering:  ", currentTime, verses * rounds);
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
@@ -0,0 +1,136 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The range benchmark. A range of verses is rendered like
+  CTextRendering::renderKeyRange() does it for the display windows, once with
+  tree items which store the text of their key, as it was done before, and
+  once with the items which store the verse index. Building the tree is part
+  of the measured time. Both pages have to be equal.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordversekey.h"
+#include "backend/rendering/cdisplayrendering.h"
+
+
+namespace {
+
+typedef Rendering::CTextRendering::KeyTree KeyTree;
+typedef Rendering::CTextRendering::KeyTreeItem KeyTreeItem;
+
+/**
+  Builds the tree of \a verses verses from \a start on like renderKeyRange()
+  does, with the former or with the current tree items, and renders it.
+  \param[out] page The rendered page.
+  \returns the time in milliseconds.
+*/
+qint64 measure(const CSwordVerseKey & start,
+               int verses,
+               const QList<const CSwordModuleInfo *> & modules,
+               bool legacy,
+               QString & page)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    CSwordVerseKey vk(start);
+    const QString highlightKey = start.key();
+    const long highlightIndex = start.getIndex();
+    KeyTree tree;
+    KeyTreeItem::Settings settings;
+    for (int i = 0; i < verses; i++) {
+        if (legacy) {
+            settings.highlight = (vk.key() == highlightKey);
+            tree.append(new KeyTreeItem(vk.key(), modules, settings));
+        } else {
+            settings.highlight = (vk.getIndex() == highlightIndex);
+            tree.append(new KeyTreeItem(vk, modules, settings));
+        }
+        if (!vk.next(CSwordVerseKey::UseVerse))
+            break;
+    }
+
+    Rendering::CDisplayRendering rendering;
+    page = rendering.renderKeyTree(tree);
+    return qMax(timer.elapsed(), Q_INT64_C(1));
+}
+
+void printThroughput(const char * name, qint64 ms, int verses) {
+    std::cout << name << ms << " ms (" << (verses * 1000.0 / ms)
+              << " verses/s)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int rangeBenchmark(const QStringList & args) {
+    const int verses = intArgument(args, "--verses", 1000);
+    const int rounds = intArgument(args, "--rounds", 3);
+    if (verses < 0 || rounds < 0)
+        return EXIT_FAILURE;
+
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+    if (modules.isEmpty()) {
+        std::cerr << "Error: Give at least one Bible with --module. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    Q_FOREACH (const CSwordModuleInfo * module, modules) {
+        if (module->type() != CSwordModuleInfo::Bible) {
+            std::cerr << "Error: " << qPrintable(module->name())
+                      << " is no Bible." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const int i = args.indexOf("--start");
+    const QString startKey = (i >= 0 && i + 1 < args.size())
+                             ? args.at(i + 1)
+                             : QString("Genesis 1:1");
+    CSwordVerseKey start(modules.first());
+    if (!start.setKey(startKey)) {
+        std::cerr << "Error: Invalid start key: " << qPrintable(startKey)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    qint64 legacyTime = 0;
+    qint64 currentTime = 0;
+    int failures = 0;
+    for (int round = 0; round < rounds; round++) {
+        QString legacyPage;
+        QString currentPage;
+        legacyTime += measure(start, verses, modules, true, legacyPage);
+        currentTime += measure(start, verses, modules, false, currentPage);
+        if (currentPage != legacyPage && failures++ == 0) {
+            std::cerr << "FAILED: The pages differ." << std::endl
+                      << "  current: " << currentPage.size() << " characters" << std::endl
+                      << "  former:  " << legacyPage.size() << " characters" << std::endl;
+        }
+    }
+
+    std::cout << "Verses: " << verses << " from " << qPrintable(start.key())
+              << ", works: " << modules.size() << ", rounds: " << rounds << std::endl
+              << "Failed rounds: " << failures << std::endl;
+    printThroughput("Former tree items:  ", legacyTime, verses * rounds);
+    printThroughput("Current tree items: ", currentTime, verses * rounds);
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
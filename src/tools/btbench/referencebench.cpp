@@ -0,0 +1,221 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  The references benchmark. References in several languages are generated
+  with Sword from a fixed seed, so every run parses the same references. They
+  are parsed by the former and by the current implementation of
+  ReferenceManager::parseVerseReference() into the destination language. The
+  current one runs a second time, which only hits its cache if there are
+  fewer references than the cache holds.
+*/
+
+#include "btbench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include <QSet>
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/managers/referencemanager.h"
+#include "legacyreferences.h"
+
+// Sword includes:
+#include <localemgr.h>
+#include <versekey.h>
+
+
+namespace {
+
+/** Number of mismatching references which are printed in full. */
+const int MAX_PRINTED_FAILURES = 10;
+
+const char * const DEFAULT_LANGUAGES = "en_US,de,fr,es,pt_BR,ru,nl,it";
+
+struct Reference {
+    QString text;
+    QString language;
+};
+
+/** A linear congruential generator, so the references are the same everywhere. */
+class Random {
+
+    public: /* Methods: */
+
+        inline Random() : m_state(20140101u) {}
+
+        /** \returns a number in [1, max]. */
+        inline int next(int max) {
+            m_state = m_state * 1103515245u + 12345u;
+            return static_cast<int>((m_state >> 16) % static_cast<quint32>(max)) + 1;
+        }
+
+    private: /* Fields: */
+
+        quint32 m_state;
+
+};
+
+/**
+  Generates \a count references, cycling through the given languages and the
+  forms "Book C:V", "Bk C:V", "Book C:V-V" and "Book C:V-C:V".
+*/
+QList<Reference> generateReferences(const QStringList & languages, int count) {
+    Random random;
+    QList<Reference> refs;
+    for (int i = 0; i < count; i++) {
+        const QString & language = languages.at(i % languages.size());
+        sword::VerseKey key;
+        key.setLocale(language.toUtf8().constData());
+
+        const int testament = random.next(2);
+        key.setTestament(testament);
+        key.setBook(random.next(key.BMAX[testament - 1]));
+        key.setChapter(random.next(key.getChapterMax()));
+        key.setVerse(random.next(key.getVerseMax()));
+
+        Reference ref;
+        ref.language = language;
+        switch ((i / languages.size()) % 4) {
+            case 0:
+                ref.text = QString::fromUtf8(key.getText());
+                break;
+            case 1:
+                ref.text = QString::fromUtf8(key.getShortText());
+                break;
+            case 2: {
+                const int verse = key.getVerse();
+                const int endVerse = verse + random.next(key.getVerseMax() - verse + 1) - 1;
+                ref.text = QString::fromUtf8(key.getText()) + "-" + QString::number(endVerse);
+                break;
+            }
+            default: {
+                ref.text = QString::fromUtf8(key.getText());
+                if (key.getChapter() < key.getChapterMax()) {
+                    key.setChapter(key.getChapter() + 1);
+                    key.setVerse(random.next(key.getVerseMax()));
+                }
+                ref.text.append("-").append(QString::number(key.getChapter()))
+                        .append(':').append(QString::number(key.getVerse()));
+                break;
+            }
+        }
+        refs.append(ref);
+    }
+    return refs;
+}
+
+/**
+  Parses all references with the former or the current implementation.
+  \param[out] results The parsed references.
+  \returns the time in milliseconds.
+*/
+qint64 measure(const QList<Reference> & refs,
+               ReferenceManager::ParseOptions options,
+               bool legacy,
+               QStringList & results)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Q_FOREACH (const Reference & ref, refs) {
+        options.sourceLanguage = ref.language;
+        results.append(legacy
+                       ? BtBench::legacyParseVerseReference(ref.text, options)
+                       : ReferenceManager::parseVerseReference(ref.text, options));
+    }
+    return qMax(timer.elapsed(), Q_INT64_C(1));
+}
+
+void printThroughput(const char * name, qint64 ms, int refs) {
+    std::cout << name << ms << " ms (" << (refs * 1000.0 / ms)
+              << " references/s)" << std::endl;
+}
+
+} // anonymous namespace
+
+namespace BtBench {
+
+int referenceBenchmark(const QStringList & args) {
+    const int count = intArgument(args, "--count", 10000);
+    if (count < 0)
+        return EXIT_FAILURE;
+
+    QList<const CSwordModuleInfo *> modules;
+    if (!findModules(args, modules))
+        return EXIT_FAILURE;
+    if (modules.size() != 1 || modules.first()->type() != CSwordModuleInfo::Bible) {
+        std::cerr << "Error: Give one Bible with --module. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    QSet<QString> available;
+    const sword::StringList locales =
+            sword::LocaleMgr::getSystemLocaleMgr()->getAvailableLocales();
+    for (sword::StringList::const_iterator it = locales.begin(); it != locales.end(); ++it)
+        available.insert(QString::fromUtf8(it->c_str()));
+
+    const int i = args.indexOf("--languages");
+    const QString languageList = (i >= 0 && i + 1 < args.size())
+                                 ? args.at(i + 1)
+                                 : QString(DEFAULT_LANGUAGES);
+    QStringList languages;
+    Q_FOREACH (const QString & language, languageList.split(',', QString::SkipEmptyParts)) {
+        if (available.contains(language)) {
+            languages.append(language);
+        } else {
+            std::cerr << "Warning: Sword has no locale " << qPrintable(language)
+                      << ", skipped." << std::endl;
+        }
+    }
+    if (languages.isEmpty()) {
+        std::cerr << "Error: None of the languages is available." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const QList<Reference> refs = generateReferences(languages, count);
+
+    ReferenceManager::ParseOptions options;
+    options.refDestinationModule = modules.first()->name();
+    options.refBase = "Genesis 1:1";
+    options.destinationLanguage = "en_US";
+
+    QStringList legacyResults;
+    QStringList currentResults;
+    QStringList againResults;
+    const qint64 legacyTime = measure(refs, options, true, legacyResults);
+    const qint64 currentTime = measure(refs, options, false, currentResults);
+    const qint64 againTime = measure(refs, options, false, againResults);
+
+    int failures = 0;
+    for (int j = 0; j < refs.size(); j++) {
+        if (currentResults.at(j) == legacyResults.at(j)
+            && againResults.at(j) == legacyResults.at(j))
+            continue;
+
+        if (failures++ < MAX_PRINTED_FAILURES) {
+            std::cerr << "FAILED: " << qPrintable(refs.at(j).text)
+                      << " (" << qPrintable(refs.at(j).language) << ")" << std::endl
+                      << "  current: " << qPrintable(currentResults.at(j)) << std::endl
+                      << "  again:   " << qPrintable(againResults.at(j)) << std::endl
+                      << "  former:  " << qPrintable(legacyResults.at(j)) << std::endl;
+        }
+    }
+
+    std::cout << "References: " << refs.size() << ", languages: "
+              << qPrintable(languages.join(",")) << std::endl
+              << "Failed references: " << failures << std::endl;
+    printThroughput("Former implementation:         ", legacyTime, refs.size());
+    printThroughput("Current implementation:        ", currentTime, refs.size());
+    printThroughput("Current implementation, again: ", againTime, refs.size());
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace BtBench
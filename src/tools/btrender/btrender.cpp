@@ -0,0 +1,530 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  btrender - renders references read from the standard input with the backend
+  of BibleTime and writes the result as HTML, plain text or JSON lines.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLocale>
+#include <QProcess>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include "backend/config/btconfig.h"
+#include "backend/drivers/cswordmoduleinfo.h"
+#include "backend/keys/cswordversekey.h"
+#include "backend/managers/btstringmgr.h"
+#include "backend/managers/cdisplaytemplatemgr.h"
+#include "backend/managers/cswordbackend.h"
+#include "backend/rendering/chtmlexportrendering.h"
+#include "backend/rendering/cjsonlinesexportrendering.h"
+#include "backend/rendering/cplaintextexportrendering.h"
+#include "bibletimeapp.h"
+#include "util/directory.h"
+
+// Sword includes:
+#include <listkey.h>
+#include <swlog.h>
+
+
+using namespace Rendering;
+
+namespace {
+
+/** Number of entries rendered and written at once. */
+const int CHUNK_SIZE = 100;
+
+struct Options {
+    QStringList moduleNames;
+    QString format;
+    bool addText;
+    DisplayOptions displayOptions;
+    FilterOptions filterOptions;
+    int jobs;
+    QString outputFile;
+    bool worker;
+
+    Options() : format("html"), addText(true), jobs(1), worker(false) {
+        displayOptions.lineBreaks = 1;
+        displayOptions.verseNumbers = 1;
+    }
+};
+
+/*******************************************************************************
+  Printing command-line help.
+*******************************************************************************/
+
+void printHelp(const QString &executable) {
+    std::cout << qPrintable(executable) << " --module <name> [options] < references"
+        << std::endl << std::endl
+        << "    --module, -m <name>" << std::endl << "        "
+        << "Render the given work, may be given several times for a parallel view"
+        << std::endl << std::endl
+        << "    --format, -f <html|text|jsonl>" << std::endl << "        "
+        << "Output format, html by default"
+        << std::endl << std::endl
+        << "    --filters <option,...>" << std::endl << "        "
+        << "Enable the given filter options: footnotes, strongNumbers, headings,"
+        << std::endl << "        "
+        << "morphTags, lemmas, hebrewPoints, hebrewCantillation, greekAccents,"
+        << std::endl << "        "
+        << "redLetterWords, scriptureReferences, morphSegmentation"
+        << std::endl << std::endl
+        << "    --no-line-breaks, --no-verse-numbers, --keys-only" << std::endl << "        "
+        << "Change the display options or leave out the text of the entries"
+        << std::endl << std::endl
+        << "    --jobs, -j <n>" << std::endl << "        "
+        << "Render in n worker processes, 1 by default"
+        << std::endl << std::endl
+        << "    --output, -o <file>" << std::endl << "        "
+        << "Write to the given file instead of the standard output"
+        << std::endl << std::endl
+        << "Each line of the standard input holds a reference or a range like "
+           "\"Gen 1:1-2:3\"." << std::endl
+        << "Statistics are written to the standard error output." << std::endl;
+}
+
+/*******************************************************************************
+  Parsing command-line arguments
+*******************************************************************************/
+
+bool enableFilters(FilterOptions &o, const QString &list) {
+    Q_FOREACH (const QString &name, list.split(',', QString::SkipEmptyParts)) {
+        if (name == "footnotes") o.footnotes = 1;
+        else if (name == "strongNumbers") o.strongNumbers = 1;
+        else if (name == "headings") o.headings = 1;
+        else if (name == "morphTags") o.morphTags = 1;
+        else if (name == "lemmas") o.lemmas = 1;
+        else if (name == "hebrewPoints") o.hebrewPoints = 1;
+        else if (name == "hebrewCantillation") o.hebrewCantillation = 1;
+        else if (name == "greekAccents") o.greekAccents = 1;
+        else if (name == "redLetterWords") o.redLetterWords = 1;
+        else if (name == "scriptureReferences") o.scriptureReferences = 1;
+        else if (name == "morphSegmentation") o.morphSegmentation = 1;
+        else {
+            std::cerr << "Error: Unknown filter option: " << qPrintable(name)
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+  Parses all command-line arguments.
+  \retval -1 Parsing was successful, the application should exit with
+             EXIT_SUCCESS.
+  \retval 0 Parsing was successful.
+  \retval 1 Parsing failed, the application should exit with EXIT_FAILURE.
+*/
+int parseCommandLine(Options &o) {
+    const QStringList args = BibleTimeApp::arguments();
+    for (int i = 1; i < args.size(); i++) {
+        const QString &arg = args.at(i);
+        if (arg == "--help" || arg == "-h") {
+            printHelp(args.at(0));
+            return -1;
+        } else if (arg == "--no-line-breaks") {
+            o.displayOptions.lineBreaks = 0;
+        } else if (arg == "--no-verse-numbers") {
+            o.displayOptions.verseNumbers = 0;
+        } else if (arg == "--keys-only") {
+            o.addText = false;
+        } else if (arg == "--worker") {
+            o.worker = true;
+        } else if (arg == "--module" || arg == "-m"
+                   || arg == "--format" || arg == "-f"
+                   || arg == "--filters"
+                   || arg == "--jobs" || arg == "-j"
+                   || arg == "--output" || arg == "-o")
+        {
+            if (++i >= args.size()) {
+                std::cerr << "Error: " << qPrintable(arg)
+                          << " expects an argument. See --help for details."
+                          << std::endl;
+                return 1;
+            }
+            const QString &value = args.at(i);
+            if (arg == "--module" || arg == "-m") {
+                o.moduleNames.append(value);
+            } else if (arg == "--format" || arg == "-f") {
+                o.format = value;
+            } else if (arg == "--filters") {
+                if (!enableFilters(o.filterOptions, value))
+                    return 1;
+            } else if (arg == "--jobs" || arg == "-j") {
+                bool ok;
+                o.jobs = value.toInt(&ok);
+                if (!ok || o.jobs < 1) {
+                    std::cerr << "Error: Invalid number of jobs: "
+                              << qPrintable(value) << std::endl;
+                    return 1;
+                }
+            } else {
+                o.outputFile = value;
+            }
+        } else {
+            std::cerr << "Error: Invalid command-line argument: "
+                      << qPrintable(arg) << std::endl;
+            return 1;
+        }
+    }
+
+    if (o.moduleNames.isEmpty()) {
+        std::cerr << "Error: No work given. See --help for details." << std::endl;
+        return 1;
+    }
+    if (o.format != "html" && o.format != "text" && o.format != "jsonl") {
+        std::cerr << "Error: Invalid format: " << qPrintable(o.format) << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*******************************************************************************
+  Rendering
+*******************************************************************************/
+
+bool initBackend() {
+    namespace DU = util::directory;
+
+    qRegisterMetaType<FilterOptions>("FilterOptions");
+    qRegisterMetaType<DisplayOptions>("DisplayOptions");
+    qRegisterMetaType<BtConfig::StringMap>("StringMap");
+    qRegisterMetaTypeStreamOperators<BtConfig::StringMap>("StringMap");
+
+    if (!DU::initDirectoryCache()) {
+        std::cerr << "Error: Failed to initialize the directory cache." << std::endl;
+        return false;
+    }
+
+    bApp->startInit();
+    if (!bApp->initBtConfig())
+        return false;
+
+    QString errorMessage;
+    new CDisplayTemplateMgr(errorMessage);
+    if (!errorMessage.isNull()) {
+        std::cerr << "Error: " << qPrintable(errorMessage) << std::endl;
+        return false;
+    }
+
+    sword::StringMgr::setSystemStringMgr(new BtStringMgr());
+    sword::SWLog::getSystemLog()->setLogLevel(sword::SWLog::LOG_ERROR);
+
+    CSwordBackend * const backend = CSwordBackend::createInstance();
+    backend->booknameLanguage(btConfig().value<QString>("language", QLocale::system().name()));
+    if (backend->initModules(CSwordBackend::OtherChange) != CSwordBackend::NoError) {
+        std::cerr << "Error: Failed to load the installed works." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+CTextRendering * newRenderer(const Options &o) {
+    if (o.format == "text")
+        return new CPlainTextExportRendering(o.addText, o.displayOptions, o.filterOptions);
+    if (o.format == "jsonl")
+        return new CJsonLinesExportRendering(o.addText, o.displayOptions, o.filterOptions);
+    return new CHTMLExportRendering(o.addText, o.displayOptions, o.filterOptions);
+}
+
+/** The output file or the standard output, counting the written bytes. */
+struct Output {
+    QFile file;
+    qint64 bytes;
+
+    Output(const QString & fileName) : file(fileName), bytes(0) {}
+
+    bool open() {
+        const bool ok = file.fileName().isEmpty()
+                        ? file.open(stdout, QIODevice::WriteOnly)
+                        : file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (!ok)
+            std::cerr << "Error: Failed to open the output file "
+                      << qPrintable(file.fileName()) << std::endl;
+        return ok;
+    }
+
+    bool write(const QByteArray & data) {
+        if (file.write(data) != data.size())
+            return false;
+        bytes += data.size();
+        return true;
+    }
+};
+
+/** Renders the appended entries in chunks and writes them to the output. */
+class EntryWriter {
+
+    public: /* Methods: */
+
+        EntryWriter(CTextRendering * renderer, Output & output)
+            : m_renderer(renderer), m_output(output), m_entries(0) {}
+
+        bool append(CTextRendering::KeyTreeItem * item) {
+            m_chunk.append(CTextRendering::KeyTreeSharedPointer(item));
+            m_entries++;
+            return (m_chunk.count() < CHUNK_SIZE) || flush();
+        }
+
+        bool flush() {
+            if (m_chunk.isEmpty())
+                return true;
+
+            BtRenderBuffer out(m_chunk.count() * 1024);
+            m_renderer->renderEntries(out, m_chunk);
+            m_chunk.clear();
+            return m_output.write(out.data());
+        }
+
+        inline int entries() const { return m_entries; }
+
+    private: /* Fields: */
+
+        CTextRendering * const m_renderer;
+        Output & m_output;
+        CTextRendering::KeyTree m_chunk;
+        int m_entries;
+
+};
+
+/** Appends the entries of the reference or range \a ref to \a writer. */
+bool appendReference(EntryWriter & writer,
+                     const QString & ref,
+                     const QList<const CSwordModuleInfo*> & modules)
+{
+    const CTextRendering::KeyTreeItem::Settings settings;
+    const CSwordModuleInfo * const module = modules.first();
+    if (module->type() != CSwordModuleInfo::Bible
+        && module->type() != CSwordModuleInfo::Commentary)
+        return writer.append(new CTextRendering::KeyTreeItem(ref, modules, settings));
+
+    CSwordVerseKey parser(module);
+    sword::ListKey refs = parser.parseVerseList(ref.toUtf8().constData(), "Genesis 1:1", true);
+    for (int i = 0; i < refs.getCount(); i++) {
+        const sword::VerseKey * const element =
+                dynamic_cast<const sword::VerseKey *>(refs.getElement(i));
+        if (element == 0 || !element->isBoundSet()) {
+            const QString key = QString::fromUtf8(refs.getElement(i)->getText());
+            if (!writer.append(new CTextRendering::KeyTreeItem(key, modules, settings)))
+                return false;
+            continue;
+        }
+
+        CSwordVerseKey current(module);
+        current.setKey(QString::fromUtf8(element->getLowerBound().getText()));
+        CSwordVerseKey stop(module);
+        stop.setKey(QString::fromUtf8(element->getUpperBound().getText()));
+        while (current < stop || current == stop) {
+            if (current.getChapter() == 0) { // range was 0:0-1:x, render 0:0 first and jump to 1:0
+                current.setVerse(0);
+                if (!writer.append(new CTextRendering::KeyTreeItem(current, modules, settings)))
+                    return false;
+                current.setChapter(1);
+                current.setVerse(0);
+            }
+            if (!writer.append(new CTextRendering::KeyTreeItem(current, modules, settings)))
+                return false;
+            if (!current.next(CSwordVerseKey::UseVerse))
+                break;
+        }
+    }
+    return true;
+}
+
+/**
+  Renders the given references in this process and writes them between
+  \a head and \a tail.
+*/
+bool renderReferences(const Options & o,
+                      const QList<const CSwordModuleInfo*> & modules,
+                      const QStringList & refs,
+                      Output & output,
+                      const QString & head,
+                      const QString & tail,
+                      int & entries)
+{
+    QSharedPointer<CTextRendering> renderer(newRenderer(o));
+    EntryWriter writer(renderer.data(), output);
+
+    bool ok = output.write(head.toUtf8());
+    Q_FOREACH (const QString & ref, refs) {
+        if (!ok)
+            break;
+        ok = appendReference(writer, ref, modules);
+    }
+    ok = ok && writer.flush() && output.write(tail.toUtf8());
+    entries = writer.entries();
+
+    if (!ok)
+        std::cerr << "Error: Failed to write the output." << std::endl;
+    return ok;
+}
+
+/**
+  Splits the references into contiguous slices and renders each slice in a
+  worker process. The Sword library is not thread-safe, so processes are used
+  instead of threads. The outputs of the workers are concatenated in order.
+*/
+bool renderInWorkers(const Options & o,
+                     const QStringList & refs,
+                     Output & output,
+                     const QString & head,
+                     const QString & tail)
+{
+    const int jobs = qMin(o.jobs, refs.size());
+    QList<QSharedPointer<QTemporaryFile> > parts;
+    QList<QSharedPointer<QProcess> > workers;
+
+    QStringList baseArgs = BibleTimeApp::arguments().mid(1);
+    for (int i = 0; i < baseArgs.size(); i++) {
+        const QString & arg = baseArgs.at(i);
+        if (arg == "--jobs" || arg == "-j" || arg == "--output" || arg == "-o") {
+            baseArgs.removeAt(i);
+            baseArgs.removeAt(i);
+            i--;
+        }
+    }
+
+    int begin = 0;
+    for (int i = 0; i < jobs; i++) {
+        const int end = begin + (refs.size() - begin) / (jobs - i);
+
+        QSharedPointer<QTemporaryFile> part(new QTemporaryFile());
+        if (!part->open()) {
+            std::cerr << "Error: Failed to create a temporary file." << std::endl;
+            return false;
+        }
+        part->close();
+        parts.append(part);
+
+        QSharedPointer<QProcess> worker(new QProcess());
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        worker->start(BibleTimeApp::applicationFilePath(),
+                      QStringList(baseArgs) << "--worker" << "--output" << part->fileName());
+        if (!worker->waitForStarted()) {
+            std::cerr << "Error: Failed to start a worker process." << std::endl;
+            return false;
+        }
+        // Without an event loop the input has to be written explicitly:
+        worker->write(QStringList(refs.mid(begin, end - begin)).join("\n").toUtf8());
+        while (worker->bytesToWrite() > 0 && worker->waitForBytesWritten(-1))
+            ;
+        worker->closeWriteChannel();
+        workers.append(worker);
+        begin = end;
+    }
+
+    bool ok = output.write(head.toUtf8());
+    for (int i = 0; i < workers.size(); i++) {
+        QProcess & worker = *workers.at(i);
+        worker.waitForFinished(-1);
+        if (worker.exitStatus() != QProcess::NormalExit || worker.exitCode() != 0) {
+            std::cerr << "Error: Worker process " << i + 1 << " failed." << std::endl;
+            ok = false;
+        }
+
+        QFile & part = *parts.at(i);
+        if (!ok || !part.open(QIODevice::ReadOnly))
+            return false;
+        while (ok && !part.atEnd())
+            ok = output.write(part.read(1 << 20));
+        part.close();
+    }
+    return ok && output.write(tail.toUtf8());
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char * argv[]) {
+#if QT_VERSION >= 0x050000
+    // No window system is needed:
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "minimal");
+#endif
+    BibleTimeApp app(argc, argv, false);
+
+    Options o;
+    const int r = parseCommandLine(o);
+    if (r != 0)
+        return (r < 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!initBackend())
+        return EXIT_FAILURE;
+    const qint64 initTime = timer.elapsed();
+
+    QList<const CSwordModuleInfo*> modules;
+    Q_FOREACH (const QString & name, o.moduleNames) {
+        const CSwordModuleInfo * const module = CSwordBackend::instance()->findModuleByName(name);
+        if (module == 0) {
+            std::cerr << "Error: Work not found: " << qPrintable(name) << std::endl;
+            return EXIT_FAILURE;
+        }
+        modules.append(module);
+    }
+
+    QStringList refs;
+    QTextStream input(stdin);
+    input.setCodec("UTF-8");
+    while (!input.atEnd()) {
+        const QString line = input.readLine().trimmed();
+        if (!line.isEmpty() && !line.startsWith('#'))
+            refs.append(line);
+    }
+
+    Output output(o.outputFile);
+    if (!output.open())
+        return EXIT_FAILURE;
+
+    // The workers only write the entries, the page around them is written here:
+    QString head;
+    QString tail;
+    if (!o.worker) {
+        QSharedPointer<CTextRendering> renderer(newRenderer(o));
+        CTextRendering::KeyTree frame;
+        frame.append(new CTextRendering::KeyTreeItem(QString(), modules,
+                                                     CTextRendering::KeyTreeItem::Settings()));
+        renderer->renderPageFrame(frame, head, tail);
+    }
+
+    int entries = -1;
+    const bool ok = (o.jobs > 1 && refs.size() > 1)
+                    ? renderInWorkers(o, refs, output, head, tail)
+                    : renderReferences(o, modules, refs, output, head, tail, entries);
+    output.file.close();
+    if (!ok)
+        return EXIT_FAILURE;
+
+    if (!o.worker) {
+        const qint64 renderTime = qMax(timer.elapsed() - initTime, Q_INT64_C(1));
+        std::cerr << "References: " << refs.size();
+        if (entries >= 0)
+            std::cerr << ", entries: " << entries;
+        std::cerr << ", bytes: " << output.bytes
+                  << ", jobs: " << qMin(o.jobs, qMax(refs.size(), 1)) << std::endl
+                  << "Backend initialized in " << initTime << " ms, rendered in "
+                  << renderTime << " ms (" << (refs.size() * 1000.0 / renderTime)
+                  << " references/s, "
+                  << (output.bytes / 1024.0 / 1024.0 * 1000.0 / renderTime)
+                  << " MiB/s)" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  btsynthlib - creates a library of synthetic works for benchmarks. The works
+  and their contents only depend on the arguments, so the library is the same
+  on every run and every system.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+// Sword includes:
+#include <rawcom.h>
+#include <rawld.h>
+#include <rawtext.h>
+#include <swkey.h>
+#include <versekey.h>
+
+
+namespace {
+
+const char * const LANGUAGES[] = { "en", "de", "fr", "es", "ru", "el", "he", "zh" };
+const int LANGUAGE_COUNT = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+
+/** Number of entries of every lexicon. */
+const int LEXICON_ENTRIES = 500;
+
+void printHelp(const QString &executable) {
+    std::cout << qPrintable(executable)
+        << " <sword directory> [<bibles> [<commentaries> [<lexicons>]]]"
+        << std::endl << std::endl
+        << "Creates the given number of synthetic works (150 Bibles, 100"
+        << std::endl
+        << "commentaries and 50 lexicons by default) in the given directory."
+        << std::endl;
+}
+
+QString entryText(const QString &moduleName, const char *key) {
+    return QString("%1 of %2. In the beginning was the Word, and the Word was "
+                   "with God, and the Word was God.")
+           .arg(QString::fromUtf8(key), moduleName);
+}
+
+bool writeConfig(const QDir &swordDir,
+                 const QString &name,
+                 const QString &description,
+                 const QString &dataPath,
+                 const char *driver,
+                 int number)
+{
+    QFile f(swordDir.filePath("mods.d/" + name.toLower() + ".conf"));
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream s(&f);
+    s << '[' << name << "]\n"
+      << "DataPath=" << dataPath << '\n'
+      << "ModDrv=" << driver << '\n'
+      << "SourceType=Plain\n"
+      << "Encoding=UTF-8\n"
+      << "Lang=" << LANGUAGES[number % LANGUAGE_COUNT] << '\n'
+      << "Description=" << description << '\n'
+      << "Version=1.0\n";
+    return s.status() == QTextStream::Ok;
+}
+
+/** Fills the book of Genesis, which is enough to open and render windows. */
+bool createVerseModule(const QDir &swordDir,
+                       const QString &name,
+                       const QString &description,
+                       bool commentary,
+                       int number)
+{
+    const QString dataPath = QString(commentary
+                                     ? "./modules/comments/rawcom/%1/"
+                                     : "./modules/texts/rawtext/%1/")
+                             .arg(name.toLower());
+    const QByteArray path = QFile::encodeName(swordDir.filePath(dataPath));
+    if (sword::RawText::createModule(path.constData()) != 0)
+        return false;
+
+    sword::SWModule * const module = commentary
+        ? static_cast<sword::SWModule *>(new sword::RawCom(path.constData()))
+        : static_cast<sword::SWModule *>(new sword::RawText(path.constData()));
+    sword::VerseKey * const key = static_cast<sword::VerseKey *>(module->createKey());
+    key->setPersist(true);
+    module->setKey(key);
+
+    for (key->setText("Gen 1:1");
+         !key->popError() && key->getTestament() == 1 && key->getBook() == 1;
+         key->increment())
+    {
+        module->setEntry(entryText(name, key->getText()).toUtf8().constData());
+    }
+    delete module;
+    delete key;
+
+    return writeConfig(swordDir, name, description, dataPath,
+                       commentary ? "RawCom" : "RawText", number);
+}
+
+bool createLexicon(const QDir &swordDir, const QString &name, int number) {
+    const QString dataPath = QString("./modules/lexdict/rawld/%1/%1")
+                             .arg(name.toLower());
+    const QByteArray path = QFile::encodeName(swordDir.filePath(dataPath));
+    if (sword::RawLD::createModule(path.constData()) != 0)
+        return false;
+
+    sword::RawLD module(path.constData());
+    for (int i = 1; i <= LEXICON_ENTRIES; i++) {
+        const QByteArray key = QString("%1").arg(i, 5, 10, QChar('0')).toLatin1();
+        module.setKey(sword::SWKey(key.constData()));
+        module.setEntry(entryText(name, key.constData()).toUtf8().constData());
+    }
+
+    return writeConfig(swordDir, name, "Synthetic lexicon " + QString::number(number),
+                       dataPath, "RawLD", number);
+}
+
+} // anonymous namespace
+
+int main(int argc, char * argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() < 2 || args.size() > 5
+        || args.at(1) == "--help" || args.at(1) == "-h")
+    {
+        printHelp(args.at(0));
+        return (args.size() == 2) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int counts[3] = { 150, 100, 50 };
+    for (int i = 2; i < args.size(); i++) {
+        bool ok;
+        counts[i - 2] = args.at(i).toInt(&ok);
+        if (!ok || counts[i - 2] < 0) {
+            std::cerr << "Error: Invalid number of works: " << qPrintable(args.at(i))
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const QDir swordDir(args.at(1));
+    if (!swordDir.mkpath("mods.d")) {
+        std::cerr << "Error: Failed to create " << qPrintable(swordDir.filePath("mods.d"))
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < counts[0]; i++)
+        ok = createVerseModule(swordDir,
+                               QString("SynthBible%1").arg(i, 3, 10, QChar('0')),
+                               "Synthetic Bible " + QString::number(i), false, i);
+    for (int i = 0; ok && i < counts[1]; i++)
+        ok = createVerseModule(swordDir,
+                               QString("SynthCom%1").arg(i, 3, 10, QChar('0')),
+                               "Synthetic commentary " + QString::number(i), true, i);
+    for (int i = 0; ok && i < counts[2]; i++)
+        ok = createLexicon(swordDir, QString("SynthLex%1").arg(i, 3, 10, QChar('0')), i);
+
+    if (!ok) {
+        std::cerr << "Error: Failed to create the works in "
+                  << qPrintable(swordDir.absolutePath()) << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+#
+# Measures the time BibleTime needs from its start until the first window is
+# rendered, with a synthetic library of works created by btsynthlib.
+#
+# Usage: run-startup-benchmark.sh <btsynthlib> <bibletime> [<runs>]
+#
+# The library and the home directory used by BibleTime are created in
+# $BT_BENCHMARK_DIR (./startup-benchmark by default). The size of the library
+# is given by $BT_BENCHMARK_WORKS as "<bibles> <commentaries> <lexicons>".
+# BibleTime must be installed, since it does not find its data files in the
+# build directory.
+
+SYNTHLIB="$1"
+BIBLETIME="$2"
+RUNS="${3:-5}"
+WORKDIR="${BT_BENCHMARK_DIR:-$(pwd)/startup-benchmark}"
+WORKS="${BT_BENCHMARK_WORKS:-150 100 50}"
+
+if [ -z "$SYNTHLIB" ] || [ -z "$BIBLETIME" ]; then
+    echo "Usage: $0 <btsynthlib> <bibletime> [<runs>]" >&2
+    exit 1
+fi
+if [ ! -x "$BIBLETIME" ]; then
+    echo "Error: $BIBLETIME not found, install BibleTime first." >&2
+    exit 1
+fi
+
+rm -rf "$WORKDIR" || exit 1
+mkdir -p "$WORKDIR/.bibletime" || exit 1
+"$SYNTHLIB" "$WORKDIR/.sword" $WORKS || exit 1
+
+cat > "$WORKDIR/bibletimerc" <<'EOF'
+[General]
+btconfig_api_version=1
+
+[GUI]
+showSplashScreen=false
+showTipAtStartup=false
+
+[settings]
+defaults\standardBible=SynthBible000
+EOF
+
+# No window system is needed with Qt 5:
+if [ -z "$QT_QPA_PLATFORM" ]; then
+    QT_QPA_PLATFORM=offscreen
+    export QT_QPA_PLATFORM
+fi
+
+TIMES=""
+i=0
+while [ $i -lt "$RUNS" ]; do
+    i=$((i + 1))
+    cp "$WORKDIR/bibletimerc" "$WORKDIR/.bibletime/bibletimerc" || exit 1
+    HOME="$WORKDIR" "$BIBLETIME" --ignore-session --open-default-bible "Gen 1:1" \
+        --profile-startup --quit-after-startup > "$WORKDIR/run$i.log" 2>&1
+    TIME=$(sed -n 's/^ *\([0-9][0-9]*\) *First window rendered$/\1/p' "$WORKDIR/run$i.log")
+    if [ -z "$TIME" ]; then
+        echo "Error: No window was rendered in run $i, see $WORKDIR/run$i.log" >&2
+        exit 1
+    fi
+    echo "Run $i: first window rendered after $TIME ms"
+    TIMES="$TIMES $TIME"
+done
+
+MEDIAN=$(for t in $TIMES; do echo "$t"; done | sort -n \
+         | awk '{ t[NR] = $1 } END { print (NR % 2) ? t[(NR + 1) / 2] : int((t[NR / 2] + t[NR / 2 + 1]) / 2) }')
+echo "Median time to first rendered window ($WORKS works): $MEDIAN ms"
+echo "The profile of the last run is in $WORKDIR/run$RUNS.log"
@@ -0,0 +1,173 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+/*
+  btv11ncheck - verifies the cached versification maps of BibleTime against the
+  conversion done by Sword itself.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+#include "backend/keys/btversificationmap.h"
+#include "util/directory.h"
+
+// Sword includes:
+#include <versekey.h>
+#include <versificationmgr.h>
+
+
+namespace {
+
+void printHelp(const QString &executable) {
+    std::cout << qPrintable(executable) << " [<from> <to>]"
+        << std::endl << std::endl
+        << "Compares the cached map between the given versification systems, or"
+        << std::endl
+        << "between all pairs of systems known to Sword, with the conversion done"
+        << std::endl
+        << "by Sword. Every verse is also positioned with the map and with Sword"
+        << std::endl
+        << "directly. The maps are created in the cache if they don't exist yet."
+        << std::endl;
+}
+
+/** \returns the number of verse indexes mapped differently than by Sword. */
+int checkTable(const char *from, const char *to, bool verbose) {
+    const QVector<qint32> &cached = BtVersificationMap::get(from, to).table();
+    const QVector<qint32> expected = BtVersificationMap::compute(from, to);
+
+    if (cached.size() != expected.size()) {
+        std::cerr << from << " -> " << to << ": map has " << cached.size()
+                  << " entries instead of " << expected.size() << std::endl;
+        return qMax(cached.size(), expected.size());
+    }
+
+    int errors = 0;
+    sword::VerseKey key;
+    key.setVersificationSystem(from);
+    key.setIntros(true);
+    for (int i = 0; i < cached.size(); i++) {
+        if (cached.at(i) == expected.at(i))
+            continue;
+
+        errors++;
+        if (verbose) {
+            key.setIndex(i);
+            std::cerr << from << " -> " << to << ": " << key.getText()
+                      << " (" << i << ") is mapped to " << cached.at(i)
+                      << " instead of " << expected.at(i) << std::endl;
+        }
+    }
+    return errors;
+}
+
+/**
+  Positions a key on every verse of \a from with BtVersificationMap::position()
+  and with VerseKey::positionFrom().
+  \returns the number of verses for which the keys differ.
+*/
+int checkPositions(const char *from, const char *to, bool verbose) {
+    sword::VerseKey src;
+    src.setVersificationSystem(from);
+    src.setIntros(true);
+    sword::VerseKey expected;
+    expected.setVersificationSystem(to);
+    expected.setIntros(true);
+    sword::VerseKey mapped;
+    mapped.setVersificationSystem(to);
+    mapped.setIntros(true);
+
+    src.setPosition(sword::BOTTOM);
+    const long count = src.getIndex() + 1;
+
+    int errors = 0;
+    for (long i = 0; i < count; i++) {
+        src.setIndex(i);
+        if (src.popError() || src.getIndex() != i)
+            continue;
+
+        expected.positionFrom(src);
+        const bool expectedOk = !expected.popError();
+        const bool mappedOk = BtVersificationMap::position(mapped, src);
+        if (mappedOk == expectedOk
+            && (!mappedOk || strcmp(mapped.getText(), expected.getText()) == 0))
+            continue;
+
+        errors++;
+        if (verbose) {
+            std::cerr << from << " -> " << to << ": " << src.getText()
+                      << " is positioned on "
+                      << (mappedOk ? mapped.getText() : "no verse")
+                      << " instead of "
+                      << (expectedOk ? expected.getText() : "no verse")
+                      << std::endl;
+        }
+    }
+    return errors;
+}
+
+} // anonymous namespace
+
+int main(int argc, char * argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() == 2 && (args.at(1) == "--help" || args.at(1) == "-h")) {
+        printHelp(args.at(0));
+        return EXIT_SUCCESS;
+    }
+    if (args.size() != 1 && args.size() != 3) {
+        std::cerr << "Error: Invalid command-line arguments. See --help for details."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!util::directory::initDirectoryCache()) {
+        std::cerr << "Error: Failed to initialize the directories." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    QList<QByteArray> systems;
+    if (args.size() == 3) {
+        systems << args.at(1).toUtf8() << args.at(2).toUtf8();
+    } else {
+        const sword::StringList names =
+                sword::VersificationMgr::getSystemVersificationMgr()->getVersificationSystems();
+        for (sword::StringList::const_iterator it = names.begin(); it != names.end(); ++it)
+            systems << QByteArray(it->c_str());
+    }
+
+    int pairs = 0;
+    int failed = 0;
+    for (int i = 0; i < systems.size(); i++) {
+        for (int j = 0; j < systems.size(); j++) {
+            if (i == j || (args.size() == 3 && i != 0))
+                continue;
+
+            pairs++;
+            const char * const from = systems.at(i).constData();
+            const char * const to = systems.at(j).constData();
+            const int errors = checkTable(from, to, args.size() == 3)
+                               + checkPositions(from, to, args.size() == 3);
+            if (errors > 0) {
+                failed++;
+                std::cout << from << " -> " << to << ": " << errors
+                          << " mismatches" << std::endl;
+            }
+        }
+    }
+
+    std::cout << "Checked " << pairs << " versification maps, "
+              << failed << " failed." << std::endl;
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
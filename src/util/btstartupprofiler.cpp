@@ -0,0 +1,116 @@
+/*********
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#include "util/btstartupprofiler.h"
+
+#include <cstdio>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector>
+
+
+namespace {
+
+struct Record {
+    const char *name;
+    int depth;
+    qint64 start;
+    qint64 duration; // -1 for points in time
+};
+
+QElapsedTimer clock;
+QVector<Record> records;
+int depth = 0;
+bool finished = false;
+bool reportEnabled = false;
+bool windowRendered = false;
+
+inline bool recording() {
+    if (finished || !clock.isValid())
+        return false;
+
+    // Phases of other threads would mess up the nesting:
+    const QCoreApplication * const app = QCoreApplication::instance();
+    return app == 0 || QThread::currentThread() == app->thread();
+}
+
+inline void addPoint(const char *name) {
+    const Record r = { name, 0, clock.elapsed(), -1 };
+    records.append(r);
+}
+
+} // anonymous namespace
+
+BtStartupProfiler::Phase::Phase(const char *name)
+    : m_record(-1)
+{
+    if (!recording())
+        return;
+
+    const Record r = { name, depth, clock.elapsed(), 0 };
+    m_record = records.size();
+    records.append(r);
+    depth++;
+}
+
+BtStartupProfiler::Phase::~Phase() {
+    if (m_record < 0 || finished)
+        return;
+
+    Record &r = records[m_record];
+    r.duration = clock.elapsed() - r.start;
+    depth--;
+}
+
+void BtStartupProfiler::start() {
+    clock.start();
+}
+
+void BtStartupProfiler::setReportEnabled(bool enabled) {
+    reportEnabled = enabled;
+}
+
+bool BtStartupProfiler::isReportEnabled() {
+    return reportEnabled;
+}
+
+void BtStartupProfiler::firstWindowRendered() {
+    if (windowRendered || !recording())
+        return;
+
+    windowRendered = true;
+    addPoint("First window rendered");
+}
+
+void BtStartupProfiler::finish() {
+    if (!recording())
+        return;
+
+    addPoint("Startup finished");
+    finished = true;
+    if (!reportEnabled)
+        return;
+
+    std::fprintf(stderr, "BibleTime startup profile (milliseconds):\n"
+                         "%8s %8s  %s\n", "start", "duration", "phase");
+    Q_FOREACH (const Record &r, records) {
+        if (r.duration < 0) {
+            std::fprintf(stderr, "%8lld %8s  %s\n",
+                         static_cast<long long>(r.start), "", r.name);
+        } else {
+            std::fprintf(stderr, "%8lld %8lld  %*s%s\n",
+                         static_cast<long long>(r.start),
+                         static_cast<long long>(r.duration),
+                         2 * r.depth, "", r.name);
+        }
+    }
+    std::fflush(stderr);
+    records.clear();
+}
@@ -0,0 +1,58 @@
+/*********
+*
+* In the name of the Father, and of the Son, and of the Holy Spirit.
+*
+* This file is part of BibleTime's source code, http://www.bibletime.info/.
+*
+* Copyright 1999-2014 by the BibleTime developers.
+* The BibleTime source code is licensed under the GNU General Public License version 2.0.
+*
+**********/
+
+#ifndef BTSTARTUPPROFILER_H
+#define BTSTARTUPPROFILER_H
+
+
+/**
+  \brief Measures the time spent in the phases of the startup.
+
+  Phases are measured by Phase objects which live as long as the phase and may
+  be nested. Only phases in the main thread before finish() are recorded. The
+  report is written to the standard error output by finish() if it was
+  requested with the --profile-startup command-line option.
+*/
+class BtStartupProfiler {
+
+    public: /* Types: */
+
+        class Phase {
+
+            public: /* Methods: */
+
+                explicit Phase(const char *name);
+                ~Phase();
+
+            private: /* Fields: */
+
+                int m_record;
+
+        };
+
+    public: /* Methods: */
+
+        /** Starts the clock all times are relative to. */
+        static void start();
+
+        /** Sets whether finish() writes the report. */
+        static void setReportEnabled(bool enabled);
+        static bool isReportEnabled();
+
+        /** Records the first time the text of a display window was rendered. */
+        static void firstWindowRendered();
+
+        /** Ends the recording and writes the report, if enabled. */
+        static void finish();
+
+};
+
+#endif